@@ -0,0 +1,85 @@
+#include "byte_runs.h"
+
+#include <QString>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define BYTE_RUNS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define BYTE_RUNS_NEON 1
+#endif
+
+static inline bool isControl(unsigned char b) {
+    return b < 0x20 || b == 0x7F;
+}
+
+// Index (0..16) of the first byte in the 16-byte block at p whose class differs from `control`.
+#if defined(BYTE_RUNS_SSE2)
+static inline int firstMismatch16(const unsigned char *p, bool control) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    // unsigned b <= 0x1F  <=>  min(b, 0x1F) == b
+    const __m128i lt = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v);
+    const __m128i del = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F));
+    unsigned m = unsigned(_mm_movemask_epi8(_mm_or_si128(lt, del)));
+    if (control) m = ~m & 0xFFFFu;
+    return m ? __builtin_ctz(m) : 16;
+}
+#elif defined(BYTE_RUNS_NEON)
+static inline int firstMismatch16(const unsigned char *p, bool control) {
+    const uint8x16_t v = vld1q_u8(p);
+    const uint8x16_t m = vorrq_u8(vcleq_u8(v, vdupq_n_u8(0x1F)), vceqq_u8(v, vdupq_n_u8(0x7F)));
+    // narrow to 4 bits per byte: nibble i is 0xF for a control byte
+    uint64_t nib = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    if (control) nib = ~nib;
+    return nib ? (__builtin_ctzll(nib) >> 2) : 16;
+}
+#endif
+
+// First index >= i whose class differs from `control`, or len.
+static int findBoundary(const unsigned char *p, int i, int len, bool control) {
+#if defined(BYTE_RUNS_SSE2) || defined(BYTE_RUNS_NEON)
+    while (i + 16 <= len) {
+        const int k = firstMismatch16(p + i, control);
+        if (k < 16) return i + k;
+        i += 16;
+    }
+#endif
+    while (i < len && isControl(p[i]) == control) ++i;
+    return i;
+}
+
+void classifyByteRuns(const char *data, int len, QVector<ByteRun> *out) {
+    if (!out || !data || len <= 0) return;
+
+    const auto *p = reinterpret_cast<const unsigned char *>(data);
+    int i = 0;
+    while (i < len) {
+        const bool control = isControl(p[i]);
+        const int end = findBoundary(p, i + 1, len, control);
+        out->push_back(ByteRun{i, end - i, control});
+        i = end;
+    }
+}
+
+void appendControlEscapes(const char *data, int len, QString *out) {
+    if (!out || len <= 0) return;
+    static const char kDigits[] = "0123456789ABCDEF";
+
+    QChar buf[4];
+    for (int i = 0; i < len; ++i) {
+        const unsigned char b = static_cast<unsigned char>(data[i]);
+        switch (b) {
+        case '\n': out->append(QLatin1String("\\n")); break;
+        case '\r': out->append(QLatin1String("\\r")); break;
+        case '\t': out->append(QLatin1String("\\t")); break;
+        default:
+            buf[0] = QLatin1Char('\\');
+            buf[1] = QLatin1Char('x');
+            buf[2] = QLatin1Char(kDigits[b >> 4]);
+            buf[3] = QLatin1Char(kDigits[b & 0x0F]);
+            out->append(buf, 4);
+            break;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QVector>
+#include <QString>
+
+// One run of same-class bytes inside a chunk.
+// control: b < 0x20 || b == 0x7F (rendered as escapes); everything else is printable.
+struct ByteRun {
+    int offset = 0;
+    int length = 0;
+    bool control = false;
+};
+
+// Single pass over the chunk, appending alternating printable/control runs to *out.
+// Uses SSE2 / NEON to find class boundaries 16 bytes at a time where available.
+void classifyByteRuns(const char *data, int len, QVector<ByteRun> *out);
+
+// Escape text for a control run: \n \r \t, others as \xHH (upper-case hex).
+// Appends to *out without intermediate allocations.
+void appendControlEscapes(const char *data, int len, QString *out);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QHash>
+
+#include <memory>
+#include <vector>
+
+// 按通道号索引的曲线容器：每个条目单独分配，增删条目时其余条目（及其采样缓冲）
+// 地址不变、不被拷贝；通道号 -> 位置 走哈希表，每个采样的查找是 O(1)，与通道数无关。
+// 位置（index）就是界面列表里的行号，删除后其后的条目前移一位。
+template <typename T>
+class ChannelRegistry final {
+    using Storage = std::vector<std::unique_ptr<T>>;
+
+public:
+    class iterator {
+    public:
+        explicit iterator(typename Storage::const_iterator it) : m_it(it) {}
+        T &operator*() const { return **m_it; }
+        T *operator->() const { return m_it->get(); }
+        iterator &operator++() { ++m_it; return *this; }
+        bool operator!=(const iterator &o) const { return m_it != o.m_it; }
+    private:
+        typename Storage::const_iterator m_it;
+    };
+
+    int size() const { return int(m_items.size()); }
+    bool isEmpty() const { return m_items.empty(); }
+
+    T *at(int index) const { return m_items[size_t(index)].get(); }
+    T *find(int channel) const {
+        const auto it = m_index.constFind(channel);
+        return it == m_index.constEnd() ? nullptr : m_items[size_t(*it)].get();
+    }
+    int indexOf(int channel) const { return m_index.value(channel, -1); }
+    bool contains(int channel) const { return m_index.contains(channel); }
+
+    // channel must not be registered yet
+    T *add(int channel, std::unique_ptr<T> item) {
+        m_index.insert(channel, size());
+        m_items.push_back(std::move(item));
+        return m_items.back().get();
+    }
+
+    std::unique_ptr<T> takeAt(int index, int channel) {
+        std::unique_ptr<T> out = std::move(m_items[size_t(index)]);
+        m_items.erase(m_items.begin() + index);
+        m_index.remove(channel);
+        // only the rows behind the removed one move
+        for (auto it = m_index.begin(); it != m_index.end(); ++it) {
+            if (*it > index) --(*it);
+        }
+        return out;
+    }
+
+    // smallest channel number >= from that is not registered
+    int firstFreeChannel(int from = 0) const {
+        int ch = from;
+        while (m_index.contains(ch)) ++ch;
+        return ch;
+    }
+
+    iterator begin() const { return iterator(m_items.cbegin()); }
+    iterator end() const { return iterator(m_items.cend()); }
+
+private:
+    Storage m_items;
+    QHash<int, int> m_index;     // channel -> position in m_items
+};
@@ -0,0 +1,46 @@
+#include "column_parser.h"
+
+#include <limits>
+
+ColumnParser::Kind ColumnParser::parse(const QString &line, QVector<double> *values) {
+    values->resize(0);
+    m_fields.resize(0);
+
+    const QChar *p = line.constData();
+    const QChar *const end = p + line.size();
+    const bool spaces = m_cfg.separator == QLatin1Char(' ');
+
+    // split: views only, no copies
+    if (spaces) {
+        while (p < end) {
+            while (p < end && (*p == QLatin1Char(' ') || *p == QLatin1Char('\t'))) ++p;
+            const QChar *start = p;
+            while (p < end && *p != QLatin1Char(' ') && *p != QLatin1Char('\t')) ++p;
+            if (p > start) m_fields.push_back(QStringView(start, p - start));
+        }
+    } else {
+        const QChar *start = p;
+        for (; p <= end; ++p) {
+            if (p < end && *p != m_cfg.separator) continue;
+            m_fields.push_back(QStringView(start, p - start).trimmed());
+            start = p + 1;
+        }
+    }
+    if (m_fields.isEmpty() || (m_fields.size() == 1 && m_fields.first().isEmpty())) return Kind::Empty;
+
+    values->reserve(m_fields.size());
+    int numeric = 0;
+    for (const QStringView f : m_fields) {
+        bool ok = false;
+        const double v = f.isEmpty() ? 0.0 : f.toDouble(&ok);
+        if (ok) ++numeric;
+        values->push_back(ok ? v : std::numeric_limits<double>::quiet_NaN());
+    }
+
+    if (numeric > 0) return Kind::Row;
+
+    m_names.clear();
+    for (const QStringView f : m_fields) m_names.push_back(f.toString());
+    values->resize(0);
+    return Kind::Header;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QChar>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+// 多列模式的行解析：一行 "t,v0,v1,...,vN"（分隔符可配置）一次解析出全部列。
+// 单遍扫描原始字符串，字段以 QStringView 直接转 double 写入调用方复用的数组，
+// 不经过正则 / split / 中间 QString。
+// 所有字段都不是数字的行视为表头（列名）；数据行里个别字段非数字记为 NaN，调用方跳过该列。
+class ColumnParser final {
+public:
+    enum class Kind { Empty, Header, Row };
+
+    struct Config {
+        QChar separator = ',';       // ' ' = any run of spaces / tabs
+        bool firstIsX = true;        // column 0 is the shared X
+    };
+
+    void setConfig(const Config &cfg) { m_cfg = cfg; }
+    const Config &config() const { return m_cfg; }
+
+    // Row: *values holds every column (X first when firstIsX), reused across calls
+    // Header: names() holds the column names
+    Kind parse(const QString &line, QVector<double> *values);
+
+    const QStringList &names() const { return m_names; }
+
+private:
+    Config m_cfg;
+    QStringList m_names;
+    QVector<QStringView> m_fields;   // scratch, views into the current line
+};
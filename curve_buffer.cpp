@@ -0,0 +1,211 @@
+#include "curve_buffer.h"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+void CurveBuffer::setMode(XMode mode) {
+    if (mode == m_mode) return;
+    clear();
+    m_mode = mode;
+}
+
+void CurveBuffer::clear() {
+    m_chunks.clear();
+    m_head = 0;
+    m_size = 0;
+    m_firstIndex = 0;
+}
+
+void CurveBuffer::append(double x, double y) {
+    // emptied by keepLast: start on a fresh chunk so no sample is offset from a stale base
+    if (m_size == 0 && !m_chunks.empty()) {
+        m_chunks.clear();
+        m_head = 0;
+    }
+
+    const int g = m_head + m_size;
+    if ((g >> kChunkShift) == int(m_chunks.size())) {
+        auto c = std::make_shared<Chunk>();
+        if (m_mode == XMode::Explicit) {
+            c->xy.reset(new QPointF[kChunkSize]);
+        } else {
+            c->y.reset(new float[kChunkSize]);
+            if (m_mode == XMode::HostTime) {
+                c->x.reset(new float[kChunkSize]);
+                c->xBase = x;
+            }
+        }
+        m_chunks.push_back(std::move(c));
+    }
+
+    // only slots past m_size are written: a snapshot never sees them change
+    Chunk &c = *m_chunks.back();
+    const int s = slotOf(g);
+    switch (m_mode) {
+    case XMode::Explicit:
+        c.xy[s] = QPointF(x, y);
+        break;
+    case XMode::Index:
+        c.y[s] = float(y);
+        break;
+    case XMode::HostTime:
+        c.x[s] = float(x - c.xBase);
+        c.y[s] = float(y);
+        break;
+    }
+    ++m_size;
+}
+
+void CurveBuffer::keepLast(int n) {
+    const int drop = m_size - qMax(0, n);
+    if (drop <= 0) return;
+
+    m_head += drop;
+    m_size -= drop;
+    if (m_mode == XMode::Index) m_firstIndex += drop;
+
+    // whole chunks fall off the front; snapshots still holding them keep them alive
+    const int freed = m_head >> kChunkShift;
+    if (freed > 0) {
+        m_chunks.erase(m_chunks.begin(), m_chunks.begin() + freed);
+        m_head -= freed << kChunkShift;
+    }
+}
+
+double CurveBuffer::x(int i) const {
+    switch (m_mode) {
+    case XMode::Explicit: return chunkOf(i).xy[slotOf(m_head + i)].x();
+    case XMode::Index:    return double(m_firstIndex + i);
+    case XMode::HostTime: {
+        const Chunk &c = chunkOf(i);
+        return c.xBase + double(c.x[slotOf(m_head + i)]);
+    }
+    }
+    return 0.0;
+}
+
+double CurveBuffer::y(int i) const {
+    const Chunk &c = chunkOf(i);
+    const int s = slotOf(m_head + i);
+    return m_mode == XMode::Explicit ? c.xy[s].y() : double(c.y[s]);
+}
+
+bool CurveBuffer::xRange(double *x0, double *x1) const {
+    if (m_size == 0) return false;
+
+    if (isImplicitX()) {
+        *x0 = x(0);
+        *x1 = x(m_size - 1);
+        return true;
+    }
+
+    double mn = x(0), mx = mn;
+    for (int i = 1; i < m_size; ++i) {
+        const double v = x(i);
+        mn = qMin(mn, v);
+        mx = qMax(mx, v);
+    }
+    *x0 = mn;
+    *x1 = mx;
+    return true;
+}
+
+bool CurveBuffer::yRangeIn(double x0, double x1, double *y0, double *y1) const {
+    double mn = 0.0, mx = 0.0;
+    bool init = false;
+
+    if (m_mode == XMode::Explicit) {
+        for (int i = 0; i < m_size; ++i) {
+            const QPointF p = at(i);
+            if (p.x() < x0 || p.x() > x1) continue;
+            if (!init) { mn = mx = p.y(); init = true; }
+            else { mn = qMin(mn, p.y()); mx = qMax(mx, p.y()); }
+        }
+    } else {
+        // monotonic X: only the samples inside the window are touched
+        int first = 0, last = 0;
+        indexRange(x0, x1, &first, &last);
+        for (int i = first; i < last; ++i) {
+            const double v = y(i);
+            if (!init) { mn = mx = v; init = true; }
+            else { mn = qMin(mn, v); mx = qMax(mx, v); }
+        }
+    }
+
+    if (!init) return false;
+    *y0 = mn;
+    *y1 = mx;
+    return true;
+}
+
+void CurveBuffer::indexRange(double x0, double x1, int *first, int *last) const {
+    if (m_mode == XMode::Index) {
+        const double lo = std::ceil(x0 - double(m_firstIndex));
+        const double hi = std::floor(x1 - double(m_firstIndex)) + 1.0;
+        *first = int(qBound(0.0, lo, double(m_size)));
+        *last = int(qBound(double(*first), hi, double(m_size)));
+        return;
+    }
+    if (m_mode == XMode::HostTime) {
+        *first = searchX(x0, false);
+        *last = qMax(*first, searchX(x1, true));
+        return;
+    }
+    *first = 0;
+    *last = m_size;
+}
+
+int CurveBuffer::searchX(double key, bool upper) const {
+    int lo = 0, hi = m_size;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const double v = x(mid);
+        if (upper ? v <= key : v < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+QVector<QPointF> CurveBuffer::points(int first, int count) const {
+    first = qBound(0, first, m_size);
+    count = qBound(0, count, m_size - first);
+
+    QVector<QPointF> out;
+    out.reserve(count);
+    for (int i = first; i < first + count; ++i) out.push_back(at(i));
+    return out;
+}
+
+QVector<QPointF> CurveBuffer::lastPoints(int n) const {
+    if (n <= 0) return {};
+    return points(qMax(0, m_size - n), n);
+}
+
+QVector<QPointF> CurveBuffer::decimated(int first, int last, int maxPoints) const {
+    first = qBound(0, first, m_size);
+    last = qBound(first, last, m_size);
+    const int n = last - first;
+    const int buckets = qMax(1, maxPoints / 2);
+    if (n <= 2 * buckets) return points(first, n);
+
+    QVector<QPointF> out;
+    out.reserve(2 * buckets + 2);
+    for (int b = 0; b < buckets; ++b) {
+        const int i0 = first + int(qint64(n) * b / buckets);
+        const int i1 = first + int(qint64(n) * (b + 1) / buckets);
+        int iMin = i0, iMax = i0;
+        double yMin = y(i0), yMax = yMin;
+        for (int i = i0 + 1; i < i1; ++i) {
+            const double v = y(i);
+            if (v < yMin) { yMin = v; iMin = i; }
+            else if (v > yMax) { yMax = v; iMax = i; }
+        }
+        if (b == 0 && qMin(iMin, iMax) != i0) out.push_back(at(i0));
+        out.push_back(at(qMin(iMin, iMax)));
+        if (iMax != iMin) out.push_back(at(qMax(iMin, iMax)));
+    }
+    // the newest sample always shows, even when it is no bucket's extreme
+    if (out.last() != at(last - 1)) out.push_back(at(last - 1));
+    return out;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+// 单条曲线的滚动采样缓冲，按 X 来源选择存储布局：
+//   Explicit  行内给出 x,y：存 QPointF（16 B/点），X 无序，范围计算逐点扫描；
+//   Index     X = 采样序号：只存 float Y（4 B/点），X = 首点序号 + 下标；
+//   HostTime  X = 读取端打戳的接收时间（秒）：float 时间偏移 + float Y（8 B/点）。
+// 隐式 X 单调递增：X 范围取首尾两点，按 X 截区间用下标运算（Index）或二分（HostTime）。
+// float 偏移以所在块的首个采样为基准（每块一个 double 基准），分辨率只取决于一块跨越的时长，
+// 与运行时长无关：1 kHz 流一块约 4 s，偏移精度在 µs 级。
+//
+// 采样按定长块存放：滚动丢弃整块释放，不搬移数据。拷贝一个 CurveBuffer 只复制块指针，
+// 得到的是拷贝时刻的只读快照——原缓冲此后只会写在快照范围之外（或新块里），
+// 所以快照可以交给后台线程读取（导出），既不阻塞采集也不复制数据。
+class CurveBuffer final {
+public:
+    enum class XMode { Explicit, Index, HostTime };
+
+    static constexpr int kChunkShift = 12;
+    static constexpr int kChunkSize = 1 << kChunkShift;     // samples per chunk
+
+    XMode mode() const { return m_mode; }
+    bool isImplicitX() const { return m_mode != XMode::Explicit; }
+    // the layouts differ, so switching drops the samples
+    void setMode(XMode mode);
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    void clear();
+
+    // Explicit: (x, y); Index: x is ignored; HostTime: x = receive time in seconds
+    void append(double x, double y);
+    // rolling window: drop the oldest samples beyond n
+    void keepLast(int n);
+
+    double x(int i) const;
+    double y(int i) const;
+    QPointF at(int i) const { return QPointF(x(i), y(i)); }
+
+    // false when empty
+    bool xRange(double *x0, double *x1) const;
+    // y extent of the samples with x in [x0, x1]; false when there are none
+    bool yRangeIn(double x0, double x1, double *y0, double *y1) const;
+    // implicit X only: [first, last) = the samples with x in [x0, x1]
+    void indexRange(double x0, double x1, int *first, int *last) const;
+
+    QVector<QPointF> points(int first, int count) const;
+    QVector<QPointF> toPoints() const { return points(0, size()); }
+    QVector<QPointF> lastPoints(int n) const;
+    // [first, last) reduced to about maxPoints: min and max y of each bucket, in sample order,
+    // so peaks survive at any zoom
+    QVector<QPointF> decimated(int first, int last, int maxPoints) const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<QPointF[]> xy;      // Explicit
+        std::unique_ptr<float[]> x;         // HostTime: seconds after xBase
+        std::unique_ptr<float[]> y;         // Index / HostTime
+        double xBase = 0.0;                 // HostTime: x of the chunk's first sample, fixed once written
+    };
+
+    // sample i -> chunk / slot
+    const Chunk &chunkOf(int i) const { return *m_chunks[size_t((m_head + i) >> kChunkShift)]; }
+    static int slotOf(int g) { return g & (kChunkSize - 1); }
+
+    // HostTime: first index whose x is >= key (upper: > key)
+    int searchX(double key, bool upper) const;
+
+    XMode m_mode = XMode::Explicit;
+    std::vector<std::shared_ptr<Chunk>> m_chunks;   // shared with snapshots
+    int m_head = 0;             // slot of sample 0 inside m_chunks[0]
+    int m_size = 0;
+    qint64 m_firstIndex = 0;    // Index: sample number of sample 0
+};
@@ -0,0 +1,104 @@
+#include "elf_image.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr quint32 PT_LOAD = 1;
+constexpr quint16 EM_ARM = 40;
+
+template <typename T>
+T rd(const uchar *p, bool le) {
+    T v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        const size_t shift = le ? i : sizeof(T) - 1 - i;
+        v = T(v | (T(p[i]) << (8 * shift)));
+    }
+    return v;
+}
+}
+
+bool ElfImage::load(const QString &path, QVector<FlashJob::Segment> *segments, Info *info, QString *err) {
+    segments->clear();
+    *info = Info();
+
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (err) *err = QString("cannot open %1: %2").arg(path, f.errorString());
+        return false;
+    }
+    const qint64 size = f.size();
+    const uchar *base = size > 0 ? f.map(0, size) : nullptr;
+    if (!base) {
+        if (err) *err = QString("cannot map %1").arg(path);
+        return false;
+    }
+
+    auto fail = [&](const QString &msg) {
+        if (err) *err = msg;
+        f.unmap(const_cast<uchar*>(base));
+        return false;
+    };
+
+    if (size < 52 || std::memcmp(base, "\x7f" "ELF", 4) != 0) return fail("not an ELF file");
+    if (base[4] != 1) return fail("not a 32-bit ELF");
+    const bool le = base[5] == 1;
+    if (base[5] != 1 && base[5] != 2) return fail("bad ELF data encoding");
+
+    const quint16 machine = rd<quint16>(base + 18, le);
+    if (machine != EM_ARM) return fail(QString("ELF machine %1 is not ARM").arg(machine));
+
+    info->entry = rd<quint32>(base + 24, le);
+    const quint32 phoff = rd<quint32>(base + 28, le);
+    const quint16 phentsize = rd<quint16>(base + 42, le);
+    const quint16 phnum = rd<quint16>(base + 44, le);
+    if (phentsize < 32 || qint64(phoff) + qint64(phnum) * phentsize > size) return fail("bad program header table");
+
+    QVector<FlashJob::Segment> raw;
+    for (int i = 0; i < phnum; ++i) {
+        const uchar *ph = base + phoff + qint64(i) * phentsize;
+        if (rd<quint32>(ph, le) != PT_LOAD) continue;
+        const quint32 offset = rd<quint32>(ph + 4, le);
+        const quint32 paddr = rd<quint32>(ph + 12, le);
+        const quint32 filesz = rd<quint32>(ph + 16, le);
+        if (filesz == 0) continue;                      // .bss and friends: nothing to program
+        if (qint64(offset) + filesz > size) return fail(QString("segment %1 runs past end of file").arg(i));
+        raw.push_back({paddr, QByteArray(reinterpret_cast<const char*>(base + offset), int(filesz))});
+    }
+    f.unmap(const_cast<uchar*>(base));
+
+    if (raw.isEmpty()) {
+        if (err) *err = "ELF has no loadable data";
+        return false;
+    }
+
+    std::sort(raw.begin(), raw.end(), [](const FlashJob::Segment &a, const FlashJob::Segment &b) {
+        return a.address < b.address;
+    });
+
+    // merge only touching segments; a gap stays a gap so its pages are neither written nor erased
+    for (const FlashJob::Segment &s : raw) {
+        if (!segments->isEmpty()) {
+            FlashJob::Segment &last = segments->last();
+            const quint32 lastEnd = last.address + quint32(last.data.size());
+            if (s.address < lastEnd) {
+                if (err) *err = QString("overlapping segments at 0x%1").arg(s.address, 8, 16, QLatin1Char('0'));
+                segments->clear();
+                return false;
+            }
+            if (s.address == lastEnd) {
+                last.data.append(s.data);
+                continue;
+            }
+        }
+        segments->push_back(s);
+    }
+
+    info->lowAddress = segments->first().address;
+    const FlashJob::Segment &hi = segments->last();
+    info->spanBytes = hi.address + quint32(hi.data.size()) - info->lowAddress;
+    for (const FlashJob::Segment &s : *segments) info->loadBytes += s.data.size();
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include "flash_job.h"
+
+// ELF32 固件读取：内存映射文件，按物理地址（LMA）收集 PT_LOAD 段，
+// 相邻段合并、段间空隙不填充，直接交给烧录任务（不再需要 objcopy 和 .bin）。
+class ElfImage final {
+public:
+    struct Info {
+        quint32 entry = 0;
+        quint32 lowAddress = 0;      // lowest segment address (vector table for Go)
+        qint64 loadBytes = 0;        // sum of segment sizes
+        quint32 spanBytes = 0;       // lowest to highest address, what a .bin would hold
+    };
+
+    static bool load(const QString &path, QVector<FlashJob::Segment> *segments, Info *info, QString *err);
+};
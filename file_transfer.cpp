@@ -0,0 +1,398 @@
+#include "file_transfer.h"
+#include "timestamp_clock.h"
+
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+#include <array>
+
+namespace {
+constexpr char SOH = 0x01;
+constexpr char STX = 0x02;
+constexpr char EOT = 0x04;
+constexpr char ACK = 0x06;
+constexpr char NAK = 0x15;
+constexpr char CAN = 0x18;
+constexpr char CRC_REQ = 'C';
+constexpr char PAD = 0x1A;
+
+constexpr int kBlockTimeoutMs = 10000;
+constexpr int kPollSliceMs = 100;               // cancel is checked at least this often
+constexpr qint64 kRateWindowNs = 1000000000;
+
+// CRC-16/XMODEM: poly 0x1021, init 0, no reflection
+quint16 crc16Xmodem(const char *data, int len) {
+    static const auto table = []() {
+        std::array<quint16, 256> t{};
+        for (int i = 0; i < 256; ++i) {
+            quint16 c = quint16(i << 8);
+            for (int b = 0; b < 8; ++b) c = (c & 0x8000) ? quint16((c << 1) ^ 0x1021) : quint16(c << 1);
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint16 crc = 0;
+    for (int i = 0; i < len; ++i) crc = quint16((crc << 8) ^ table[((crc >> 8) ^ quint8(data[i])) & 0xFF]);
+    return crc;
+}
+
+double bitsPerChar(const FileTransfer::PortSettings &ps) {
+    double bits = 1.0 + double(ps.dataBits);
+    if (ps.parity != QSerialPort::NoParity) bits += 1.0;
+    switch (ps.stopBits) {
+    case QSerialPort::OneAndHalfStop: bits += 1.5; break;
+    case QSerialPort::TwoStop:        bits += 2.0; break;
+    default:                          bits += 1.0; break;
+    }
+    return bits;
+}
+}
+
+FileTransfer::FileTransfer(QObject *parent)
+    : QObject(parent) {
+}
+
+FileTransfer::~FileTransfer() {
+    cancel();
+    wait();
+}
+
+double FileTransfer::lineBytesPerSecond(const PortSettings &ps) {
+    return double(ps.baud) / bitsPerChar(ps);
+}
+
+bool FileTransfer::start(const Config &cfg, QString *err) {
+    if (m_thread) {
+        if (err) *err = "transfer already running";
+        return false;
+    }
+    if (cfg.files.isEmpty()) {
+        if (err) *err = "no file selected";
+        return false;
+    }
+    for (const QString &path : cfg.files) {
+        if (!QFileInfo(path).isFile()) {
+            if (err) *err = QString("cannot read %1").arg(path);
+            return false;
+        }
+    }
+
+    m_cfg = cfg;
+    if (m_cfg.protocol != Protocol::Ymodem) m_cfg.files = QStringList{cfg.files.first()};
+    m_cfg.rawChunk = qMax(1, m_cfg.rawChunk);
+    m_cancel = false;
+    {
+        QMutexLocker lk(&m_progressMutex);
+        m_progress = Progress();
+        m_progress.fileCount = m_cfg.files.size();
+        for (const QString &path : m_cfg.files) m_progress.totalSize += QFileInfo(path).size();
+        m_rateAnchorNs = TimestampClock::nowNs();
+        m_rateAnchorBytes = 0;
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("FileTransfer");
+    m_thread->start();
+    return true;
+}
+
+void FileTransfer::cancel() {
+    m_cancel = true;
+}
+
+void FileTransfer::wait() {
+    if (!m_thread) return;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+FileTransfer::Progress FileTransfer::progress() const {
+    QMutexLocker lk(&m_progressMutex);
+    return m_progress;
+}
+
+void FileTransfer::beginFile(int index, const QString &name, qint64 size) {
+    QMutexLocker lk(&m_progressMutex);
+    m_progress.fileIndex = index;
+    m_progress.fileName = name;
+    m_progress.fileDone = 0;
+    m_progress.fileSize = size;
+}
+
+void FileTransfer::addDone(qint64 bytes) {
+    const qint64 now = TimestampClock::nowNs();
+    QMutexLocker lk(&m_progressMutex);
+    m_progress.fileDone += bytes;
+    m_progress.totalDone += bytes;
+    const qint64 dt = now - m_rateAnchorNs;
+    if (dt >= kRateWindowNs) {
+        m_progress.bps = double(m_progress.totalDone - m_rateAnchorBytes) * 1e9 / double(dt);
+        const double line = lineBytesPerSecond(m_cfg.port);
+        m_progress.linkPct = line > 0.0 ? 100.0 * m_progress.bps / line : 0.0;
+        m_rateAnchorNs = now;
+        m_rateAnchorBytes = m_progress.totalDone;
+    }
+}
+
+/* --------------------------- port I/O --------------------------- */
+
+int FileTransfer::readByte(QSerialPort &port, int timeoutMs) {
+    QElapsedTimer t;
+    t.start();
+    for (;;) {
+        char c = 0;
+        if (port.bytesAvailable() > 0 && port.getChar(&c)) return quint8(c);
+        if (m_cancel.load()) return -1;
+        const qint64 left = timeoutMs - t.elapsed();
+        if (left <= 0) return -1;
+        port.waitForReadyRead(int(qMin<qint64>(left, kPollSliceMs)));
+    }
+}
+
+bool FileTransfer::writeBlocking(QSerialPort &port, const QByteArray &bytes) {
+    if (port.write(bytes) != bytes.size()) return false;
+    // generous bound: twice the line time plus a second for the driver
+    const double line = lineBytesPerSecond(m_cfg.port);
+    const qint64 budgetMs = 1000 + (line > 0.0 ? qint64(2000.0 * bytes.size() / line) : 0);
+    QElapsedTimer t;
+    t.start();
+    while (port.bytesToWrite() > 0) {
+        if (m_cancel.load() || t.elapsed() > budgetMs) return false;
+        port.waitForBytesWritten(kPollSliceMs);
+    }
+    return true;
+}
+
+void FileTransfer::sendCancel(QSerialPort &port) {
+    port.write(QByteArray(8, CAN));
+    port.waitForBytesWritten(500);
+}
+
+/* --------------------------- raw --------------------------- */
+
+bool FileTransfer::sendRaw(QSerialPort &port, QString *err) {
+    QFile f(m_cfg.files.first());
+    if (!f.open(QIODevice::ReadOnly)) {
+        *err = QString("cannot open %1: %2").arg(f.fileName(), f.errorString());
+        return false;
+    }
+    beginFile(0, QFileInfo(f).fileName(), f.size());
+
+    const double line = lineBytesPerSecond(m_cfg.port);
+    const qint64 startNs = TimestampClock::nowNs();
+    qint64 sent = 0;
+    for (;;) {
+        const QByteArray chunk = f.read(m_cfg.rawChunk);
+        if (chunk.isEmpty()) break;
+
+        if (m_cfg.rawPaced && line > 0.0) {
+            // stay on the line-rate schedule so the driver buffer never fills up
+            const qint64 dueNs = startNs + qint64(double(sent) * 1e9 / line);
+            const qint64 aheadNs = dueNs - TimestampClock::nowNs();
+            if (aheadNs > 0) QThread::usleep(quint64(aheadNs / 1000));
+        }
+        if (m_cancel.load()) {
+            *err = "cancelled";
+            return false;
+        }
+        if (!writeBlocking(port, chunk)) {
+            *err = m_cancel.load() ? QString("cancelled") : QString("write failed: %1").arg(port.errorString());
+            return false;
+        }
+        sent += chunk.size();
+        addDone(chunk.size());
+    }
+    return true;
+}
+
+/* --------------------------- XMODEM / YMODEM --------------------------- */
+
+bool FileTransfer::waitForStart(QSerialPort &port, QString *err) {
+    {
+        QMutexLocker lk(&m_progressMutex);
+        m_progress.waitingReceiver = true;
+    }
+    QElapsedTimer t;
+    t.start();
+    bool ok = false;
+    while (!m_cancel.load() && t.elapsed() < m_cfg.startTimeoutMs) {
+        const int c = readByte(port, kPollSliceMs * 10);
+        if (c == CRC_REQ) { ok = true; break; }
+        if (c == CAN) {
+            *err = "receiver cancelled";
+            break;
+        }
+        if (c == NAK) continue;   // checksum-mode receiver; only CRC is supported, keep waiting for 'C'
+    }
+    {
+        QMutexLocker lk(&m_progressMutex);
+        m_progress.waitingReceiver = false;
+    }
+    if (!ok && err->isEmpty()) *err = m_cancel.load() ? QString("cancelled") : QString("receiver did not start (no 'C')");
+    return ok;
+}
+
+bool FileTransfer::sendPacket(QSerialPort &port, quint8 blockNo, const QByteArray &data, int blockSize,
+                              QString *err) {
+    QByteArray pkt;
+    pkt.reserve(3 + blockSize + 2);
+    pkt.append(blockSize == 1024 ? STX : SOH);
+    pkt.append(char(blockNo));
+    pkt.append(char(0xFF - blockNo));
+    pkt.append(data);
+    if (data.size() < blockSize) pkt.append(QByteArray(blockSize - data.size(), blockNo == 0 ? '\0' : PAD));
+    const quint16 crc = crc16Xmodem(pkt.constData() + 3, blockSize);
+    pkt.append(char(crc >> 8));
+    pkt.append(char(crc & 0xFF));
+
+    for (int attempt = 0; attempt <= m_cfg.maxRetries; ++attempt) {
+        if (attempt > 0) {
+            QMutexLocker lk(&m_progressMutex);
+            ++m_progress.retries;
+        }
+        port.clear(QSerialPort::Input);   // stale NAK/'C' from before this send
+        if (!writeBlocking(port, pkt)) {
+            *err = m_cancel.load() ? QString("cancelled") : QString("write failed: %1").arg(port.errorString());
+            return false;
+        }
+        const int r = readByte(port, kBlockTimeoutMs);
+        if (r == ACK) return true;
+        if (r == CAN && readByte(port, 1000) == CAN) {
+            *err = "receiver cancelled";
+            return false;
+        }
+        if (m_cancel.load()) {
+            *err = "cancelled";
+            sendCancel(port);
+            return false;
+        }
+        // NAK, timeout or garbage: resend
+    }
+    *err = QString("block %1: no ACK after %2 retries").arg(blockNo).arg(m_cfg.maxRetries);
+    sendCancel(port);
+    return false;
+}
+
+bool FileTransfer::sendFileBlocks(QSerialPort &port, QFile &file, QString *err) {
+    quint8 blockNo = 1;
+    for (;;) {
+        const QByteArray data = file.read(1024);
+        if (data.isEmpty()) break;
+        // short tail goes out as a 128-byte block: less padding on the wire
+        const int blockSize = data.size() <= 128 ? 128 : 1024;
+        if (!sendPacket(port, blockNo, data, blockSize, err)) return false;
+        addDone(data.size());
+        ++blockNo;
+    }
+    return sendEot(port, err);
+}
+
+bool FileTransfer::sendEot(QSerialPort &port, QString *err) {
+    // receivers commonly NAK the first EOT to confirm it
+    for (int attempt = 0; attempt <= m_cfg.maxRetries; ++attempt) {
+        port.clear(QSerialPort::Input);
+        if (!writeBlocking(port, QByteArray(1, EOT))) break;
+        const int r = readByte(port, kBlockTimeoutMs);
+        if (r == ACK) return true;
+        if (m_cancel.load()) break;
+    }
+    *err = m_cancel.load() ? QString("cancelled") : QString("EOT not acknowledged");
+    return false;
+}
+
+bool FileTransfer::sendXmodem(QSerialPort &port, QString *err) {
+    QFile f(m_cfg.files.first());
+    if (!f.open(QIODevice::ReadOnly)) {
+        *err = QString("cannot open %1: %2").arg(f.fileName(), f.errorString());
+        return false;
+    }
+    beginFile(0, QFileInfo(f).fileName(), f.size());
+    if (!waitForStart(port, err)) return false;
+    return sendFileBlocks(port, f, err);
+}
+
+bool FileTransfer::sendYmodem(QSerialPort &port, QString *err) {
+    for (int i = 0; i < m_cfg.files.size(); ++i) {
+        QFile f(m_cfg.files[i]);
+        if (!f.open(QIODevice::ReadOnly)) {
+            *err = QString("cannot open %1: %2").arg(f.fileName(), f.errorString());
+            sendCancel(port);
+            return false;
+        }
+        const QFileInfo fi(f);
+        beginFile(i, fi.fileName(), f.size());
+
+        // block 0: "name\0size mtime(octal)\0"
+        QByteArray header = fi.fileName().toUtf8();
+        header.append('\0');
+        header.append(QByteArray::number(f.size()));
+        header.append(' ');
+        header.append(QByteArray::number(fi.lastModified().toSecsSinceEpoch(), 8));
+        header.append('\0');
+        if (header.size() > 1024) {
+            *err = QString("file name too long: %1").arg(fi.fileName());
+            sendCancel(port);
+            return false;
+        }
+
+        if (!waitForStart(port, err)) return false;
+        if (!sendPacket(port, 0, header, header.size() <= 128 ? 128 : 1024, err)) return false;
+        if (!waitForStart(port, err)) return false;
+        if (!sendFileBlocks(port, f, err)) return false;
+    }
+
+    // empty block 0 ends the batch
+    if (!waitForStart(port, err)) return false;
+    return sendPacket(port, 0, QByteArray(), 128, err);
+}
+
+/* --------------------------- worker --------------------------- */
+
+void FileTransfer::run() {
+    QSerialPort port;
+    port.setPortName(m_cfg.port.portName);
+    port.setBaudRate(m_cfg.port.baud);
+    port.setDataBits(m_cfg.port.dataBits);
+    port.setParity(m_cfg.port.parity);
+    port.setStopBits(m_cfg.port.stopBits);
+    port.setFlowControl(m_cfg.port.flow);
+
+    bool ok = false;
+    QString err;
+    const qint64 startNs = TimestampClock::nowNs();
+    if (!port.open(QIODevice::ReadWrite)) {
+        err = QString("open %1 failed: %2").arg(m_cfg.port.portName, port.errorString());
+    } else {
+        port.setDataTerminalReady(m_cfg.port.dtr);
+        if (m_cfg.port.flow != QSerialPort::HardwareControl) port.setRequestToSend(m_cfg.port.rts);
+        port.clear();
+        switch (m_cfg.protocol) {
+        case Protocol::Raw:      ok = sendRaw(port, &err); break;
+        case Protocol::Xmodem1k: ok = sendXmodem(port, &err); break;
+        case Protocol::Ymodem:   ok = sendYmodem(port, &err); break;
+        }
+        port.close();
+    }
+
+    QString msg;
+    if (ok) {
+        const Progress p = progress();
+        const double secs = double(TimestampClock::nowNs() - startNs) / 1e9;
+        const double bps = secs > 0.0 ? double(p.totalDone) / secs : 0.0;
+        const double line = lineBytesPerSecond(m_cfg.port);
+        msg = QString("%1 bytes in %2 s, %3 B/s (%4% of line rate), %5 retries")
+                  .arg(p.totalDone)
+                  .arg(secs, 0, 'f', 2)
+                  .arg(qint64(bps))
+                  .arg(line > 0.0 ? 100.0 * bps / line : 0.0, 0, 'f', 1)
+                  .arg(p.retries);
+    } else {
+        msg = err;
+    }
+    emit finished(ok, msg);
+}
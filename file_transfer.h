@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QSerialPort>
+
+#include <atomic>
+
+class QThread;
+class QFile;
+
+// 文件发送：工作线程独占串口（终端先关闭端口，结束后重新打开），
+// 支持按波特率限速的原始流、XMODEM-1K/CRC 与 YMODEM 批量传输；
+// 进度、重传次数与相对理论线路速率的吞吐由线程更新，GUI 定时拉取。
+class FileTransfer final : public QObject {
+    Q_OBJECT
+public:
+    enum class Protocol { Raw, Xmodem1k, Ymodem };
+
+    struct PortSettings {
+        QString portName;
+        qint32 baud = 115200;
+        QSerialPort::DataBits dataBits = QSerialPort::Data8;
+        QSerialPort::Parity parity = QSerialPort::NoParity;
+        QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+        QSerialPort::FlowControl flow = QSerialPort::NoFlowControl;
+        bool dtr = true;             // modem lines as the terminal had them (boards may reset on a DTR edge)
+        bool rts = true;             // ignored under hardware flow control
+    };
+
+    struct Config {
+        PortSettings port;
+        Protocol protocol = Protocol::Xmodem1k;
+        QStringList files;           // XMODEM/raw: first file only; YMODEM: the whole batch
+        int rawChunk = 1024;
+        bool rawPaced = true;        // raw: hold the write rate at the line rate
+        int maxRetries = 10;         // per block
+        int startTimeoutMs = 60000;  // waiting for the receiver's 'C'
+    };
+
+    struct Progress {
+        int fileIndex = 0;
+        int fileCount = 0;
+        QString fileName;
+        qint64 fileDone = 0;
+        qint64 fileSize = 0;
+        qint64 totalDone = 0;        // payload bytes acknowledged (raw: written)
+        qint64 totalSize = 0;
+        quint64 retries = 0;
+        double bps = 0.0;            // payload bytes/s over the last window
+        double linkPct = 0.0;        // bps vs. theoretical line rate
+        bool waitingReceiver = false;
+    };
+
+    explicit FileTransfer(QObject *parent = nullptr);
+    ~FileTransfer() override;
+
+    bool start(const Config &cfg, QString *err = nullptr);
+    void cancel();                   // asynchronous; finished() follows
+    bool isRunning() const { return m_thread != nullptr; }
+    void wait();                     // join after finished()/cancel()
+
+    Progress progress() const;
+
+    static double lineBytesPerSecond(const PortSettings &ps);
+
+signals:
+    void finished(bool ok, const QString &msg);
+
+private:
+    void run();
+    bool sendRaw(QSerialPort &port, QString *err);
+    bool sendXmodem(QSerialPort &port, QString *err);
+    bool sendYmodem(QSerialPort &port, QString *err);
+
+    bool waitForStart(QSerialPort &port, QString *err);
+    bool sendPacket(QSerialPort &port, quint8 blockNo, const QByteArray &data, int blockSize,
+                    QString *err);
+    bool sendFileBlocks(QSerialPort &port, QFile &file, QString *err);
+    bool sendEot(QSerialPort &port, QString *err);
+    void sendCancel(QSerialPort &port);
+
+    int readByte(QSerialPort &port, int timeoutMs);
+    bool writeBlocking(QSerialPort &port, const QByteArray &bytes);
+    void beginFile(int index, const QString &name, qint64 size);
+    void addDone(qint64 bytes);
+
+    Config m_cfg;
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_cancel{false};
+
+    mutable QMutex m_progressMutex;
+    Progress m_progress;
+    qint64 m_rateAnchorNs = 0;
+    qint64 m_rateAnchorBytes = 0;
+};
@@ -0,0 +1,165 @@
+#include "file_transfer_dialog.h"
+
+#include <QComboBox>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QProgressBar>
+#include <QLabel>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+FileTransferDialog::FileTransferDialog(QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("文件发送");
+    setModal(false);
+    resize(480, 420);
+
+    m_protocolCombo = new QComboBox(this);
+    m_protocolCombo->addItem("原始数据流", int(FileTransfer::Protocol::Raw));
+    m_protocolCombo->addItem("XMODEM-1K (CRC)", int(FileTransfer::Protocol::Xmodem1k));
+    m_protocolCombo->addItem("YMODEM 批量", int(FileTransfer::Protocol::Ymodem));
+    m_protocolCombo->setCurrentIndex(1);
+
+    m_fileList = new QListWidget(this);
+    m_addBtn = new QPushButton("添加文件…", this);
+    m_removeBtn = new QPushButton("移除", this);
+
+    m_chunkSpin = new QSpinBox(this);
+    m_chunkSpin->setRange(1, 1024 * 1024);
+    m_chunkSpin->setValue(1024);
+    m_chunkSpin->setSuffix(" B");
+
+    m_pacedCheck = new QCheckBox("按波特率限速", this);
+    m_pacedCheck->setChecked(true);
+
+    m_retriesSpin = new QSpinBox(this);
+    m_retriesSpin->setRange(0, 100);
+    m_retriesSpin->setValue(10);
+
+    m_startBtn = new QPushButton("开始发送", this);
+    m_cancelBtn = new QPushButton("取消", this);
+    m_cancelBtn->setEnabled(false);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 1000);
+    m_progressBar->setValue(0);
+    m_progressLabel = new QLabel(this);
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+
+    auto *fileBtns = new QHBoxLayout();
+    fileBtns->addWidget(m_addBtn);
+    fileBtns->addWidget(m_removeBtn);
+    fileBtns->addStretch(1);
+
+    auto *form = new QFormLayout();
+    form->addRow("协议", m_protocolCombo);
+    form->addRow("分块大小", m_chunkSpin);
+    form->addRow(m_pacedCheck);
+    form->addRow("每块重试", m_retriesSpin);
+
+    auto *runBtns = new QHBoxLayout();
+    runBtns->addStretch(1);
+    runBtns->addWidget(m_startBtn);
+    runBtns->addWidget(m_cancelBtn);
+
+    auto *root = new QVBoxLayout(this);
+    root->addLayout(form);
+    root->addWidget(m_fileList, 1);
+    root->addLayout(fileBtns);
+    root->addWidget(m_progressBar);
+    root->addWidget(m_progressLabel);
+    root->addWidget(m_statusLabel);
+    root->addLayout(runBtns);
+
+    connect(m_addBtn, &QPushButton::clicked, this, &FileTransferDialog::onAddFiles);
+    connect(m_removeBtn, &QPushButton::clicked, this, &FileTransferDialog::onRemoveFile);
+    connect(m_protocolCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &FileTransferDialog::onProtocolChanged);
+    connect(m_startBtn, &QPushButton::clicked, this, &FileTransferDialog::startRequested);
+    connect(m_cancelBtn, &QPushButton::clicked, this, &FileTransferDialog::cancelRequested);
+    onProtocolChanged();
+}
+
+FileTransfer::Protocol FileTransferDialog::protocol() const {
+    return FileTransfer::Protocol(m_protocolCombo->currentData().toInt());
+}
+
+QStringList FileTransferDialog::files() const {
+    QStringList out;
+    for (int i = 0; i < m_fileList->count(); ++i) out << m_fileList->item(i)->data(Qt::UserRole).toString();
+    return out;
+}
+
+int FileTransferDialog::rawChunk() const {
+    return m_chunkSpin->value();
+}
+
+bool FileTransferDialog::rawPaced() const {
+    return m_pacedCheck->isChecked();
+}
+
+int FileTransferDialog::maxRetries() const {
+    return m_retriesSpin->value();
+}
+
+void FileTransferDialog::setRunning(bool running) {
+    m_startBtn->setEnabled(!running);
+    m_cancelBtn->setEnabled(running);
+    m_protocolCombo->setEnabled(!running);
+    m_addBtn->setEnabled(!running);
+    m_removeBtn->setEnabled(!running);
+    m_chunkSpin->setEnabled(!running && protocol() == FileTransfer::Protocol::Raw);
+    m_pacedCheck->setEnabled(!running && protocol() == FileTransfer::Protocol::Raw);
+    m_retriesSpin->setEnabled(!running && protocol() != FileTransfer::Protocol::Raw);
+    if (running) m_progressBar->setValue(0);
+}
+
+void FileTransferDialog::setProgress(const FileTransfer::Progress &p) {
+    m_progressBar->setValue(p.totalSize > 0 ? int(1000 * p.totalDone / p.totalSize) : 0);
+    if (p.waitingReceiver) {
+        m_progressLabel->setText(QString("[%1/%2] %3  等待接收方就绪 (C)…")
+                                     .arg(p.fileIndex + 1).arg(p.fileCount).arg(p.fileName));
+        return;
+    }
+    m_progressLabel->setText(QString("[%1/%2] %3  %4/%5 B   %6 B/s (%7% 线路速率)   重传 %8")
+                                 .arg(p.fileIndex + 1).arg(p.fileCount).arg(p.fileName)
+                                 .arg(p.fileDone).arg(p.fileSize)
+                                 .arg(qint64(p.bps))
+                                 .arg(p.linkPct, 0, 'f', 1)
+                                 .arg(p.retries));
+}
+
+void FileTransferDialog::setStatusText(const QString &text) {
+    m_statusLabel->setText(text);
+}
+
+void FileTransferDialog::onAddFiles() {
+    const QStringList paths = QFileDialog::getOpenFileNames(this, "选择文件");
+    for (const QString &path : paths) {
+        auto *item = new QListWidgetItem(QFileInfo(path).fileName(), m_fileList);
+        item->setData(Qt::UserRole, path);
+        item->setToolTip(path);
+    }
+}
+
+void FileTransferDialog::onRemoveFile() {
+    delete m_fileList->currentItem();
+}
+
+void FileTransferDialog::onProtocolChanged() {
+    const bool raw = protocol() == FileTransfer::Protocol::Raw;
+    m_chunkSpin->setEnabled(raw);
+    m_pacedCheck->setEnabled(raw);
+    m_retriesSpin->setEnabled(!raw);
+    if (protocol() != FileTransfer::Protocol::Ymodem && m_fileList->count() > 1)
+        setStatusText("仅 YMODEM 支持批量，将只发送第一个文件。");
+    else
+        setStatusText(QString());
+}
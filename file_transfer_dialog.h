@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QDialog>
+
+#include "file_transfer.h"
+
+class QComboBox;
+class QListWidget;
+class QPushButton;
+class QSpinBox;
+class QCheckBox;
+class QProgressBar;
+class QLabel;
+
+// 文件发送窗口（非模态）：协议 / 文件列表 / 原始流分块与限速，进度与吞吐显示。
+// 实际传输由终端驱动（需要先交出串口）。
+class FileTransferDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit FileTransferDialog(QWidget *parent = nullptr);
+
+    FileTransfer::Protocol protocol() const;
+    QStringList files() const;
+    int rawChunk() const;
+    bool rawPaced() const;
+    int maxRetries() const;
+
+    void setRunning(bool running);
+    void setProgress(const FileTransfer::Progress &p);
+    void setStatusText(const QString &text);
+
+signals:
+    void startRequested();
+    void cancelRequested();
+
+private slots:
+    void onAddFiles();
+    void onRemoveFile();
+    void onProtocolChanged();
+
+private:
+    QComboBox *m_protocolCombo = nullptr;
+    QListWidget *m_fileList = nullptr;
+    QPushButton *m_addBtn = nullptr;
+    QPushButton *m_removeBtn = nullptr;
+    QSpinBox *m_chunkSpin = nullptr;
+    QCheckBox *m_pacedCheck = nullptr;
+    QSpinBox *m_retriesSpin = nullptr;
+    QPushButton *m_startBtn = nullptr;
+    QPushButton *m_cancelBtn = nullptr;
+    QProgressBar *m_progressBar = nullptr;
+    QLabel *m_progressLabel = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,194 @@
+#include "flash_batch.h"
+#include "timestamp_clock.h"
+
+#include <QTimer>
+
+FlashBatch::FlashBatch(QObject *parent)
+    : QObject(parent) {
+}
+
+FlashBatch::~FlashBatch() {
+    blockSignals(true);              // owner is already half torn down
+    cancel();
+    qDeleteAll(m_jobs);              // each joins its worker
+}
+
+QString FlashBatch::stateName(State s) {
+    switch (s) {
+    case State::Pending:  return "等待";
+    case State::Running:  return "烧录中";
+    case State::Retrying: return "待重试";
+    case State::Passed:   return "通过";
+    case State::Failed:   return "失败";
+    }
+    return QString();
+}
+
+bool FlashBatch::start(const Config &cfg, QString *err) {
+    if (m_running) {
+        if (err) *err = "batch already running";
+        return false;
+    }
+    if (cfg.ports.isEmpty()) {
+        if (err) *err = "no port selected";
+        return false;
+    }
+    if (cfg.job.segments.isEmpty()) {
+        if (err) *err = "image is empty";
+        return false;
+    }
+
+    qDeleteAll(m_jobs);
+    m_jobs.clear();
+    m_units.clear();
+    m_unitStartNs.clear();
+
+    m_cfg = cfg;
+    m_cancelled = false;
+    m_running = true;
+    m_startNs = TimestampClock::nowNs();
+    m_endNs = 0;
+
+    for (int i = 0; i < m_cfg.ports.size(); ++i) {
+        Unit u;
+        u.port = m_cfg.ports.at(i);
+        m_units.push_back(u);
+        m_unitStartNs.push_back(0);
+
+        auto *job = new FlashJob();
+        m_jobs.push_back(job);
+        // finished() comes from the worker thread; queued onto ours
+        connect(job, &FlashJob::finished, this, [this, i](bool ok, const QString &msg) {
+            onJobFinished(i, ok, msg);
+        });
+        connect(job, &FlashJob::message, this, [this, i](const QString &text) {
+            emit message(m_units.at(i).port, text);
+        });
+    }
+    for (int i = 0; i < m_units.size(); ++i) startUnit(i);
+    return true;
+}
+
+void FlashBatch::cancel() {
+    m_cancelled = true;
+    for (FlashJob *job : m_jobs) job->cancel();
+
+    // boards parked for a retry have no worker to report back
+    for (int i = 0; i < m_units.size(); ++i) {
+        if (m_units.at(i).state != State::Retrying) continue;
+        m_units[i].state = State::Failed;
+        m_units[i].result = "cancelled";
+        emit unitFinished(i, false, m_units.at(i).result);
+    }
+    finishIfIdle();
+}
+
+void FlashBatch::startUnit(int index) {
+    Unit &u = m_units[index];
+    if (m_cancelled) {
+        u.state = State::Failed;
+        u.result = "cancelled";
+        emit unitFinished(index, false, u.result);
+        finishIfIdle();
+        return;
+    }
+
+    // segments are shared, not copied: every job only reads them
+    FlashJob::Config cfg = m_cfg.job;
+    cfg.portPath = u.port;
+
+    if (u.attempts == 0) m_unitStartNs[index] = TimestampClock::nowNs();
+    ++u.attempts;
+    u.state = State::Running;
+
+    QString err;
+    if (!m_jobs.at(index)->start(cfg, &err)) onJobFinished(index, false, err);
+}
+
+void FlashBatch::onJobFinished(int index, bool ok, const QString &msg) {
+    FlashJob *job = m_jobs.at(index);
+    job->wait();
+
+    Unit &u = m_units[index];
+    const Stm32Bootloader::ChipInfo chip = job->chipInfo();
+    if (chip.pid != 0) {
+        const QString pid = QString("PID 0x%1").arg(chip.pid, 4, 16, QLatin1Char('0'));
+        u.device = chip.deviceName.isEmpty() ? pid : QString("%1 (%2)").arg(chip.deviceName, pid);
+    }
+    u.progress = job->progress();
+    u.result = msg;
+
+    if (!ok && !m_cancelled && u.attempts <= m_cfg.maxRetries) {
+        u.state = State::Retrying;
+        emit message(u.port, QString("Attempt %1 failed (%2), retrying").arg(u.attempts).arg(msg));
+        QTimer::singleShot(m_cfg.retryDelayMs, this, [this, index]() {
+            if (m_units.at(index).state == State::Retrying) startUnit(index);
+        });
+        return;
+    }
+
+    u.state = ok ? State::Passed : State::Failed;
+    u.bytesWritten = ok ? job->diffStats().bytesWritten : 0;
+    u.seconds = double(TimestampClock::nowNs() - m_unitStartNs.at(index)) / 1e9;
+    emit unitFinished(index, ok, msg);
+    finishIfIdle();
+}
+
+void FlashBatch::finishIfIdle() {
+    if (!m_running) return;
+    for (const Unit &u : m_units) {
+        if (u.state != State::Passed && u.state != State::Failed) return;
+    }
+    m_running = false;
+    m_endNs = TimestampClock::nowNs();
+    emit finished();
+}
+
+QVector<FlashBatch::Unit> FlashBatch::units() const {
+    QVector<Unit> out = m_units;
+    for (int i = 0; i < out.size(); ++i) {
+        if (out.at(i).state != State::Running) continue;
+        out[i].progress = m_jobs.at(i)->progress();
+        if (out.at(i).device.isEmpty()) {
+            const Stm32Bootloader::ChipInfo chip = m_jobs.at(i)->chipInfo();
+            if (chip.pid != 0) out[i].device = chip.deviceName.isEmpty()
+                    ? QString("PID 0x%1").arg(chip.pid, 4, 16, QLatin1Char('0'))
+                    : chip.deviceName;
+        }
+        out[i].seconds = double(TimestampClock::nowNs() - m_unitStartNs.at(i)) / 1e9;
+    }
+    return out;
+}
+
+FlashBatch::Stats FlashBatch::stats() const {
+    Stats s;
+    s.boards = m_units.size();
+    if (m_startNs == 0) return s;
+
+    const qint64 endNs = m_running ? TimestampClock::nowNs() : m_endNs;
+    s.elapsed = double(endNs - m_startNs) / 1e9;
+
+    double boardSecs = 0.0;
+    for (const Unit &u : m_units) {
+        s.retries += qMax(0, u.attempts - 1);
+        if (u.state == State::Running || u.state == State::Retrying) {
+            ++s.active;
+            continue;
+        }
+        if (u.state == State::Pending) continue;
+        if (u.state == State::Passed) ++s.passed;
+        else ++s.failed;
+        s.bytesWritten += u.bytesWritten;
+        boardSecs += u.seconds;
+        if (s.minBoardSecs == 0.0 || u.seconds < s.minBoardSecs) s.minBoardSecs = u.seconds;
+        s.maxBoardSecs = qMax(s.maxBoardSecs, u.seconds);
+    }
+
+    const int done = s.passed + s.failed;
+    if (done > 0) {
+        s.avgBoardSecs = boardSecs / done;
+        s.secsPerBoard = s.elapsed / done;
+    }
+    if (s.elapsed > 0.0) s.kbps = double(s.bytesWritten) / 1024.0 / s.elapsed;
+    return s;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "flash_job.h"
+
+// 产线批量烧录：每个选中的串口一个 FlashJob 工作线程并行执行，
+// 固件段（QByteArray 隐式共享）所有板子只读共用一份。
+// 失败的板子按设定次数自动重试；单板与汇总统计由 GUI 定时拉取。
+class FlashBatch final : public QObject {
+    Q_OBJECT
+public:
+    enum class State { Pending, Running, Retrying, Passed, Failed };
+
+    struct Config {
+        FlashJob::Config job;        // image and options for every board; portPath is set per unit
+        QStringList ports;
+        int maxRetries = 1;          // extra attempts after a failure
+        int retryDelayMs = 1000;     // let the fixture settle before reconnecting
+    };
+
+    struct Unit {
+        QString port;
+        State state = State::Pending;
+        int attempts = 0;
+        FlashJob::Progress progress;
+        QString device;              // "name (PID 0x....)" once the bootloader answered
+        QString result;              // last finished() message
+        qint64 bytesWritten = 0;
+        double seconds = 0.0;        // first attempt start -> final result
+    };
+
+    struct Stats {
+        int boards = 0;
+        int passed = 0;
+        int failed = 0;
+        int active = 0;              // running or waiting for a retry
+        int retries = 0;
+        qint64 bytesWritten = 0;
+        double elapsed = 0.0;        // wall time of the batch
+        double kbps = 0.0;           // all boards together
+        double secsPerBoard = 0.0;   // wall time / finished boards (line takt)
+        double avgBoardSecs = 0.0;
+        double minBoardSecs = 0.0;
+        double maxBoardSecs = 0.0;
+    };
+
+    explicit FlashBatch(QObject *parent = nullptr);
+    ~FlashBatch() override;
+
+    bool start(const Config &cfg, QString *err = nullptr);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    QVector<Unit> units() const;     // with live progress of the running jobs
+    Stats stats() const;
+
+    static QString stateName(State s);
+
+signals:
+    void message(const QString &port, const QString &text);
+    void unitFinished(int index, bool ok, const QString &msg);
+    void finished();
+
+private:
+    void startUnit(int index);
+    void onJobFinished(int index, bool ok, const QString &msg);
+    void finishIfIdle();
+
+    Config m_cfg;
+    QVector<FlashJob*> m_jobs;       // owned, one per port
+    QVector<Unit> m_units;
+    QVector<qint64> m_unitStartNs;
+    bool m_running = false;
+    bool m_cancelled = false;
+    qint64 m_startNs = 0;
+    qint64 m_endNs = 0;
+};
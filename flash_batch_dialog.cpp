@@ -0,0 +1,186 @@
+#include "flash_batch_dialog.h"
+
+#include <QListWidget>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QColor>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+namespace {
+enum Column { ColPort = 0, ColDevice, ColState, ColProgress, ColRate, ColAttempts, ColTime, ColResult, ColumnCount };
+
+QTableWidgetItem *cell(QTableWidget *table, int row, int col) {
+    QTableWidgetItem *item = table->item(row, col);
+    if (!item) {
+        item = new QTableWidgetItem();
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        table->setItem(row, col, item);
+    }
+    return item;
+}
+}
+
+FlashBatchDialog::FlashBatchDialog(QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("批量烧录");
+    setModal(false);
+    resize(860, 560);
+
+    m_portList = new QListWidget(this);
+    m_portList->setMaximumHeight(140);
+    m_refreshBtn = new QPushButton("刷新串口", this);
+    m_allBtn = new QPushButton("全选", this);
+
+    m_retriesSpin = new QSpinBox(this);
+    m_retriesSpin->setRange(0, 10);
+    m_retriesSpin->setValue(1);
+    m_retriesSpin->setToolTip("失败后自动重试的次数");
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"端口", "芯片", "状态", "进度", "速率", "尝试", "用时", "结果"});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(ColResult, QHeaderView::Stretch);
+    m_table->setColumnWidth(ColPort, 190);
+    m_table->setColumnWidth(ColDevice, 120);
+    m_table->setColumnWidth(ColState, 60);
+    m_table->setColumnWidth(ColProgress, 120);
+    m_table->setColumnWidth(ColRate, 80);
+    m_table->setColumnWidth(ColAttempts, 40);
+    m_table->setColumnWidth(ColTime, 60);
+
+    m_statsLabel = new QLabel(this);
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+
+    m_startBtn = new QPushButton("开始", this);
+    m_cancelBtn = new QPushButton("取消", this);
+    m_cancelBtn->setEnabled(false);
+
+    auto *portBtns = new QHBoxLayout();
+    portBtns->addWidget(m_refreshBtn);
+    portBtns->addWidget(m_allBtn);
+    portBtns->addStretch(1);
+
+    auto *form = new QFormLayout();
+    form->addRow("失败重试", m_retriesSpin);
+
+    auto *runBtns = new QHBoxLayout();
+    runBtns->addStretch(1);
+    runBtns->addWidget(m_startBtn);
+    runBtns->addWidget(m_cancelBtn);
+
+    auto *root = new QVBoxLayout(this);
+    root->addWidget(m_portList);
+    root->addLayout(portBtns);
+    root->addLayout(form);
+    root->addWidget(m_table, 1);
+    root->addWidget(m_statsLabel);
+    root->addWidget(m_statusLabel);
+    root->addLayout(runBtns);
+
+    connect(m_refreshBtn, &QPushButton::clicked, this, &FlashBatchDialog::refreshRequested);
+    connect(m_allBtn, &QPushButton::clicked, this, [this]() {
+        for (int i = 0; i < m_portList->count(); ++i) m_portList->item(i)->setCheckState(Qt::Checked);
+    });
+    connect(m_startBtn, &QPushButton::clicked, this, &FlashBatchDialog::startRequested);
+    connect(m_cancelBtn, &QPushButton::clicked, this, &FlashBatchDialog::cancelRequested);
+}
+
+void FlashBatchDialog::setPorts(const QList<QPair<QString, QString>> &ports) {
+    const QStringList checked = selectedPorts();
+    m_portList->clear();
+    for (const auto &p : ports) {
+        auto *item = new QListWidgetItem(p.second, m_portList);
+        item->setData(Qt::UserRole, p.first);
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+        item->setCheckState(checked.contains(p.first) ? Qt::Checked : Qt::Unchecked);
+    }
+}
+
+QStringList FlashBatchDialog::selectedPorts() const {
+    QStringList out;
+    for (int i = 0; i < m_portList->count(); ++i) {
+        const QListWidgetItem *item = m_portList->item(i);
+        if (item->checkState() == Qt::Checked) out << item->data(Qt::UserRole).toString();
+    }
+    return out;
+}
+
+int FlashBatchDialog::maxRetries() const {
+    return m_retriesSpin->value();
+}
+
+void FlashBatchDialog::setRunning(bool running) {
+    m_startBtn->setEnabled(!running);
+    m_cancelBtn->setEnabled(running);
+    m_portList->setEnabled(!running);
+    m_refreshBtn->setEnabled(!running);
+    m_allBtn->setEnabled(!running);
+    m_retriesSpin->setEnabled(!running);
+}
+
+void FlashBatchDialog::setUnits(const QVector<FlashBatch::Unit> &units) {
+    if (m_table->rowCount() != units.size()) {
+        m_table->setRowCount(units.size());
+        for (int row = 0; row < units.size(); ++row) {
+            auto *bar = new QProgressBar(m_table);
+            bar->setRange(0, 1000);
+            m_table->setCellWidget(row, ColProgress, bar);
+        }
+    }
+
+    for (int row = 0; row < units.size(); ++row) {
+        const FlashBatch::Unit &u = units.at(row);
+        const FlashJob::Progress &p = u.progress;
+
+        cell(m_table, row, ColPort)->setText(u.port);
+        cell(m_table, row, ColDevice)->setText(u.device);
+
+        QString state = FlashBatch::stateName(u.state);
+        if (u.state == FlashBatch::State::Running) state = FlashJob::phaseName(p.phase);
+        QTableWidgetItem *stateItem = cell(m_table, row, ColState);
+        stateItem->setText(state);
+        if (u.state == FlashBatch::State::Passed) stateItem->setForeground(QColor(0, 120, 0));
+        else if (u.state == FlashBatch::State::Failed) stateItem->setForeground(QColor(180, 0, 0));
+        else stateItem->setForeground(QColor(0, 0, 0));
+
+        auto *bar = qobject_cast<QProgressBar*>(m_table->cellWidget(row, ColProgress));
+        if (bar) {
+            int value = 0;
+            if (u.state == FlashBatch::State::Passed) value = 1000;
+            else if (p.total > 0) value = int(1000 * p.done / p.total);
+            bar->setValue(value);
+            bar->setFormat(u.state == FlashBatch::State::Running ? FlashJob::phaseName(p.phase) + " %p%" : QString("%p%"));
+        }
+
+        cell(m_table, row, ColRate)->setText(p.kbps > 0.0 ? QString("%1 KB/s").arg(p.kbps, 0, 'f', 1) : QString());
+        cell(m_table, row, ColAttempts)->setText(QString::number(u.attempts));
+        cell(m_table, row, ColTime)->setText(u.attempts > 0 ? QString("%1 s").arg(u.seconds, 0, 'f', 1) : QString());
+        QTableWidgetItem *resultItem = cell(m_table, row, ColResult);
+        resultItem->setText(u.result);
+        resultItem->setToolTip(u.result);
+    }
+}
+
+void FlashBatchDialog::setStats(const FlashBatch::Stats &s) {
+    m_statsLabel->setText(QString("通过 %1 / 失败 %2 / 进行中 %3（共 %4 块，重试 %5 次）   "
+                                  "用时 %6 s   汇总 %7 KB/s   节拍 %8 s/块   单板 %9 s（%10–%11 s）")
+                              .arg(s.passed).arg(s.failed).arg(s.active).arg(s.boards).arg(s.retries)
+                              .arg(s.elapsed, 0, 'f', 1)
+                              .arg(s.kbps, 0, 'f', 1)
+                              .arg(s.secsPerBoard, 0, 'f', 1)
+                              .arg(s.avgBoardSecs, 0, 'f', 1)
+                              .arg(s.minBoardSecs, 0, 'f', 1)
+                              .arg(s.maxBoardSecs, 0, 'f', 1));
+}
+
+void FlashBatchDialog::setStatusText(const QString &text) {
+    m_statusLabel->setText(text);
+}
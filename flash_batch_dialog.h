@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QDialog>
+#include <QPair>
+
+#include "flash_batch.h"
+
+class QListWidget;
+class QTableWidget;
+class QSpinBox;
+class QPushButton;
+class QLabel;
+
+// 批量烧录窗口（非模态）：勾选串口、重试次数；每个端口一行进度 / 结果，底部汇总统计。
+// 固件与烧录选项取自主界面，实际任务由 MainWindow 驱动。
+class FlashBatchDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit FlashBatchDialog(QWidget *parent = nullptr);
+
+    // (path, label); keeps the check state of ports that are still present
+    void setPorts(const QList<QPair<QString, QString>> &ports);
+    QStringList selectedPorts() const;
+    int maxRetries() const;
+
+    void setRunning(bool running);
+    void setUnits(const QVector<FlashBatch::Unit> &units);
+    void setStats(const FlashBatch::Stats &s);
+    void setStatusText(const QString &text);
+
+signals:
+    void refreshRequested();
+    void startRequested();
+    void cancelRequested();
+
+private:
+    QListWidget *m_portList = nullptr;
+    QPushButton *m_refreshBtn = nullptr;
+    QPushButton *m_allBtn = nullptr;
+    QSpinBox *m_retriesSpin = nullptr;
+    QTableWidget *m_table = nullptr;
+    QLabel *m_statsLabel = nullptr;
+    QLabel *m_statusLabel = nullptr;
+    QPushButton *m_startBtn = nullptr;
+    QPushButton *m_cancelBtn = nullptr;
+};
@@ -0,0 +1,480 @@
+#include "flash_job.h"
+#include "timestamp_clock.h"
+#include "flash_page_cache.h"
+
+#include <QThread>
+#include <QSerialPort>
+#include <QMutexLocker>
+
+#include <cstring>
+
+namespace {
+constexpr int kVerifyLag = 2;          // pages between a write and its read-back
+constexpr int kFallbackUnit = 2048;    // unit size when the page layout is unknown
+}
+
+FlashJob::FlashJob(QObject *parent)
+    : QObject(parent) {
+}
+
+FlashJob::~FlashJob() {
+    cancel();
+    wait();
+}
+
+QString FlashJob::phaseName(Phase p) {
+    switch (p) {
+    case Phase::Idle:       return "空闲";
+    case Phase::Connecting: return "连接";
+    case Phase::Comparing:  return "比对";
+    case Phase::Erasing:    return "擦除";
+    case Phase::Writing:    return "写入";
+    case Phase::Verifying:  return "校验";
+    case Phase::Starting:   return "运行";
+    case Phase::Done:       return "完成";
+    }
+    return QString();
+}
+
+bool FlashJob::start(const Config &cfg, QString *err) {
+    if (m_thread) {
+        if (err) *err = "flash already running";
+        return false;
+    }
+    qint64 total = 0;
+    for (const Segment &s : cfg.segments) total += s.data.size();
+    if (total == 0) {
+        if (err) *err = "image is empty";
+        return false;
+    }
+
+    m_cfg = cfg;
+    m_cancel = false;
+    {
+        QMutexLocker lk(&m_mutex);
+        m_progress = Progress();
+        m_chip = Stm32Bootloader::ChipInfo();
+        m_diff = DiffStats();
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("FlashJob");
+    m_thread->start();
+    return true;
+}
+
+void FlashJob::cancel() {
+    m_cancel = true;
+}
+
+void FlashJob::wait() {
+    if (!m_thread) return;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+FlashJob::Progress FlashJob::progress() const {
+    QMutexLocker lk(&m_mutex);
+    return m_progress;
+}
+
+Stm32Bootloader::ChipInfo FlashJob::chipInfo() const {
+    QMutexLocker lk(&m_mutex);
+    return m_chip;
+}
+
+FlashJob::DiffStats FlashJob::diffStats() const {
+    QMutexLocker lk(&m_mutex);
+    return m_diff;
+}
+
+void FlashJob::setPhase(Phase p, qint64 total) {
+    QMutexLocker lk(&m_mutex);
+    m_progress.phase = p;
+    m_progress.done = 0;
+    m_progress.total = total;
+    m_progress.kbps = 0.0;
+    m_phaseStartNs = TimestampClock::nowNs();
+}
+
+void FlashJob::addDone(qint64 bytes) {
+    const qint64 now = TimestampClock::nowNs();
+    QMutexLocker lk(&m_mutex);
+    m_progress.done += bytes;
+    const double secs = double(now - m_phaseStartNs) / 1e9;
+    if (secs > 0.0) m_progress.kbps = double(m_progress.done) / 1024.0 / secs;
+}
+
+void FlashJob::addVerified(qint64 bytes) {
+    const qint64 now = TimestampClock::nowNs();
+    QMutexLocker lk(&m_mutex);
+    m_progress.verified += bytes;
+    if (m_progress.phase != Phase::Verifying) return;
+    m_progress.done += bytes;
+    const double secs = double(now - m_phaseStartNs) / 1e9;
+    if (secs > 0.0) m_progress.kbps = double(m_progress.done) / 1024.0 / secs;
+}
+
+/* --------------------------- steps --------------------------- */
+
+bool FlashJob::connectTarget(QSerialPort &port, Stm32Bootloader &bl, QString *err) {
+    setPhase(Phase::Connecting, 0);
+
+    const QString entry = m_cfg.gpioSeq.section(':', 0, 0);
+    if (!entry.isEmpty()) {
+        if (!Stm32Bootloader::applyGpioSequence(&port, entry, err)) return false;
+        emit message(QString("Entry sequence applied: %1").arg(entry));
+    }
+    port.clear();
+
+    if (!bl.sync(err)) return false;
+
+    Stm32Bootloader::ChipInfo chip;
+    if (!bl.get(&chip, err)) return false;
+    if (chip.hasCommand(0x01) && !bl.getVersion(&chip, err)) return false;
+    if (!bl.getId(&chip, err)) return false;
+    if (chip.uidAddress != 0 && chip.hasCommand(0x11)) {
+        // identity for the page cache; read-protected parts NACK and fall back to the port
+        QString uidErr;
+        QByteArray uid;
+        if (bl.readMemory(chip.uidAddress, 12, &uid, &uidErr)) chip.uid = uid;
+    }
+    {
+        QMutexLocker lk(&m_mutex);
+        m_chip = chip;
+    }
+    emit message(QString("Bootloader v%1.%2, PID 0x%3 %4")
+                     .arg(chip.bootloaderVersion >> 4).arg(chip.bootloaderVersion & 0x0F)
+                     .arg(chip.pid, 4, 16, QLatin1Char('0'))
+                     .arg(chip.deviceName.isEmpty() ? QString("(unknown device)") : chip.deviceName));
+    return true;
+}
+
+bool FlashJob::planPages(Stm32Bootloader &bl, FlashPageCache *cache, QString *err) {
+    const Stm32Bootloader::ChipInfo chip = chipInfo();
+    m_units.clear();
+    m_erasePages.clear();
+    m_changedStarts.clear();
+    m_pageHashes.clear();
+    m_massErase = false;
+
+    DiffStats diff;
+    for (const Segment &s : m_cfg.segments) diff.bytesImage += s.data.size();
+
+    // every erase unit the image touches; gaps between segments stay as they are
+    struct Page { int index; quint32 start; quint32 size; };
+    QVector<Page> pages;
+    quint32 unmapped = 0;
+    for (const Segment &s : m_cfg.segments) {
+        quint32 addr = s.address;
+        const quint32 end = s.address + quint32(s.data.size());
+        while (addr < end) {
+            Page p{};
+            if (!Stm32Bootloader::pageAt(chip, addr, &p.index, &p.start, &p.size)) {
+                m_massErase = true;
+                unmapped = addr;
+                break;
+            }
+            if (pages.isEmpty() || pages.last().start != p.start) pages.push_back(p);
+            addr = p.start + p.size;
+        }
+        if (m_massErase) break;
+    }
+
+    if (m_massErase) {
+        // mass erase also wipes EEPROM-emulation / calibration pages the image does not touch: opt-in only
+        if (!m_cfg.allowMassErase) {
+            *err = chip.flashSize == 0
+                       ? QString("flash layout unknown for PID 0x%1; enable mass erase to flash it anyway")
+                             .arg(chip.pid, 3, 16, QLatin1Char('0'))
+                       : QString("image data at 0x%1 is outside flash (0x%2, %3 KiB), e.g. option bytes or OTP; "
+                                 "remove that section or enable mass erase")
+                             .arg(unmapped, 8, 16, QLatin1Char('0'))
+                             .arg(chip.flashStart, 8, 16, QLatin1Char('0'))
+                             .arg(chip.flashSize / 1024);
+            return false;
+        }
+        emit message("Flash layout unknown for this device (or image outside flash): mass erase (allowed), full write.");
+        // no page geometry: fixed-size units keep the write/verify pipeline going
+        for (const Segment &s : m_cfg.segments) {
+            for (int off = 0; off < s.data.size(); off += kFallbackUnit) {
+                Unit u;
+                u.start = s.address + quint32(off);
+                u.pieces.push_back({u.start, s.data.mid(off, kFallbackUnit)});
+                u.bytes = u.pieces.first().data.size();
+                m_units.push_back(u);
+            }
+        }
+        diff.bytesWritten = diff.bytesImage;
+        QMutexLocker lk(&m_mutex);
+        m_diff = diff;
+        return true;
+    }
+
+    diff.pagesTotal = pages.size();
+    setPhase(Phase::Comparing, pages.size());
+    QByteArray readBack;
+    for (const Page &p : pages) {
+        if (m_cancel.load()) {
+            *err = "cancelled";
+            return false;
+        }
+
+        // what the page holds after erase + write: image bytes over 0xFF
+        QByteArray expected(int(p.size), char(0xFF));
+        Unit unit;
+        unit.start = p.start;
+        for (const Segment &s : m_cfg.segments) {
+            const quint32 lo = qMax(s.address, p.start);
+            const quint32 hi = qMin(s.address + quint32(s.data.size()), p.start + p.size);
+            if (lo >= hi) continue;
+            const QByteArray bytes = s.data.mid(int(lo - s.address), int(hi - lo));
+            expected.replace(int(lo - p.start), bytes.size(), bytes);
+            unit.pieces.push_back({lo, bytes});
+            unit.bytes += bytes.size();
+        }
+        const QByteArray hash = FlashPageCache::hashPage(expected);
+        m_pageHashes.push_back({p.start, hash});
+
+        bool same = m_cfg.differential && cache->pageHash(p.start) == hash;
+        if (same && m_cfg.diffReadBack) {
+            // trust, but check: the board may have been flashed by something else since
+            for (quint32 off = 0; same && off < p.size; off += Stm32Bootloader::kMaxRead) {
+                const int len = int(qMin<quint32>(Stm32Bootloader::kMaxRead, p.size - off));
+                if (!bl.readMemory(p.start + off, len, &readBack, err)) return false;
+                same = readBack == expected.mid(int(off), len);
+            }
+        }
+
+        unit.write = !same;
+        if (unit.write) {
+            m_erasePages.push_back(p.index);
+            m_changedStarts.push_back(p.start);
+            ++diff.pagesChanged;
+            diff.bytesWritten += unit.bytes;
+        }
+        m_units.push_back(unit);
+        addDone(1);
+    }
+
+    {
+        QMutexLocker lk(&m_mutex);
+        m_diff = diff;
+    }
+    if (m_cfg.differential) {
+        emit message(QString("Differential: %1 of %2 %3 changed, %4 of %5 bytes to write")
+                         .arg(diff.pagesChanged).arg(diff.pagesTotal)
+                         .arg(chip.sectors ? "sector(s)" : "page(s)")
+                         .arg(diff.bytesWritten).arg(diff.bytesImage));
+    }
+    return true;
+}
+
+bool FlashJob::erasePlanned(Stm32Bootloader &bl, QString *err) {
+    const Stm32Bootloader::ChipInfo chip = chipInfo();
+    m_eraseStarted = true;
+    if (m_massErase) {
+        setPhase(Phase::Erasing, 0);
+        return bl.massErase(chip, err);
+    }
+    setPhase(Phase::Erasing, m_erasePages.size());
+    if (m_erasePages.isEmpty()) return true;
+    emit message(QString("Erasing %1 %2").arg(m_erasePages.size()).arg(chip.sectors ? "sector(s)" : "page(s)"));
+    if (!bl.erasePages(chip, m_erasePages, err)) return false;
+    addDone(m_erasePages.size());
+    return true;
+}
+
+bool FlashJob::writeUnit(Stm32Bootloader &bl, int unit, QString *err) {
+    for (const Segment &s : m_units[unit].pieces) {
+        for (int off = 0; off < s.data.size(); ) {
+            if (m_cancel.load()) {
+                *err = "cancelled";
+                return false;
+            }
+            // keep blocks on 256-byte boundaries after an unaligned start
+            const quint32 addr = s.address + quint32(off);
+            const int room = Stm32Bootloader::kMaxWrite - int(addr % Stm32Bootloader::kMaxWrite);
+            const int len = qMin(room, s.data.size() - off);
+            if (!bl.writeMemory(addr, s.data.mid(off, len), err)) return false;
+            off += len;
+            addDone(len);
+        }
+    }
+    return true;
+}
+
+bool FlashJob::verifyUnit(Stm32Bootloader &bl, int unit, QString *err) {
+    QByteArray readBack;
+    for (const Segment &s : m_units[unit].pieces) {
+        for (int off = 0; off < s.data.size(); ) {
+            if (m_cancel.load()) {
+                *err = "cancelled";
+                return false;
+            }
+            const quint32 addr = s.address + quint32(off);
+            const int len = qMin(Stm32Bootloader::kMaxRead, s.data.size() - off);
+            if (!bl.readMemory(addr, len, &readBack, err)) return false;
+
+            // compare the block as it arrives; only a mismatch pays for the byte scan
+            const char *want = s.data.constData() + off;
+            if (std::memcmp(readBack.constData(), want, size_t(len)) != 0) {
+                int i = 0;
+                while (i < len && readBack[i] == want[i]) ++i;
+                *err = QString("verify mismatch at 0x%1: wrote 0x%2, read 0x%3")
+                           .arg(addr + quint32(i), 8, 16, QLatin1Char('0'))
+                           .arg(quint8(want[i]), 2, 16, QLatin1Char('0'))
+                           .arg(quint8(readBack[i]), 2, 16, QLatin1Char('0'));
+                return false;
+            }
+            off += len;
+            addVerified(len);
+        }
+    }
+    return true;
+}
+
+bool FlashJob::writeAndVerify(Stm32Bootloader &bl, QString *err) {
+    QVector<int> written, skipped;
+    qint64 writeTotal = 0, verifyTotal = 0;
+    for (int i = 0; i < m_units.size(); ++i) {
+        if (m_units[i].write) {
+            written.push_back(i);
+            writeTotal += m_units[i].bytes;
+        } else {
+            skipped.push_back(i);
+        }
+    }
+    if (m_cfg.verify) {
+        for (int i : written) verifyTotal += m_units[i].bytes;
+        if (!m_cfg.verifyWrittenOnly) {
+            for (int i : skipped) verifyTotal += m_units[i].bytes;
+        }
+    }
+
+    setPhase(Phase::Writing, writeTotal);
+    {
+        QMutexLocker lk(&m_mutex);
+        m_progress.verified = 0;
+        m_progress.verifyTotal = verifyTotal;
+    }
+
+    // read-back trails the writes by kVerifyLag pages: a bad page stops the run
+    // while later pages are still unwritten, instead of after the whole image
+    int nextVerify = 0;
+    for (int w = 0; w < written.size(); ++w) {
+        if (!writeUnit(bl, written[w], err)) return false;
+        while (m_cfg.verify && nextVerify <= w - kVerifyLag) {
+            if (!verifyUnit(bl, written[nextVerify++], err)) return false;
+        }
+    }
+    if (!m_cfg.verify) return true;
+
+    const qint64 verifiedSoFar = progress().verified;
+    setPhase(Phase::Verifying, verifyTotal);
+    {
+        QMutexLocker lk(&m_mutex);
+        m_progress.done = verifiedSoFar;
+        m_progress.verified = verifiedSoFar;
+        m_progress.verifyTotal = verifyTotal;
+    }
+    while (nextVerify < written.size()) {
+        if (!verifyUnit(bl, written[nextVerify++], err)) return false;
+    }
+    if (!m_cfg.verifyWrittenOnly) {
+        for (int i : skipped) {
+            if (!verifyUnit(bl, i, err)) return false;
+        }
+    }
+    return true;
+}
+
+void FlashJob::updateCache(FlashPageCache *cache, bool ok) {
+    if (!m_eraseStarted) return;   // nothing on the chip changed
+
+    if (m_massErase) {
+        cache->clear();
+    } else {
+        // a failed run leaves changed pages in an unknown state
+        for (quint32 start : m_changedStarts) cache->removePage(start);
+    }
+    if (ok) {
+        for (const auto &ph : m_pageHashes) cache->setPageHash(ph.first, ph.second);
+    }
+    QString err;
+    if (!cache->save(&err)) emit message(QString("Page cache not saved: %1").arg(err));
+}
+
+/* --------------------------- worker --------------------------- */
+
+void FlashJob::run() {
+    QSerialPort port;
+    port.setPortName(m_cfg.portPath);
+    port.setBaudRate(m_cfg.baud);
+    port.setDataBits(QSerialPort::Data8);
+    port.setParity(QSerialPort::EvenParity);     // AN3155: 8E1
+    port.setStopBits(QSerialPort::OneStop);
+    port.setFlowControl(QSerialPort::NoFlowControl);
+
+    bool ok = false;
+    QString err;
+    const qint64 startNs = TimestampClock::nowNs();
+    qint64 writeVerifyNs = 0;
+    m_eraseStarted = false;
+
+    if (!port.open(QIODevice::ReadWrite)) {
+        err = QString("open %1 failed: %2").arg(m_cfg.portPath, port.errorString());
+    } else {
+        Stm32Bootloader bl(&port, &m_cancel);
+        ok = connectTarget(port, bl, &err);
+
+        if (ok) {
+            FlashPageCache cache(FlashPageCache::deviceKey(chipInfo(), m_cfg.portPath));
+            cache.load();
+
+            ok = planPages(bl, &cache, &err) && erasePlanned(bl, &err);
+            if (ok) {
+                const qint64 wvStart = TimestampClock::nowNs();
+                ok = writeAndVerify(bl, &err);
+                writeVerifyNs = TimestampClock::nowNs() - wvStart;
+            }
+            updateCache(&cache, ok);
+        }
+
+        if (ok && m_cfg.go) {
+            setPhase(Phase::Starting, 0);
+            ok = bl.go(m_cfg.goAddress, &err);
+            const QString exit = m_cfg.gpioSeq.section(':', 1, 1);
+            if (ok && !exit.isEmpty()) ok = Stm32Bootloader::applyGpioSequence(&port, exit, &err);
+        }
+        port.close();
+    }
+
+    if (ok) setPhase(Phase::Done, 0);
+
+    QString msg;
+    if (ok) {
+        DiffStats diff = diffStats();
+        const qint64 skipped = diff.bytesImage - diff.bytesWritten;
+        if (skipped > 0 && diff.bytesWritten > 0) {
+            diff.secondsSaved = double(writeVerifyNs) / 1e9 * double(skipped) / double(diff.bytesWritten);
+        }
+        {
+            QMutexLocker lk(&m_mutex);
+            m_diff = diff;
+        }
+        const double secs = double(TimestampClock::nowNs() - startNs) / 1e9;
+        msg = QString("%1 bytes in %2 s (%3 KiB/s overall)")
+                  .arg(diff.bytesWritten)
+                  .arg(secs, 0, 'f', 2)
+                  .arg(secs > 0.0 ? double(diff.bytesWritten) / 1024.0 / secs : 0.0, 0, 'f', 1);
+        if (m_cfg.differential && skipped > 0) {
+            msg += QString(", skipped %1 unchanged bytes").arg(skipped);
+            if (diff.secondsSaved > 0.0) msg += QString(" (~%1 s saved)").arg(diff.secondsSaved, 0, 'f', 1);
+        }
+    } else {
+        msg = err;
+    }
+    emit finished(ok, msg);
+}
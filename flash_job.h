@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QPair>
+
+#include <atomic>
+
+#include "stm32_bootloader.h"
+
+class QThread;
+class FlashPageCache;
+
+// 原生 UART 烧录任务：工作线程里打开串口（8E1），按 AUTO 序列进入 Boot，
+// 同步 / Get / GetID，按页擦除、256 字节块写入（回读校验滞后两页交错进行，首个不符即停）、Go。
+// 差分模式下按页哈希缓存只擦写内容变化的页。镜像有落在页表之外的部分（未知型号、选项字节 / OTP 段）时报错，
+// 只有 Config::allowMassErase 才改为整片擦除。
+// 进度（阶段、字节、KB/s）与芯片信息由 GUI 定时拉取。
+class FlashJob final : public QObject {
+    Q_OBJECT
+public:
+    struct Segment {
+        quint32 address = 0;
+        QByteArray data;
+    };
+
+    enum class Phase { Idle, Connecting, Comparing, Erasing, Writing, Verifying, Starting, Done };
+
+    struct Config {
+        QString portPath;
+        qint32 baud = 115200;
+        QString gpioSeq;             // "entry[:exit]", stm32flash -i syntax; empty = manual BOOT0
+        QVector<Segment> segments;
+        bool verify = true;
+        bool verifyWrittenOnly = true;   // false: also read back unchanged (skipped) pages
+        bool differential = false;   // skip pages whose cached hash matches the new content
+        bool diffReadBack = false;   // ...only after reading the page back and comparing
+        bool go = true;
+        quint32 goAddress = 0x08000000;
+        bool allowMassErase = false; // no page geometry for part of the image: mass erase instead of failing
+    };
+
+    struct Progress {
+        Phase phase = Phase::Idle;
+        qint64 done = 0;             // bytes of the current phase
+        qint64 total = 0;
+        double kbps = 0.0;           // KiB/s of the current phase
+        qint64 verified = 0;         // read back so far; runs behind the writes
+        qint64 verifyTotal = 0;
+    };
+
+    struct DiffStats {
+        int pagesTotal = 0;          // erase units the image touches
+        int pagesChanged = 0;        // erased and written
+        qint64 bytesImage = 0;
+        qint64 bytesWritten = 0;
+        double secondsSaved = 0.0;   // estimate from the measured write+verify rate
+    };
+
+    explicit FlashJob(QObject *parent = nullptr);
+    ~FlashJob() override;
+
+    bool start(const Config &cfg, QString *err = nullptr);
+    void cancel();
+    bool isRunning() const { return m_thread != nullptr; }
+    void wait();                     // join after finished()
+
+    Progress progress() const;
+    Stm32Bootloader::ChipInfo chipInfo() const;
+    DiffStats diffStats() const;
+
+    static QString phaseName(Phase p);
+
+signals:
+    void message(const QString &text);
+    void finished(bool ok, const QString &msg);
+
+private:
+    void run();
+    bool connectTarget(QSerialPort &port, Stm32Bootloader &bl, QString *err);
+    bool planPages(Stm32Bootloader &bl, FlashPageCache *cache, QString *err);
+    bool erasePlanned(Stm32Bootloader &bl, QString *err);
+    bool writeAndVerify(Stm32Bootloader &bl, QString *err);
+    bool writeUnit(Stm32Bootloader &bl, int unit, QString *err);
+    bool verifyUnit(Stm32Bootloader &bl, int unit, QString *err);
+    void updateCache(FlashPageCache *cache, bool ok);
+
+    void setPhase(Phase p, qint64 total);
+    void addDone(qint64 bytes);
+    void addVerified(qint64 bytes);
+
+    Config m_cfg;
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_cancel{false};
+
+    mutable QMutex m_mutex;
+    Progress m_progress;
+    qint64 m_phaseStartNs = 0;
+    Stm32Bootloader::ChipInfo m_chip;
+    DiffStats m_diff;
+
+    // plan for this run (worker thread only): one unit per erase page the image touches
+    struct Unit {
+        quint32 start = 0;
+        QVector<Segment> pieces;             // image bytes inside this page
+        qint64 bytes = 0;
+        bool write = true;                   // changed (or no cache): erase + write
+    };
+    QVector<Unit> m_units;
+    QVector<int> m_erasePages;
+    QVector<quint32> m_changedStarts;
+    QVector<QPair<quint32, QByteArray>> m_pageHashes;   // every touched page: start, new hash
+    bool m_massErase = false;
+    bool m_eraseStarted = false;
+};
@@ -0,0 +1,78 @@
+#include "flash_page_cache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QList>
+
+#include <algorithm>
+
+QString FlashPageCache::deviceKey(const Stm32Bootloader::ChipInfo &chip, const QString &portPath) {
+    const QString pid = QString("%1").arg(chip.pid, 4, 16, QLatin1Char('0'));
+    if (!chip.uid.isEmpty()) return pid + "-" + QString::fromLatin1(chip.uid.toHex());
+
+    // no UID: the fixture port is the best identity we have
+    QString port = portPath;
+    port.replace(QRegularExpression("[^A-Za-z0-9._-]"), "_");
+    return pid + "-port-" + port;
+}
+
+QByteArray FlashPageCache::hashPage(const QByteArray &content) {
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+FlashPageCache::FlashPageCache(const QString &deviceKey)
+    : m_key(deviceKey) {
+}
+
+QString FlashPageCache::filePath() const {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/flash_cache";
+    return dir + "/" + m_key + ".txt";
+}
+
+bool FlashPageCache::load() {
+    m_pages.clear();
+    QFile f(filePath());
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+    // one page per line: "<start hex> <sha1 hex>"
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine().trimmed();
+        const int sp = line.indexOf(' ');
+        if (sp <= 0) continue;
+        bool ok = false;
+        const quint32 start = line.left(sp).toUInt(&ok, 16);
+        const QByteArray hash = QByteArray::fromHex(line.mid(sp + 1));
+        if (ok && !hash.isEmpty()) m_pages.insert(start, hash);
+    }
+    return true;
+}
+
+bool FlashPageCache::save(QString *err) const {
+    const QString path = filePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QList<quint32> keys = m_pages.keys();
+    std::sort(keys.begin(), keys.end());
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (err) *err = QString("cannot write %1: %2").arg(path, f.errorString());
+        return false;
+    }
+    for (quint32 start : keys) {
+        f.write(QByteArray::number(start, 16).rightJustified(8, '0'));
+        f.write(" ");
+        f.write(m_pages.value(start).toHex());
+        f.write("\n");
+    }
+    if (!f.commit()) {
+        if (err) *err = QString("cannot write %1: %2").arg(path, f.errorString());
+        return false;
+    }
+    return true;
+}
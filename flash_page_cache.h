@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "stm32_bootloader.h"
+
+// 差分烧录用的页哈希缓存：每个芯片（PID + UID，读不到 UID 时退化为 PID + 端口）一个文件，
+// 记录上次写入后每个擦除页的内容哈希（页内未覆盖部分按 0xFF 计）。
+class FlashPageCache final {
+public:
+    static QString deviceKey(const Stm32Bootloader::ChipInfo &chip, const QString &portPath);
+    static QByteArray hashPage(const QByteArray &content);
+
+    explicit FlashPageCache(const QString &deviceKey);
+
+    bool load();                     // false if there is no cache yet (not an error)
+    bool save(QString *err) const;
+    void clear() { m_pages.clear(); }
+
+    QByteArray pageHash(quint32 pageStart) const { return m_pages.value(pageStart); }
+    void setPageHash(quint32 pageStart, const QByteArray &hash) { m_pages.insert(pageStart, hash); }
+    void removePage(quint32 pageStart) { m_pages.remove(pageStart); }
+
+private:
+    QString filePath() const;
+
+    QString m_key;
+    QHash<quint32, QByteArray> m_pages;
+};
@@ -0,0 +1,30 @@
+#include "frame_pacer.h"
+
+#include <cmath>
+
+void FramePacer::reset() {
+    m_costMs = 0.0;
+    m_intervalMs = m_cfg.minIntervalMs;
+    m_points = m_cfg.maxPoints;
+}
+
+void FramePacer::frameDone(qint64 costNs) {
+    const double ms = double(costNs) / 1e6;
+    m_costMs = (m_costMs <= 0.0) ? ms : m_costMs * 0.8 + ms * 0.2;
+
+    // the cost per frame that still fits the budget at the top frame rate
+    const double target = m_cfg.minIntervalMs * m_cfg.cpuShare;
+    // the interval that keeps the current cost within the budget
+    const int need = qBound(m_cfg.minIntervalMs, int(std::ceil(m_costMs / m_cfg.cpuShare)), m_cfg.maxIntervalMs);
+
+    if (m_costMs > target) {
+        // detail goes first; the frame rate only once the point budget is at its floor
+        if (m_points > m_cfg.minPoints) m_points = qMax(m_cfg.minPoints, m_points * 3 / 4);
+        else m_intervalMs = need;
+    } else if (m_intervalMs > m_cfg.minIntervalMs) {
+        // recovering: the frame rate comes back before any detail
+        m_intervalMs = need;
+    } else if (m_costMs < target * 0.5) {
+        m_points = qMin(m_cfg.maxPoints, m_points * 5 / 4 + 1);
+    }
+}
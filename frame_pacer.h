@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QtGlobal>
+
+// 绘图帧调度：对每帧实际耗时做指数平均，按 CPU 预算调整帧间隔与每条曲线的绘制点数（抽稀级别）。
+// 先减点数保住帧率；点数到下限仍超预算时拉长帧间隔。耗时回落后按相反顺序恢复。
+// 预算以占墙钟时间的比例给出：cpuShare = 0.25 即绘图最多占用一个核心的 1/4，其余留给采集。
+class FramePacer final {
+public:
+    struct Config {
+        int minIntervalMs = 33;      // ~30 FPS ceiling
+        int maxIntervalMs = 500;
+        double cpuShare = 0.25;
+        int minPoints = 512;         // per curve
+        int maxPoints = 8192;
+    };
+
+    FramePacer() { reset(); }
+
+    const Config &config() const { return m_cfg; }
+
+    // back to full rate / full detail, forgetting the cost history (the plot tab is shown again)
+    void reset();
+    // measured cost of one rendered frame
+    void frameDone(qint64 costNs);
+
+    int intervalMs() const { return m_intervalMs; }
+    int pointBudget() const { return m_points; }
+    double costMs() const { return m_costMs; }
+
+private:
+    Config m_cfg;
+    double m_costMs = 0.0;       // smoothed
+    int m_intervalMs = 33;
+    int m_points = 8192;
+};
@@ -0,0 +1,107 @@
+#include "hex_dump.h"
+
+#include <cstring>
+
+namespace {
+// "000102...FEFF": two upper-case hex digits per byte value
+struct HexTable {
+    char pairs[512];
+    constexpr HexTable() : pairs() {
+        const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            pairs[i * 2]     = digits[i >> 4];
+            pairs[i * 2 + 1] = digits[i & 0x0F];
+        }
+    }
+};
+constexpr HexTable kHex;
+
+inline void putHex(char *dst, unsigned char b) {
+    dst[0] = kHex.pairs[b * 2];
+    dst[1] = kHex.pairs[b * 2 + 1];
+}
+
+inline char asciiCell(unsigned char b) {
+    return (b >= 0x20 && b < 0x7F) ? char(b) : '.';
+}
+
+inline void putOffset(char *dst, quint64 off) {
+    // 8 hex digits; wider streams simply wrap the column
+    for (int i = 3; i >= 0; --i) {
+        putHex(dst + i * 2, static_cast<unsigned char>(off & 0xFF));
+        off >>= 8;
+    }
+}
+}
+
+HexDumpFormatter::HexDumpFormatter(int bytesPerRow) {
+    setBytesPerRow(bytesPerRow);
+}
+
+void HexDumpFormatter::setBytesPerRow(int n) {
+    n = qBound(8, n, 64);
+    m_bytesPerRow = (n / 8) * 8;
+}
+
+int HexDumpFormatter::rowLength() const {
+    const int n = m_bytesPerRow;
+    // offset + 2 spaces + "hh " * n + extra gap per 8-byte group + " |" + ascii + "|"
+    return 8 + 2 + n * 3 + (n / 8 - 1) + 2 + n + 1;
+}
+
+QString HexDumpFormatter::format(const QByteArray &bytes, quint64 streamOffset) {
+    if (bytes.isEmpty()) return {};
+
+    const int n = m_bytesPerRow;
+    const int rowLen = rowLength();
+    const int hexCol = 10;                            // after "OOOOOOOO  "
+    const int asciiCol = hexCol + n * 3 + (n / 8 - 1) + 1;
+
+    const quint64 firstRow = streamOffset - (streamOffset % quint64(n));
+    const quint64 endOff = streamOffset + quint64(bytes.size());
+    const int rows = int((endOff - firstRow + quint64(n) - 1) / quint64(n));
+
+    const int total = rows * (rowLen + 1) - 1;
+    if (m_buf.size() < total + 1) m_buf.resize(total + 1);
+    char *out = m_buf.data();
+
+    const auto *src = reinterpret_cast<const unsigned char *>(bytes.constData());
+    quint64 rowOff = firstRow;
+    for (int r = 0; r < rows; ++r, rowOff += quint64(n)) {
+        char *row = out + r * (rowLen + 1);
+        std::memset(row, ' ', size_t(rowLen));
+
+        putOffset(row, rowOff);
+        row[asciiCol] = '|';
+        row[rowLen - 1] = '|';
+
+        // valid byte range of this row within the chunk
+        const int first = (rowOff < streamOffset) ? int(streamOffset - rowOff) : 0;
+        const int last = (rowOff + quint64(n) > endOff) ? int(endOff - rowOff) : n;
+        const unsigned char *p = src + (rowOff + quint64(first) - streamOffset);
+
+        for (int i = first; i < last; ++i, ++p) {
+            putHex(row + hexCol + i * 3 + i / 8, *p);
+            row[asciiCol + 1 + i] = asciiCell(*p);
+        }
+
+        if (r != rows - 1) row[rowLen] = '\n';
+    }
+
+    return QString::fromLatin1(out, total);
+}
+
+void HexDumpFormatter::encodeSpaced(const char *data, int len, QByteArray *out) {
+    if (!out || len <= 0) return;
+
+    const int base = out->size();
+    out->resize(base + len * 3 - 1);
+    char *dst = out->data() + base;
+
+    const auto *src = reinterpret_cast<const unsigned char *>(data);
+    for (int i = 0; i < len; ++i) {
+        putHex(dst, src[i]);
+        dst += 2;
+        if (i != len - 1) *dst++ = ' ';
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// HEX dump rendering for the terminal (and anything else that wants hex text).
+//
+//   00001000  48 65 6C 6C 6F 2C 20 77  6F 72 6C 64 0D 0A 00 FF  |Hello, world....|
+//
+// Rows are aligned to the running stream offset, so a chunk that starts mid-row
+// is padded on the left and the offset column always shows absolute positions.
+// Encoding is table-driven into a reusable buffer: one QString allocation per chunk.
+class HexDumpFormatter final {
+public:
+    explicit HexDumpFormatter(int bytesPerRow = 16);
+
+    // 16 or 32 (anything else is clamped to the nearest multiple of 8 in [8, 64])
+    void setBytesPerRow(int n);
+    int bytesPerRow() const { return m_bytesPerRow; }
+
+    // rows separated by '\n', no trailing newline
+    QString format(const QByteArray &bytes, quint64 streamOffset);
+
+    // compact "AA BB CC" form (TX echo, logs); appends to *out
+    static void encodeSpaced(const char *data, int len, QByteArray *out);
+
+private:
+    int rowLength() const;
+
+    int m_bytesPerRow = 16;
+    QByteArray m_buf;      // reused between calls
+};
@@ -0,0 +1,620 @@
+#include "history_search.h"
+
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+namespace {
+constexpr int kBlockBytes = 1 << 20;                 // 1 MiB blocks
+constexpr int kSplitSearchWindow = 64 * 1024;        // prefer splitting blocks at a newline within this tail
+constexpr quint64 kMaxLiveBytes = 256ULL << 20;      // in-memory session history cap
+constexpr int kBloomBitsLog2 = 17;                   // 128 Kbit (16 KiB) per 1 MiB block
+constexpr int kBloomWords = (1 << kBloomBitsLog2) / 64;
+constexpr int kMaxLineText = 300;
+constexpr int kRegexOverlap = 4096;                  // a regex match may run this far into the next block
+
+struct LowerTable {
+    unsigned char t[256];
+    constexpr LowerTable() : t() {
+        for (int i = 0; i < 256; ++i) t[i] = static_cast<unsigned char>((i >= 'A' && i <= 'Z') ? i + 32 : i);
+    }
+};
+constexpr LowerTable kLower;
+
+inline quint32 trigramSlot(unsigned char a, unsigned char b, unsigned char c) {
+    const quint32 v = quint32(a) | (quint32(b) << 8) | (quint32(c) << 16);
+    return (v * 2654435761u) >> (32 - kBloomBitsLog2);
+}
+
+QByteArray toLowerBytes(const QByteArray &s) {
+    QByteArray r = s;
+    for (char &c : r) c = char(kLower.t[static_cast<unsigned char>(c)]);
+    return r;
+}
+
+// Horspool search; pattern stored lower-cased when case-insensitive.
+struct Horspool {
+    QByteArray pat;
+    bool ci = false;
+    int shift[256];
+
+    Horspool(const QByteArray &p, bool caseInsensitive)
+        : pat(caseInsensitive ? toLowerBytes(p) : p), ci(caseInsensitive) {
+        const int m = int(pat.size());
+        int lowerShift[256];
+        for (int &s : lowerShift) s = m;
+        for (int i = 0; i + 1 < m; ++i) lowerShift[static_cast<unsigned char>(pat[i])] = m - 1 - i;
+        for (int b = 0; b < 256; ++b) shift[b] = ci ? lowerShift[kLower.t[b]] : lowerShift[b];
+    }
+
+    int find(const unsigned char *h, int n, int from) const {
+        const int m = int(pat.size());
+        if (m == 0) return -1;
+        const auto *p = reinterpret_cast<const unsigned char *>(pat.constData());
+        int i = from;
+        while (i + m <= n) {
+            const unsigned char last = h[i + m - 1];
+            if ((ci ? kLower.t[last] : last) == p[m - 1]) {
+                int k = m - 2;
+                if (ci) { while (k >= 0 && kLower.t[h[i + k]] == p[k]) --k; }
+                else    { while (k >= 0 && h[i + k] == p[k]) --k; }
+                if (k < 0) return i;
+            }
+            i += shift[last];
+        }
+        return -1;
+    }
+};
+
+// Longest literal that every regex match must contain (only used to prune blocks).
+QByteArray requiredLiteral(const QString &pattern) {
+    // blocks are matched as Latin-1 text, so the literal must be Latin-1 bytes as well
+    for (QChar ch : pattern)
+        if (ch.unicode() > 0xFF) return {};
+    const QByteArray p = pattern.toLatin1();
+    if (p.contains('|')) return {};
+
+    QByteArray best, cur;
+    auto flush = [&]() {
+        if (cur.size() > best.size()) best = cur;
+        cur.clear();
+    };
+    auto skipQuantifierAfterGroup = [&](int &i) {
+        if (i + 1 >= p.size()) return;
+        const char q = p[i + 1];
+        if (q == '*' || q == '?' || q == '+') { ++i; }
+        else if (q == '{') { while (i + 1 < p.size() && p[i + 1] != '}') ++i; ++i; }
+    };
+
+    int depth = 0;
+    for (int i = 0; i < p.size(); ++i) {
+        const char c = p[i];
+        if (c == '\\') {
+            if (i + 1 >= p.size()) break;
+            const char n = p[++i];
+            if (depth == 0 && std::strchr(".*+?()[]{}|^$\\/-", n)) cur.append(n);
+            else flush();
+            continue;
+        }
+        if (c == '[') {
+            flush();
+            while (i + 1 < p.size() && p[i + 1] != ']') { if (p[i + 1] == '\\') ++i; ++i; }
+            ++i;
+            continue;
+        }
+        if (c == '(') { flush(); ++depth; continue; }
+        if (c == ')') { flush(); if (depth > 0) --depth; skipQuantifierAfterGroup(i); continue; }
+        if (c == '*' || c == '?' || c == '{') {
+            if (!cur.isEmpty()) cur.chop(1);
+            flush();
+            if (c == '{') { while (i + 1 < p.size() && p[i + 1] != '}') ++i; ++i; }
+            continue;
+        }
+        if (c == '+' || c == '.' || c == '^' || c == '$') { flush(); continue; }
+        if (depth == 0) cur.append(c);
+    }
+    flush();
+    return best;
+}
+
+bool parseHexPattern(const QString &text, QByteArray *out) {
+    QString s = text;
+    s.remove(QRegularExpression(R"(0[xX])"));
+    s.remove(QRegularExpression(R"([\s,:;-])"));
+    if (s.isEmpty() || (s.size() % 2) != 0) return false;
+    for (const QChar ch : s) {
+        if (!ch.isDigit() && !(ch.toLower() >= QLatin1Char('a') && ch.toLower() <= QLatin1Char('f'))) return false;
+    }
+    *out = QByteArray::fromHex(s.toLatin1());
+    return !out->isEmpty();
+}
+}
+
+HistoryIndex::HistoryIndex(QObject *parent)
+    : QObject(parent) {
+    qRegisterMetaType<HistoryIndex::Match>();
+    qRegisterMetaType<QVector<HistoryIndex::Match>>();
+    qRegisterMetaType<HistoryIndex::SearchStats>();
+
+    m_sourceNames << "会话";
+    m_nextLine.resize(1);
+
+    m_thread = QThread::create([this]() { workerLoop(); });
+    m_thread->setObjectName("HistoryIndex");
+    m_thread->start(QThread::LowPriority);
+}
+
+HistoryIndex::~HistoryIndex() {
+    {
+        QMutexLocker lk(&m_taskMutex);
+        m_quit = true;
+        m_taskCond.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+
+    // blocks may point into mapped files: drop them before unmapping
+    m_blocks.clear();
+    for (auto &f : m_files) {
+        delete f.file;
+        delete f.temp;
+    }
+}
+
+QStringList HistoryIndex::sourceNames() const {
+    QMutexLocker lk(&m_blocksMutex);
+    return m_sourceNames;
+}
+
+void HistoryIndex::post(std::function<void()> task, bool urgent) {
+    QMutexLocker lk(&m_taskMutex);
+    if (urgent) m_tasks.push_front(std::move(task));
+    else m_tasks.push_back(std::move(task));
+    m_taskCond.wakeOne();
+}
+
+void HistoryIndex::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            QMutexLocker lk(&m_taskMutex);
+            while (m_tasks.empty() && !m_quit) m_taskCond.wait(&m_taskMutex);
+            if (m_quit) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+/* ---------------------------
+ *  live session (GUI thread)
+ * --------------------------- */
+
+void HistoryIndex::appendLive(const QByteArray &bytes, qint64 tsNs) {
+    if (bytes.isEmpty()) return;
+
+    if (!m_liveActive) {
+        m_liveActive = BlockPtr::create();
+        m_liveActive->source = 0;
+        m_liveActive->startOffset = m_liveOffset;
+        m_liveActive->owned.reserve(kBlockBytes + kSplitSearchWindow);
+    }
+    m_liveActive->stamps.push_back({quint32(m_liveActive->owned.size()), tsNs});
+    m_liveActive->owned.append(bytes);
+    m_liveOffset += quint64(bytes.size());
+    m_totalBytes += quint64(bytes.size());
+
+    if (m_liveActive->owned.size() >= kBlockBytes) sealLiveBlock();
+}
+
+void HistoryIndex::sealLiveBlock() {
+    BlockPtr b = m_liveActive;
+    m_liveActive.reset();
+    if (!b || b->owned.isEmpty()) return;
+
+    // keep lines whole when possible: split after the last '\n' in the tail window
+    const int n = int(b->owned.size());
+    int cut = n;
+    const int floor = qMax(0, n - kSplitSearchWindow);
+    for (int i = n - 1; i >= floor; --i) {
+        if (b->owned[i] == '\n') { cut = i + 1; break; }
+    }
+
+    if (cut < n) {
+        BlockPtr rest = BlockPtr::create();
+        rest->source = 0;
+        rest->startOffset = b->startOffset + quint64(cut);
+        rest->owned = b->owned.mid(cut);
+        rest->owned.reserve(kBlockBytes + kSplitSearchWindow);
+
+        // carry the stamp of the chunk that straddles the cut
+        QVector<QPair<quint32, qint64>> keep;
+        for (const auto &st : b->stamps) {
+            if (st.first < quint32(cut)) keep.push_back(st);
+            else rest->stamps.push_back({st.first - quint32(cut), st.second});
+        }
+        if (rest->stamps.isEmpty() || rest->stamps.first().first != 0) {
+            rest->stamps.prepend({0, keep.isEmpty() ? -1 : keep.last().second});
+        }
+        b->stamps = keep;
+        b->owned.truncate(cut);
+        m_liveActive = rest;
+    }
+
+    b->owned.squeeze();
+    b->data = b->owned.constData();
+    b->size = int(b->owned.size());
+
+    QVector<BlockPtr> dropped;
+    {
+        QMutexLocker lk(&m_blocksMutex);
+        m_blocks.push_back(b);
+        m_liveBytesHeld += quint64(b->size);
+
+        // drop the oldest live blocks beyond the cap (searches in flight keep their own refs)
+        while (m_liveBytesHeld > kMaxLiveBytes) {
+            auto it = std::find_if(m_blocks.begin(), m_blocks.end(),
+                                   [](const BlockPtr &x) { return x->source == 0; });
+            if (it == m_blocks.end()) break;
+            m_liveBytesHeld -= quint64((*it)->size);
+            m_totalBytes -= quint64((*it)->size);
+            dropped.push_back(*it);
+            m_blocks.erase(it);
+        }
+    }
+
+    post([this, b]() { indexBlock(*b); });
+    if (!dropped.isEmpty()) post([this, dropped]() { forgetBlocks(dropped); });
+}
+
+void HistoryIndex::forgetBlocks(const QVector<BlockPtr> &blocks) {
+    // worker: runs after the blocks' own index tasks (FIFO), so `indexed` is settled
+    for (const BlockPtr &b : blocks) {
+        if (b->indexed) m_indexedBytes -= quint64(b->size);
+    }
+    emit indexProgress(m_indexedBytes.load(), m_totalBytes.load());
+}
+
+void HistoryIndex::clearLive() {
+    QVector<BlockPtr> dropped;
+    {
+        QMutexLocker lk(&m_blocksMutex);
+        const auto live = std::stable_partition(m_blocks.begin(), m_blocks.end(),
+                                                [](const BlockPtr &x) { return x->source != 0; });
+        for (auto it = live; it != m_blocks.end(); ++it) dropped.push_back(*it);
+        m_blocks.erase(live, m_blocks.end());
+        m_totalBytes -= m_liveBytesHeld;
+        m_liveBytesHeld = 0;
+    }
+    if (m_liveActive) m_totalBytes -= quint64(m_liveActive->owned.size());
+    m_liveActive.reset();
+    m_liveOffset = 0;
+
+    // FIFO after any pending index tasks of the dropped blocks
+    post([this, dropped]() {
+        m_nextLine[0] = 0;
+        forgetBlocks(dropped);
+    });
+}
+
+/* ---------------------------
+ *  files
+ * --------------------------- */
+
+void HistoryIndex::addFile(const QString &path) {
+    int source = 0;
+    {
+        QMutexLocker lk(&m_blocksMutex);
+        source = int(m_sourceNames.size());
+        m_sourceNames << QFileInfo(path).fileName();
+    }
+    post([this, source, path]() { doAddFile(source, path); });
+}
+
+void HistoryIndex::doAddFile(int source, const QString &path) {
+    FileSource fs;
+    fs.path = path;
+
+    if (path.endsWith(".gz", Qt::CaseInsensitive)) {
+        // decompress once to a temp file so the rest of the pipeline is plain mmap
+        gzFile gz = gzopen(QFile::encodeName(path).constData(), "rb");
+        if (!gz) {
+            emit fileAdded(source, path, "cannot open gzip file");
+            return;
+        }
+        fs.temp = new QTemporaryFile();
+        if (!fs.temp->open()) {
+            gzclose(gz);
+            delete fs.temp;
+            emit fileAdded(source, path, "cannot create temp file");
+            return;
+        }
+        QByteArray buf(256 * 1024, Qt::Uninitialized);
+        int n = 0;
+        while ((n = gzread(gz, buf.data(), unsigned(buf.size()))) > 0) fs.temp->write(buf.constData(), n);
+        gzclose(gz);
+        fs.temp->flush();
+        fs.file = new QFile(fs.temp->fileName());
+    } else {
+        fs.file = new QFile(path);
+    }
+
+    if (!fs.file->open(QIODevice::ReadOnly)) {
+        const QString err = fs.file->errorString();
+        delete fs.file;
+        delete fs.temp;
+        emit fileAdded(source, path, err);
+        return;
+    }
+    const qint64 size = fs.file->size();
+    const uchar *base = size > 0 ? fs.file->map(0, size) : nullptr;
+    if (size > 0 && !base) {
+        delete fs.file;
+        delete fs.temp;
+        emit fileAdded(source, path, "mmap failed");
+        return;
+    }
+    m_files.push_back(fs);
+    if (m_nextLine.size() <= source) m_nextLine.resize(source + 1);
+    m_totalBytes += quint64(size);
+
+    // carve into ~1 MiB blocks split at line boundaries
+    QVector<BlockPtr> fresh;
+    const char *p = reinterpret_cast<const char *>(base);
+    qint64 off = 0;
+    while (off < size) {
+        qint64 end = qMin(size, off + kBlockBytes);
+        if (end < size) {
+            const qint64 floor = qMax(off + 1, end - kSplitSearchWindow);
+            for (qint64 i = end - 1; i >= floor; --i) {
+                if (p[i] == '\n') { end = i + 1; break; }
+            }
+        }
+        BlockPtr b = BlockPtr::create();
+        b->source = source;
+        b->startOffset = quint64(off);
+        b->data = p + off;
+        b->size = int(end - off);
+        fresh.push_back(b);
+        off = end;
+    }
+
+    {
+        QMutexLocker lk(&m_blocksMutex);
+        m_blocks += fresh;
+    }
+    emit fileAdded(source, path, QString());
+
+    // one task per block so searches can jump the queue while a big file indexes
+    for (const BlockPtr &b : fresh) post([this, b]() { indexBlock(*b); });
+}
+
+/* ---------------------------
+ *  indexing (worker)
+ * --------------------------- */
+
+void HistoryIndex::indexBlock(Block &b) {
+    const auto *p = reinterpret_cast<const unsigned char *>(b.data);
+
+    b.bloom.assign(kBloomWords, 0);
+    for (int i = 0; i + 2 < b.size; ++i) {
+        const quint32 slot = trigramSlot(kLower.t[p[i]], kLower.t[p[i + 1]], kLower.t[p[i + 2]]);
+        b.bloom[slot >> 6] |= (1ULL << (slot & 63));
+    }
+
+    b.newlines.clear();
+    const char *q = b.data;
+    const char *end = b.data + b.size;
+    while (q < end) {
+        const void *nl = std::memchr(q, '\n', size_t(end - q));
+        if (!nl) break;
+        const char *c = static_cast<const char *>(nl);
+        b.newlines.push_back(quint32(c - b.data));
+        q = c + 1;
+    }
+
+    if (m_nextLine.size() <= b.source) m_nextLine.resize(b.source + 1);
+    b.firstLine = m_nextLine[b.source];
+    m_nextLine[b.source] += b.newlines.size();
+    b.indexed = true;
+
+    m_indexedBytes += quint64(b.size);
+    emit indexProgress(m_indexedBytes.load(), m_totalBytes.load());
+}
+
+/* ---------------------------
+ *  search
+ * --------------------------- */
+
+void HistoryIndex::search(const Query &q) {
+    QVector<BlockPtr> blocks;
+    {
+        QMutexLocker lk(&m_blocksMutex);
+        blocks = m_blocks;
+    }
+    // the still-growing live block: snapshot (implicitly shared, the GUI side detaches on append)
+    if (m_liveActive && !m_liveActive->owned.isEmpty()) {
+        BlockPtr tmp = BlockPtr::create();
+        tmp->source = 0;
+        tmp->startOffset = m_liveActive->startOffset;
+        tmp->owned = m_liveActive->owned;
+        tmp->data = tmp->owned.constData();
+        tmp->size = int(tmp->owned.size());
+        tmp->stamps = m_liveActive->stamps;
+        blocks.push_back(tmp);
+    }
+    post([this, q, blocks]() { doSearch(q, blocks); }, /*urgent=*/true);
+}
+
+static bool bloomMayContain(const std::vector<quint64> &bloom, const QByteArray &lowerNeedle) {
+    const auto *p = reinterpret_cast<const unsigned char *>(lowerNeedle.constData());
+    for (int i = 0; i + 2 < lowerNeedle.size(); ++i) {
+        const quint32 slot = trigramSlot(p[i], p[i + 1], p[i + 2]);
+        if (!(bloom[slot >> 6] & (1ULL << (slot & 63)))) return false;
+    }
+    return true;
+}
+
+void HistoryIndex::doSearch(const Query &q, QVector<BlockPtr> blocks) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<Match> matches;
+    SearchStats stats;
+    stats.totalBlocks = int(blocks.size());
+
+    // build needle / regex
+    QByteArray needle;
+    QRegularExpression re;
+    bool ci = q.caseInsensitive;
+    if (q.kind == QueryKind::Literal) {
+        // same byte mapping as the regex path and the terminal view: one char = one byte
+        for (QChar ch : q.text)
+            if (ch.unicode() > 0xFF) { stats.error = "文本含 Latin-1 以外的字符，无法与原始字节匹配"; break; }
+        needle = q.text.toLatin1();
+    } else if (q.kind == QueryKind::Hex) {
+        if (!parseHexPattern(q.text, &needle)) stats.error = "HEX 格式无效（例：DE AD BE EF）";
+        ci = false;
+    } else {
+        QRegularExpression::PatternOptions opts = QRegularExpression::MultilineOption;
+        if (ci) opts |= QRegularExpression::CaseInsensitiveOption;
+        re = QRegularExpression(q.text, opts);
+        if (!re.isValid()) stats.error = re.errorString();
+        else needle = requiredLiteral(q.text);   // prefilter only
+    }
+    if (q.kind != QueryKind::Regex && needle.isEmpty() && stats.error.isEmpty()) stats.error = "查询为空";
+    if (!stats.error.isEmpty()) {
+        emit searchFinished(matches, stats);
+        return;
+    }
+
+    const QByteArray lowerNeedle = toLowerBytes(needle);
+    const bool canPrune = lowerNeedle.size() >= 3;
+
+    auto makeMatch = [&](const Block &b, int off, int len) {
+        Match m;
+        m.source = b.source;
+        m.offset = b.startOffset + quint64(off);
+
+        int lineStart = 0, lineEnd = b.size;
+        if (b.indexed) {
+            const auto it = std::lower_bound(b.newlines.begin(), b.newlines.end(), quint32(off));
+            const int idx = int(it - b.newlines.begin());
+            m.line = b.firstLine + idx;
+            if (idx > 0) lineStart = int(b.newlines[idx - 1]) + 1;
+            if (idx < b.newlines.size()) lineEnd = int(b.newlines[idx]);
+        } else {
+            for (int i = off - 1; i >= 0; --i) if (b.data[i] == '\n') { lineStart = i + 1; break; }
+            const void *nl = std::memchr(b.data + off, '\n', size_t(b.size - off));
+            if (nl) lineEnd = int(static_cast<const char *>(nl) - b.data);
+        }
+        if (lineEnd > lineStart && b.data[lineEnd - 1] == '\r') --lineEnd;
+
+        // window around the match for very long lines
+        int textStart = lineStart;
+        if (off - lineStart > kMaxLineText / 2) textStart = off - kMaxLineText / 3;
+        const int textLen = qMin(lineEnd - textStart, kMaxLineText);
+        m.lineText = QString::fromLatin1(b.data + textStart, qMax(0, textLen));
+        m.column = off - textStart;
+        m.length = len;
+
+        if (!b.stamps.isEmpty()) {
+            const auto it = std::upper_bound(b.stamps.begin(), b.stamps.end(), quint32(off),
+                                             [](quint32 v, const QPair<quint32, qint64> &st) { return v < st.first; });
+            if (it != b.stamps.begin()) m.tsNs = (it - 1)->second;
+        }
+        matches.push_back(m);
+        if (matches.size() >= q.maxResults) stats.truncated = true;
+    };
+
+    if (q.kind == QueryKind::Regex) {
+        // matches that start in a block may run up to kRegexOverlap bytes into the next
+        // contiguous block of the same source; a match already reported that way is not
+        // reported again (as a suffix) from the next block
+        const Horspool literal(needle, ci);
+        int coveredSource = -1;
+        quint64 coveredEnd = 0;
+        for (int bi = 0; bi < blocks.size() && !stats.truncated; ++bi) {
+            const Block &b = *blocks[bi];
+            const Block *next = (bi + 1 < blocks.size()) ? blocks[bi + 1].data() : nullptr;
+            const bool joined = next && next->source == b.source &&
+                                next->startOffset == b.startOffset + quint64(b.size);
+            bool skip = b.indexed && canPrune && !bloomMayContain(b.bloom, lowerNeedle);
+            if (skip && joined) {
+                // the required literal may sit across the boundary or inside the overlap
+                const int tail = qMin(int(needle.size()) - 1, b.size);
+                QByteArray junction(b.data + b.size - tail, tail);
+                junction.append(next->data, qMin(kRegexOverlap, next->size));
+                skip = literal.find(reinterpret_cast<const unsigned char *>(junction.constData()),
+                                    int(junction.size()), 0) < 0;
+            }
+            if (skip) continue;
+            ++stats.candidateBlocks;
+
+            // Latin-1: QString index == byte offset
+            QString text = QString::fromLatin1(b.data, b.size);
+            if (joined) text += QString::fromLatin1(next->data, qMin(kRegexOverlap, next->size));
+            auto it = re.globalMatch(text);
+            while (it.hasNext() && !stats.truncated) {
+                const auto mt = it.next();
+                const int start = int(mt.capturedStart(0));
+                if (start >= b.size) break;              // the next block reports it
+                if (mt.capturedLength(0) == 0) continue;
+                if (b.source == coveredSource && b.startOffset + quint64(start) < coveredEnd) continue;
+                makeMatch(b, start, int(mt.capturedLength(0)));
+                coveredSource = b.source;
+                coveredEnd = b.startOffset + quint64(start + mt.capturedLength(0));
+            }
+        }
+    } else {
+        const Horspool hs(needle, ci);
+        const int m = int(needle.size());
+
+        for (int bi = 0; bi < blocks.size() && !stats.truncated; ++bi) {
+            const Block &b = *blocks[bi];
+            const bool candidate = !(b.indexed && canPrune && !bloomMayContain(b.bloom, lowerNeedle));
+            if (candidate) {
+                ++stats.candidateBlocks;
+                const auto *h = reinterpret_cast<const unsigned char *>(b.data);
+                int pos = 0;
+                while (!stats.truncated) {
+                    const int hit = hs.find(h, b.size, pos);
+                    if (hit < 0) break;
+                    makeMatch(b, hit, m);
+                    pos = hit + 1;
+                }
+            }
+
+            // matches straddling this block and the next one of the same source
+            if (m > 1 && bi + 1 < blocks.size() && !stats.truncated) {
+                const Block &nb = *blocks[bi + 1];
+                if (nb.source == b.source && nb.startOffset == b.startOffset + quint64(b.size)) {
+                    const int tail = qMin(m - 1, b.size);
+                    const int head = qMin(m - 1, nb.size);
+                    QByteArray junction(b.data + b.size - tail, tail);
+                    junction.append(nb.data, head);
+                    const auto *h = reinterpret_cast<const unsigned char *>(junction.constData());
+                    int pos = 0;
+                    int hit;
+                    while ((hit = hs.find(h, int(junction.size()), pos)) >= 0 && hit < tail) {
+                        makeMatch(b, b.size - tail + hit, m);
+                        pos = hit + 1;
+                    }
+                }
+            }
+        }
+    }
+
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+    emit searchFinished(matches, stats);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QMetaType>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class QThread;
+class QFile;
+class QTemporaryFile;
+
+// 会话历史全文检索。
+//
+// 数据源：
+//   source 0  = 本次会话的原始 RX 字节流（内存，按 1 MiB 分块，超过上限丢弃最旧块）
+//   source 1+ = 用户添加的日志文件（.log 直接 mmap；.log.gz 先解压到临时文件再 mmap）
+//
+// 每个块由后台线程建立增量索引：换行位置（行号/行文本）+ 小写化三元组布隆位图。
+// 查询（文本 / 正则 / HEX 字节序列）也在该线程执行：先用位图剔除不可能命中的块，
+// 再在候选块里做 Boyer-Moore-Horspool 或 QRegularExpression 扫描。
+// 文本 / 正则都按 Latin-1 逐字节解释（与终端显示一致），不做 UTF-8 解码。
+// 跨块的匹配：文本 / HEX 完整覆盖；正则只能跨到下一块的前 4 KiB（更长的跨块匹配会漏掉）。
+class HistoryIndex final : public QObject {
+    Q_OBJECT
+public:
+    enum class QueryKind { Literal, Regex, Hex };
+
+    struct Query {
+        QueryKind kind = QueryKind::Literal;
+        QString text;
+        bool caseInsensitive = false;
+        int maxResults = 10000;
+    };
+
+    struct Match {
+        int source = 0;           // 0 = live session, n = file n
+        quint64 offset = 0;       // byte offset inside the source
+        qint64 line = -1;         // 0-based line number, -1 if the block is not indexed yet
+        qint64 tsNs = -1;         // arrival stamp of the chunk (live session only)
+        QString lineText;         // the matching line (truncated)
+        int column = 0;           // match start inside lineText
+        int length = 0;
+    };
+
+    struct SearchStats {
+        int candidateBlocks = 0;
+        int totalBlocks = 0;
+        qint64 elapsedUs = 0;
+        bool truncated = false;
+        QString error;
+    };
+
+    explicit HistoryIndex(QObject *parent = nullptr);
+    ~HistoryIndex() override;
+
+    // GUI thread
+    void appendLive(const QByteArray &bytes, qint64 tsNs);
+    void clearLive();
+    void addFile(const QString &path);
+    void search(const Query &q);
+
+    QStringList sourceNames() const;
+    quint64 indexedBytes() const { return m_indexedBytes.load(); }
+    quint64 totalBytes() const { return m_totalBytes.load(); }
+
+signals:
+    void searchFinished(const QVector<HistoryIndex::Match> &matches, const HistoryIndex::SearchStats &stats);
+    void indexProgress(quint64 indexedBytes, quint64 totalBytes);
+    void fileAdded(int source, const QString &path, const QString &error);
+
+private:
+    struct Block {
+        int source = 0;
+        quint64 startOffset = 0;          // offset of data[0] inside the source
+        QByteArray owned;                 // live blocks own their bytes
+        const char *data = nullptr;       // owned.constData() or mmap
+        int size = 0;
+
+        QVector<QPair<quint32, qint64>> stamps;   // live: chunk start -> tsNs
+
+        // filled by the worker
+        bool indexed = false;
+        qint64 firstLine = 0;
+        QVector<quint32> newlines;        // offsets of '\n' inside the block
+        std::vector<quint64> bloom;       // trigram bitmap over lower-cased bytes
+    };
+    using BlockPtr = QSharedPointer<Block>;
+
+    struct FileSource {
+        QString path;
+        QFile *file = nullptr;            // mapped file (or the decompressed temp copy)
+        QTemporaryFile *temp = nullptr;
+    };
+
+    // worker
+    void post(std::function<void()> task, bool urgent = false);
+    void workerLoop();
+    void indexBlock(Block &b);
+    void doAddFile(int source, const QString &path);
+    void doSearch(const Query &q, QVector<BlockPtr> blocks);
+
+    void sealLiveBlock();
+    void forgetBlocks(const QVector<BlockPtr> &blocks);   // worker: un-count dropped blocks
+
+    // blocks (list guarded by m_blocksMutex; block contents are only touched by the worker once posted)
+    mutable QMutex m_blocksMutex;
+    QVector<BlockPtr> m_blocks;
+
+    // live session, GUI-thread side
+    BlockPtr m_liveActive;
+    quint64 m_liveOffset = 0;
+    quint64 m_liveBytesHeld = 0;
+
+    // files (worker-owned after registration)
+    QVector<FileSource> m_files;
+    QStringList m_sourceNames;            // guarded by m_blocksMutex
+
+    // per-source running line counters (worker)
+    QVector<qint64> m_nextLine;
+
+    QThread *m_thread = nullptr;
+    QMutex m_taskMutex;
+    QWaitCondition m_taskCond;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_quit = false;
+
+    std::atomic<quint64> m_indexedBytes{0};
+    std::atomic<quint64> m_totalBytes{0};
+};
+
+Q_DECLARE_METATYPE(HistoryIndex::Match)
+Q_DECLARE_METATYPE(HistoryIndex::SearchStats)
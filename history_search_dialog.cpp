@@ -0,0 +1,159 @@
+#include "history_search_dialog.h"
+
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QListWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFileDialog>
+#include <QDir>
+#include <QFont>
+
+HistorySearchDialog::HistorySearchDialog(HistoryIndex *index, QWidget *parent)
+    : QDialog(parent)
+    , m_index(index) {
+
+    setWindowTitle("历史检索");
+    setModal(false);
+    resize(760, 480);
+
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setPlaceholderText("文本 / 正则 / HEX（例：DE AD BE EF）");
+
+    m_kindCombo = new QComboBox(this);
+    m_kindCombo->addItem("文本", int(HistoryIndex::QueryKind::Literal));
+    m_kindCombo->addItem("正则", int(HistoryIndex::QueryKind::Regex));
+    m_kindCombo->addItem("HEX", int(HistoryIndex::QueryKind::Hex));
+    m_kindCombo->setItemData(1, "正则匹配跨越 1 MiB 数据块边界时，最多延伸到下一块的前 4 KiB", Qt::ToolTipRole);
+
+    m_caseCheck = new QCheckBox("忽略大小写", this);
+    m_searchBtn = new QPushButton("搜索", this);
+    m_searchBtn->setDefault(true);
+    m_addFilesBtn = new QPushButton("添加日志文件…", this);
+
+    m_statusLabel = new QLabel(this);
+    m_indexLabel = new QLabel(this);
+
+    m_resultList = new QListWidget(this);
+    m_resultList->setUniformItemSizes(true);
+    QFont mono;
+    mono.setStyleHint(QFont::Monospace);
+#if defined(Q_OS_MAC)
+    mono.setFamily("Menlo");
+#else
+    mono.setFamily("Monospace");
+#endif
+    m_resultList->setFont(mono);
+
+    auto *top = new QHBoxLayout();
+    top->addWidget(m_queryEdit, 1);
+    top->addWidget(m_kindCombo);
+    top->addWidget(m_caseCheck);
+    top->addWidget(m_searchBtn);
+
+    auto *bottom = new QHBoxLayout();
+    bottom->addWidget(m_statusLabel, 1);
+    bottom->addWidget(m_indexLabel);
+    bottom->addWidget(m_addFilesBtn);
+
+    auto *root = new QVBoxLayout(this);
+    root->addLayout(top);
+    root->addWidget(m_resultList, 1);
+    root->addLayout(bottom);
+
+    connect(m_searchBtn, &QPushButton::clicked, this, &HistorySearchDialog::onSearch);
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, &HistorySearchDialog::onSearch);
+    connect(m_addFilesBtn, &QPushButton::clicked, this, &HistorySearchDialog::onAddFiles);
+    connect(m_resultList, &QListWidget::itemActivated, this, &HistorySearchDialog::onResultActivated);
+
+    if (m_index) {
+        connect(m_index, &HistoryIndex::searchFinished, this, &HistorySearchDialog::onSearchFinished);
+        connect(m_index, &HistoryIndex::indexProgress, this, &HistorySearchDialog::onIndexProgress);
+        connect(m_index, &HistoryIndex::fileAdded, this, &HistorySearchDialog::onFileAdded);
+        onIndexProgress(m_index->indexedBytes(), m_index->totalBytes());
+    }
+}
+
+void HistorySearchDialog::focusQuery() {
+    m_queryEdit->setFocus();
+    m_queryEdit->selectAll();
+}
+
+void HistorySearchDialog::onSearch() {
+    if (!m_index) return;
+    const QString text = m_queryEdit->text();
+    if (text.isEmpty()) return;
+
+    HistoryIndex::Query q;
+    q.kind = HistoryIndex::QueryKind(m_kindCombo->currentData().toInt());
+    q.text = text;
+    q.caseInsensitive = m_caseCheck->isChecked();
+
+    m_statusLabel->setText("搜索中…");
+    m_index->search(q);
+}
+
+void HistorySearchDialog::onAddFiles() {
+    if (!m_index) return;
+    const QStringList files = QFileDialog::getOpenFileNames(
+        this, "添加日志文件", QDir::homePath(),
+        "Logs (*.log *.log.gz *.txt);;All Files (*)");
+    for (const QString &f : files) m_index->addFile(f);
+}
+
+void HistorySearchDialog::onSearchFinished(const QVector<HistoryIndex::Match> &matches,
+                                           const HistoryIndex::SearchStats &stats) {
+    if (!stats.error.isEmpty()) {
+        m_statusLabel->setText(QString("错误：%1").arg(stats.error));
+        return;
+    }
+
+    m_matches = matches;
+    const QStringList sources = m_index ? m_index->sourceNames() : QStringList();
+
+    m_resultList->setUpdatesEnabled(false);
+    m_resultList->clear();
+    for (const auto &m : m_matches) {
+        QString text = m.lineText;
+        // keep one row per match
+        for (QChar &ch : text) {
+            if (ch.unicode() < 0x20 || ch.unicode() == 0x7F) ch = QLatin1Char('.');
+        }
+        const QString src = (m.source < sources.size()) ? sources[m.source] : QString::number(m.source);
+        const QString where = (m.line >= 0) ? QString("L%1").arg(m.line + 1)
+                                            : QString("@%1").arg(m.offset);
+        m_resultList->addItem(QString("%1:%2  %3").arg(src, where, text));
+    }
+    m_resultList->setUpdatesEnabled(true);
+
+    m_statusLabel->setText(QString("%1%2 条结果，候选块 %3/%4，用时 %5 ms")
+                               .arg(stats.truncated ? QString("≥") : QString())
+                               .arg(matches.size())
+                               .arg(stats.candidateBlocks)
+                               .arg(stats.totalBlocks)
+                               .arg(double(stats.elapsedUs) / 1000.0, 0, 'f', 1));
+}
+
+void HistorySearchDialog::onIndexProgress(quint64 indexed, quint64 total) {
+    m_indexLabel->setText(QString("已索引 %1 / %2 MB")
+                              .arg(double(indexed) / (1024.0 * 1024.0), 0, 'f', 1)
+                              .arg(double(total) / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+void HistorySearchDialog::onFileAdded(int source, const QString &path, const QString &error) {
+    Q_UNUSED(source);
+    if (!error.isEmpty()) {
+        m_statusLabel->setText(QString("无法添加 %1：%2").arg(QDir::toNativeSeparators(path), error));
+    }
+}
+
+void HistorySearchDialog::onResultActivated(QListWidgetItem *item) {
+    const int row = m_resultList->row(item);
+    if (row < 0 || row >= m_matches.size()) return;
+
+    const auto &m = m_matches[row];
+    emit jumpRequested(m.tsNs, m.lineText, m.lineText.mid(m.column, m.length));
+}
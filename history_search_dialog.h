@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include "history_search.h"
+
+class QLineEdit;
+class QComboBox;
+class QCheckBox;
+class QPushButton;
+class QLabel;
+class QListWidget;
+class QListWidgetItem;
+
+// 历史检索窗口（非模态）：文本 / 正则 / HEX 查询，结果双击跳转到终端。
+class HistorySearchDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit HistorySearchDialog(HistoryIndex *index, QWidget *parent = nullptr);
+
+    void focusQuery();
+
+signals:
+    // tsNs: arrival stamp (live session) or -1; lineText lets the terminal fall back to the logged timestamp
+    void jumpRequested(qint64 tsNs, const QString &lineText, const QString &matchText);
+
+private slots:
+    void onSearch();
+    void onAddFiles();
+    void onSearchFinished(const QVector<HistoryIndex::Match> &matches, const HistoryIndex::SearchStats &stats);
+    void onIndexProgress(quint64 indexed, quint64 total);
+    void onFileAdded(int source, const QString &path, const QString &error);
+    void onResultActivated(QListWidgetItem *item);
+
+private:
+    HistoryIndex *m_index = nullptr;
+
+    QLineEdit *m_queryEdit = nullptr;
+    QComboBox *m_kindCombo = nullptr;
+    QCheckBox *m_caseCheck = nullptr;
+    QPushButton *m_searchBtn = nullptr;
+    QPushButton *m_addFilesBtn = nullptr;
+    QLabel *m_statusLabel = nullptr;
+    QLabel *m_indexLabel = nullptr;
+    QListWidget *m_resultList = nullptr;
+
+    QVector<HistoryIndex::Match> m_matches;
+};
@@ -1,12 +1,14 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "aboutdialog.h"
+#include "elf_image.h"
+#include "flash_batch_dialog.h"
+#include "port_registry.h"
 
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
-#include <QtSerialPort/QSerialPortInfo>
 
 #include <QTextCursor>
 #include <QTextCharFormat>
@@ -15,7 +17,7 @@
 #include <QProcessEnvironment>
 
 #include <QThread>
-#include <QRegularExpression>
+#include <QProgressBar>
 #include <QtSerialPort/QSerialPort>
 
 #include <unistd.h>
@@ -77,6 +79,14 @@ MainWindow::MainWindow(QWidget *parent)
     setWindowTitle("STM32 Serial Tool");
     setStatus("就绪");
 
+    // 状态栏进度条（烧录时显示）
+    m_statusProgress = new QProgressBar(this);
+    m_statusProgress->setRange(0, 1000);
+    m_statusProgress->setMaximumWidth(200);
+    m_statusProgress->setTextVisible(true);
+    m_statusProgress->hide();
+    (ui->statusbar ? ui->statusbar : statusBar())->addPermanentWidget(m_statusProgress);
+
     // 串口调试 Tab
     if (ui->tabSerialTerminal) {
         m_serialTerminal = new SerialTerminalWidget(ui->tabSerialTerminal, this);
@@ -91,6 +101,11 @@ MainWindow::MainWindow(QWidget *parent)
     if (ui->tabPlot) {
         m_plotWidget = new PlotWidget(ui->tabPlot, this);
 
+        connect(m_plotWidget, &PlotWidget::statusMessage,
+                this, [this](const QString &msg, int timeoutMs) {
+                    this->setStatus(msg, timeoutMs);
+                });
+
         if (m_serialTerminal) {
             connect(m_serialTerminal, &SerialTerminalWidget::rxLineReceived,
                     m_plotWidget, &PlotWidget::onSerialLineReceived);
@@ -157,8 +172,29 @@ MainWindow::MainWindow(QWidget *parent)
             this,
             &MainWindow::onProcFinished);
 
-    // 初始化串口列表
-    onRefreshPorts();
+    // 内置烧录（工作线程），进度定时拉取
+    connect(&m_flashJob, &FlashJob::message, this, [this](const QString &text) {
+        appendOutputColored(QString("[%1] %2\n").arg(ts(), text), QColor(80, 80, 80));
+    });
+    connect(&m_flashJob, &FlashJob::finished, this, &MainWindow::onFlashJobFinished);
+    m_flashProgressTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_flashProgressTimer, &QTimer::timeout, this, &MainWindow::onFlashProgressTick);
+
+    // 批量烧录：每个端口一个 FlashJob
+    if (ui->pushButtonBatchFlash) {
+        connect(ui->pushButtonBatchFlash, &QPushButton::clicked, this, &MainWindow::onOpenBatchFlash);
+    }
+    connect(&m_flashBatch, &FlashBatch::message, this, [this](const QString &port, const QString &text) {
+        appendOutputColored(QString("[%1] %2: %3\n").arg(ts(), port, text), QColor(80, 80, 80));
+    });
+    connect(&m_flashBatch, &FlashBatch::unitFinished, this, &MainWindow::onBatchUnitFinished);
+    connect(&m_flashBatch, &FlashBatch::finished, this, &MainWindow::onBatchFinished);
+    m_batchProgressTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_batchProgressTimer, &QTimer::timeout, this, &MainWindow::onBatchProgressTick);
+
+    // 串口列表：共享的后台注册表，热插拔自动更新
+    connect(PortRegistry::instance(), &PortRegistry::portsChanged, this, &MainWindow::onPortsChanged);
+    if (PortRegistry::instance()->hasScanned()) onPortsChanged({}, {});
 }
 
 MainWindow::~MainWindow() {
@@ -175,9 +211,15 @@ void MainWindow::setUiEnabled(bool enabled) {
     if (ui->comboBoxBaudRate) ui->comboBoxBaudRate->setEnabled(enabled);
 
     ui->pushButtonFlash->setEnabled(enabled);
+    if (ui->pushButtonBatchFlash) ui->pushButtonBatchFlash->setEnabled(enabled || m_flashBatch.isRunning());
     if (ui->pushButtonClearOutput) ui->pushButtonClearOutput->setEnabled(enabled);
 
     if (ui->checkBoxAutoBootRun) ui->checkBoxAutoBootRun->setEnabled(enabled);
+    if (ui->checkBoxUseStm32flash) ui->checkBoxUseStm32flash->setEnabled(enabled);
+    if (ui->checkBoxDiffFlash) ui->checkBoxDiffFlash->setEnabled(enabled);
+    if (ui->checkBoxDiffReadBack) ui->checkBoxDiffReadBack->setEnabled(enabled);
+    if (ui->checkBoxVerifyWrittenOnly) ui->checkBoxVerifyWrittenOnly->setEnabled(enabled);
+    if (ui->checkBoxAllowMassErase) ui->checkBoxAllowMassErase->setEnabled(enabled);
 }
 
 void MainWindow::setStatus(const QString &msg, int timeoutMs) {
@@ -236,25 +278,17 @@ void MainWindow::onBrowseElf() {
 }
 
 void MainWindow::onRefreshPorts() {
+    // 后台枚举，结果经 portsChanged 回来
+    PortRegistry::instance()->rescan();
+    setStatus("正在刷新串口列表…", 2000);
+}
+
+void MainWindow::onPortsChanged(const QStringList &added, const QStringList &removed) {
     const QString prev = currentSelectedPortPath();
+    const QVector<PortRegistry::Port> &ports = PortRegistry::instance()->ports();
 
     ui->comboBoxSerialPort->clear();
-
-    const auto ports = QSerialPortInfo::availablePorts();
-    for (const auto &p : ports) {
-        const QString sys = p.systemLocation();
-
-        // 只保留 /dev/cu.*，过滤 /dev/tty.*
-        if (!sys.startsWith("/dev/cu.")) continue;
-
-        if (sys.contains("debug-console", Qt::CaseInsensitive)) continue;
-        if (sys.contains("Bluetooth-Incoming-Port", Qt::CaseInsensitive)) continue;
-
-        const QString desc = p.description().isEmpty() ? "No description" : p.description();
-        const QString label = QString("%1  (%2)").arg(sys, desc);
-
-        ui->comboBoxSerialPort->addItem(label, sys);
-    }
+    for (const PortRegistry::Port &p : ports) ui->comboBoxSerialPort->addItem(p.label(), p.path);
 
     // 恢复之前选择
     if (!prev.isEmpty()) {
@@ -266,28 +300,35 @@ void MainWindow::onRefreshPorts() {
         }
     }
 
-    // 优先自动选中 usbserial
+    // 优先自动选中 USB 转串口
     if (ui->comboBoxSerialPort->currentIndex() < 0) {
-        for (int i = 0; i < ui->comboBoxSerialPort->count(); ++i) {
-            const QString path = ui->comboBoxSerialPort->itemData(i).toString();
-            if (path.contains("usbserial", Qt::CaseInsensitive)) {
-                ui->comboBoxSerialPort->setCurrentIndex(i);
-                break;
-            }
-        }
-        if (ui->comboBoxSerialPort->currentIndex() < 0 && ui->comboBoxSerialPort->count() > 0) {
-            ui->comboBoxSerialPort->setCurrentIndex(0);
-        }
+        ui->comboBoxSerialPort->setCurrentIndex(PortRegistry::preferredIndex(ports));
     }
 
-    appendOutputColored(QString("[%1] Ports refreshed: %2 found.\n")
-                            .arg(ts()).arg(ui->comboBoxSerialPort->count()),
-                        QColor(80, 80, 80));
-    setStatus(QString("串口列表已刷新：%1 个").arg(ui->comboBoxSerialPort->count()), 4000);
+    if (m_batchDialog) updateBatchPorts();
+
+    for (const QString &path : added) {
+        appendOutputColored(QString("[%1] Port added: %2\n").arg(ts(), path), QColor(80, 80, 80));
+    }
+    for (const QString &path : removed) {
+        appendOutputColored(QString("[%1] Port removed: %2\n").arg(ts(), path), QColor(80, 80, 80));
+    }
+    setStatus(QString("串口列表已更新：%1 个").arg(ui->comboBoxSerialPort->count()), 4000);
+}
+
+bool MainWindow::anyFlashRunning() const {
+    return m_proc->state() != QProcess::NotRunning || m_flashJob.isRunning() || m_flashBatch.isRunning();
 }
 
 void MainWindow::onFlash() {
-    if (m_proc->state() != QProcess::NotRunning) {
+    // while the built-in flasher runs this button cancels it (like the batch dialog's cancel)
+    if (m_flashJob.isRunning()) {
+        m_flashJob.cancel();
+        ui->pushButtonFlash->setEnabled(false);
+        setStatus("正在取消烧录…");
+        return;
+    }
+    if (anyFlashRunning()) {
         setStatus("已有任务在运行中，请等待完成", 5000);
         return;
     }
@@ -335,15 +376,17 @@ void MainWindow::onFlash() {
         }
     }
 
+    // 只有外部 stm32flash 需要 .bin；内置烧录直接读 ELF 段
+    const bool useStm32flash = ui->checkBoxUseStm32flash && ui->checkBoxUseStm32flash->isChecked();
     const QString binPath = fi.absolutePath() + QDir::separator() + fi.completeBaseName() + ".bin";
 
     m_currentElfPath = elfPath;
-    m_currentBinPath = binPath;
+    m_currentBinPath = useStm32flash ? binPath : QString();
     m_currentPortPath = portPath;
 
     appendOutputColored(QString("\n[%1] Start flashing\n").arg(ts()), QColor(80, 80, 80));
     appendOutputColored(QString("ELF : %1\n").arg(m_currentElfPath), QColor(80, 80, 80));
-    appendOutputColored(QString("BIN : %1\n").arg(m_currentBinPath), QColor(80, 80, 80));
+    if (useStm32flash) appendOutputColored(QString("BIN : %1\n").arg(m_currentBinPath), QColor(80, 80, 80));
     appendOutputColored(QString("PORT: %1\n").arg(m_currentPortPath), QColor(80, 80, 80));
     appendOutputColored(QString("BAUD: %1\n").arg(m_currentBaud), QColor(80, 80, 80));
     appendOutputColored(QString("AUTO: %1\n").arg(m_autoBootRun ? "ON" : "OFF"), QColor(80, 80, 80));
@@ -352,8 +395,12 @@ void MainWindow::onFlash() {
     }
 
     setUiEnabled(false);
-    setStatus("正在生成 BIN（objcopy）…");
-    startObjcopy(m_currentElfPath, m_currentBinPath);
+    if (useStm32flash) {
+        setStatus("正在生成 BIN（objcopy）…");
+        startObjcopy(m_currentElfPath, m_currentBinPath);
+    } else {
+        startFlash(m_currentElfPath, m_currentPortPath);
+    }
 }
 
 void MainWindow::startObjcopy(const QString &elfPath, const QString &binPath) {
@@ -376,13 +423,76 @@ void MainWindow::startObjcopy(const QString &elfPath, const QString &binPath) {
     }
 }
 
-void MainWindow::startFlash(const QString &binPath, const QString &portPath) {
+void MainWindow::startFlash(const QString &elfPath, const QString &portPath) {
+    m_step = Step::Flash;
+
+    FlashJob::Config cfg;
+    ElfImage::Info elf;
+    QString err;
+    if (!ElfImage::load(elfPath, &cfg.segments, &elf, &err)) {
+        appendOutputColored(QString("[%1] ERROR: %2\n").arg(ts(), err), QColor(180, 0, 0));
+        setStatus(QString("读取 ELF 失败：%1").arg(err), 8000);
+        setUiEnabled(true);
+        m_step = Step::None;
+        return;
+    }
+
+    cfg.portPath = portPath;
+    applyFlashOptions(&cfg);
+    cfg.goAddress = elf.lowAddress;
+
+    appendOutputColored(QString("\n[%1] ELF: %2 segment(s), %3 bytes to program (span %4 bytes), entry 0x%5\n")
+                            .arg(ts()).arg(cfg.segments.size()).arg(elf.loadBytes).arg(elf.spanBytes)
+                            .arg(elf.entry, 8, 16, QLatin1Char('0')),
+                        QColor(80, 80, 80));
+    for (const FlashJob::Segment &seg : cfg.segments) {
+        appendOutputColored(QString("  0x%1  %2 bytes\n").arg(seg.address, 8, 16, QLatin1Char('0')).arg(seg.data.size()),
+                            QColor(80, 80, 80));
+    }
+    appendOutputColored(QString("[%1] Flashing (built-in AN3155)%2, verify, go 0x%3\n")
+                            .arg(ts(), cfg.differential ? QString(", differential") : QString())
+                            .arg(cfg.goAddress, 8, 16, QLatin1Char('0')),
+                        QColor(80, 80, 80));
+
+    if (!m_flashJob.start(cfg, &err)) {
+        appendOutputColored(QString("[%1] ERROR: %2\n").arg(ts(), err), QColor(180, 0, 0));
+        setStatus(QString("烧录失败：%1").arg(err), 8000);
+        setUiEnabled(true);
+        m_step = Step::None;
+        return;
+    }
+    setStatus("正在烧录…");
+    ui->pushButtonFlash->setText("取消");
+    ui->pushButtonFlash->setEnabled(true);
+    if (m_statusProgress) {
+        m_statusProgress->setValue(0);
+        m_statusProgress->show();
+    }
+    m_flashProgressTimer.start(200);
+}
+
+void MainWindow::applyFlashOptions(FlashJob::Config *cfg) const {
+    cfg->baud = m_currentBaud;
+    if (m_autoBootRun) cfg->gpioSeq = kAutoGpioSeq;
+    cfg->verify = true;
+    cfg->verifyWrittenOnly = !ui->checkBoxVerifyWrittenOnly || ui->checkBoxVerifyWrittenOnly->isChecked();
+    cfg->differential = ui->checkBoxDiffFlash && ui->checkBoxDiffFlash->isChecked();
+    cfg->diffReadBack = cfg->differential && ui->checkBoxDiffReadBack && ui->checkBoxDiffReadBack->isChecked();
+    cfg->allowMassErase = ui->checkBoxAllowMassErase && ui->checkBoxAllowMassErase->isChecked();
+    cfg->go = true;
+}
+
+void MainWindow::startStm32flash(const QString &binPath, const QString &portPath) {
     m_step = Step::Flash;
 
     m_proc->setProgram("/opt/homebrew/bin/stm32flash");
 
-    // 收集本次 stm32flash 输出
-    m_procAllText.clear();
+    // 逐行解析本次 stm32flash 输出；总字节数用于速率 / 剩余时间
+    m_flasherParser.reset(QFileInfo(binPath).size());
+    if (m_statusProgress) {
+        m_statusProgress->setValue(0);
+        m_statusProgress->show();
+    }
 
     QStringList args;
     args << "-b" << QString::number(m_currentBaud);
@@ -417,20 +527,70 @@ void MainWindow::startFlash(const QString &binPath, const QString &portPath) {
 
 void MainWindow::onProcReadyStdout() {
     const QByteArray data = m_proc->readAllStandardOutput();
-    if (!data.isEmpty()) {
-        const QString s = QString::fromLocal8Bit(data);
-        m_procAllText += s;
-        appendOutputColored(s, QColor(0, 120, 0));   // stdout：绿
+    if (data.isEmpty()) return;
+    if (m_step == Step::Flash) {
+        handleFlasherOutput(data, false);
+        return;
     }
+    appendOutputColored(QString::fromLocal8Bit(data), QColor(0, 120, 0));   // stdout：绿
 }
 
 void MainWindow::onProcReadyStderr() {
     const QByteArray data = m_proc->readAllStandardError();
-    if (!data.isEmpty()) {
-        const QString s = QString::fromLocal8Bit(data);
-        m_procAllText += s;
-        appendOutputColored(s, QColor(180, 0, 0));   // stderr：红
+    if (data.isEmpty()) return;
+    if (m_step == Step::Flash) {
+        handleFlasherOutput(data, true);
+        return;
     }
+    appendOutputColored(QString::fromLocal8Bit(data), QColor(180, 0, 0));   // stderr：红
+}
+
+void MainWindow::handleFlasherOutput(const QByteArray &data, bool fromStderr) {
+    m_flasherEvents.clear();
+    m_flasherParser.feed(data, fromStderr, &m_flasherEvents);
+    handleFlasherEvents();
+}
+
+void MainWindow::handleFlasherEvents() {
+    bool progressed = false;
+    for (const Stm32flashParser::Event &ev : m_flasherEvents) {
+        using Kind = Stm32flashParser::Event::Kind;
+        switch (ev.kind) {
+        case Kind::Progress:
+            // 进度行不进输出区（每 256 字节一行），只刷新状态栏
+            progressed = true;
+            break;
+        case Kind::Error:
+            appendOutputColored(ev.text + "\n", QColor(180, 0, 0));
+            break;
+        case Kind::Erasing:
+            appendOutputColored(ev.text + "\n", QColor(0, 120, 0));
+            setStatus("正在擦除（stm32flash）…");
+            break;
+        case Kind::Done:
+            appendOutputColored(ev.text + "\n", QColor(0, 120, 0));
+            break;
+        case Kind::ChipField:
+        case Kind::Text:
+            appendOutputColored(ev.text + "\n", ev.fromStderr ? QColor(180, 0, 0) : QColor(0, 120, 0));
+            break;
+        }
+    }
+    m_flasherEvents.clear();
+    if (progressed) updateFlasherStatus();
+}
+
+void MainWindow::updateFlasherStatus() {
+    const Stm32flashParser::Progress &p = m_flasherParser.progress();
+    if (m_statusProgress) m_statusProgress->setValue(int(p.percent * 10.0));
+
+    QString text = p.phase == Stm32flashParser::Phase::Reading ? QString("正在读取/校验（stm32flash）")
+                   : p.verifying ? QString("正在写入并校验（stm32flash）")
+                                 : QString("正在写入（stm32flash）");
+    text += QString("… %1%").arg(p.percent, 0, 'f', 1);
+    if (p.bps > 0.0) text += QString("  %1 B/s").arg(qint64(p.bps));
+    if (p.etaSecs >= 0.0) text += QString("  剩余 %1 s").arg(p.etaSecs, 0, 'f', 0);
+    setStatus(text);
 }
 
 void MainWindow::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus) {
@@ -442,7 +602,7 @@ void MainWindow::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus) {
     if (m_step == Step::Objcopy) {
         if (exitStatus == QProcess::NormalExit && exitCode == 0) {
             setStatus("BIN 已生成，准备开始烧录…", 3000);
-            startFlash(m_currentBinPath, m_currentPortPath);
+            startStm32flash(m_currentBinPath, m_currentPortPath);
             return;
         } else {
             appendOutputColored(QString("[%1] ERROR: objcopy failed. Abort.\n").arg(ts()),
@@ -452,8 +612,10 @@ void MainWindow::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus) {
 
     } else if (m_step == Step::Flash) {
 
-        // 不管成功/失败：都输出一次芯片信息（来自 stm32flash 输出）
-        appendChipInfoFromText(m_procAllText);
+        // 补齐没有行尾的最后一行；不管成功/失败：都输出一次芯片信息（解析时已累积）
+        m_flasherParser.finish(&m_flasherEvents);
+        handleFlasherEvents();
+        appendChipInfo(m_flasherParser.chip());
 
         const bool ok = (exitStatus == QProcess::NormalExit && exitCode == 0);
         if (ok) {
@@ -467,10 +629,186 @@ void MainWindow::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus) {
         }
     }
 
+    m_step = Step::None;
+    if (m_statusProgress) m_statusProgress->hide();
+    setUiEnabled(true);
+}
+
+void MainWindow::onFlashProgressTick() {
+    const FlashJob::Progress p = m_flashJob.progress();
+    QString text = QString("正在烧录（%1）").arg(FlashJob::phaseName(p.phase));
+    if (p.total > 0) text += QString("… %1%").arg(int(100 * p.done / p.total));
+    if (m_statusProgress) m_statusProgress->setValue(p.total > 0 ? int(1000 * p.done / p.total) : 0);
+    if (p.kbps > 0.0) text += QString("  %1 KB/s").arg(p.kbps, 0, 'f', 1);
+    if (p.phase == FlashJob::Phase::Writing && p.verifyTotal > 0)
+        text += QString("  已校验 %1%").arg(int(100 * p.verified / p.verifyTotal));
+    setStatus(text);
+}
+
+void MainWindow::onFlashJobFinished(bool ok, const QString &msg) {
+    m_flashJob.wait();
+    m_flashProgressTimer.stop();
+    ui->pushButtonFlash->setText("烧录");
+    if (m_statusProgress) m_statusProgress->hide();
+
+    const Stm32Bootloader::ChipInfo chip = m_flashJob.chipInfo();
+    if (chip.pid != 0) appendChipInfo(chip);
+
+    if (ok) {
+        appendOutputColored(QString("[%1] SUCCESS: flash completed, %2\n").arg(ts(), msg),
+                            QColor(0, 120, 0));
+        setStatus("烧录成功", 6000);
+    } else {
+        appendOutputColored(QString("[%1] ERROR: flash failed: %2\n").arg(ts(), msg),
+                            QColor(180, 0, 0));
+        setStatus(QString("烧录失败：%1").arg(msg), 12000);
+    }
+
     m_step = Step::None;
     setUiEnabled(true);
 }
 
+/* --------------------------- batch flashing --------------------------- */
+
+void MainWindow::updateBatchPorts() {
+    QList<QPair<QString, QString>> ports;
+    for (int i = 0; i < ui->comboBoxSerialPort->count(); ++i) {
+        ports.push_back({ui->comboBoxSerialPort->itemData(i).toString(), ui->comboBoxSerialPort->itemText(i)});
+    }
+    m_batchDialog->setPorts(ports);
+}
+
+void MainWindow::onOpenBatchFlash() {
+    if (!m_batchDialog) {
+        m_batchDialog = new FlashBatchDialog(this);
+        connect(m_batchDialog, &FlashBatchDialog::refreshRequested, this, &MainWindow::onRefreshPorts);
+        connect(m_batchDialog, &FlashBatchDialog::startRequested, this, &MainWindow::onBatchFlashStart);
+        connect(m_batchDialog, &FlashBatchDialog::cancelRequested, &m_flashBatch, &FlashBatch::cancel);
+        updateBatchPorts();
+    }
+    m_batchDialog->show();
+    m_batchDialog->raise();
+    m_batchDialog->activateWindow();
+}
+
+void MainWindow::onBatchFlashStart() {
+    if (!m_batchDialog) return;
+    if (anyFlashRunning()) {
+        m_batchDialog->setStatusText("已有任务在运行中，请等待完成");
+        return;
+    }
+
+    const QString elfPath = ui->lineEditElfPath->text().trimmed();
+    if (elfPath.isEmpty() || !QFileInfo(elfPath).isFile()) {
+        m_batchDialog->setStatusText("请先在主界面选择有效的 ELF 文件");
+        return;
+    }
+    const int baud = currentBaudRate();
+    if (baud <= 0) {
+        m_batchDialog->setStatusText("波特率无效，请输入正确的数字（如 115200）");
+        return;
+    }
+    m_currentBaud = baud;
+    m_autoBootRun = (ui->checkBoxAutoBootRun && ui->checkBoxAutoBootRun->isChecked());
+
+    FlashBatch::Config cfg;
+    ElfImage::Info elf;
+    QString err;
+    // one load for the whole fixture; the jobs share these buffers read-only
+    if (!ElfImage::load(elfPath, &cfg.job.segments, &elf, &err)) {
+        m_batchDialog->setStatusText(QString("读取 ELF 失败：%1").arg(err));
+        return;
+    }
+    applyFlashOptions(&cfg.job);
+    cfg.job.goAddress = elf.lowAddress;
+    cfg.maxRetries = m_batchDialog->maxRetries();
+    for (const QString &port : m_batchDialog->selectedPorts()) {
+        cfg.ports << (m_autoBootRun ? cuToTtyPath(port) : port);
+    }
+    if (cfg.ports.isEmpty()) {
+        m_batchDialog->setStatusText("请至少勾选一个串口");
+        return;
+    }
+
+    if (m_serialTerminal) m_serialTerminal->closeIfOpen();
+
+    appendOutputColored(QString("\n[%1] Batch flashing %2 board(s): %3 bytes from %4, retries %5%6\n")
+                            .arg(ts()).arg(cfg.ports.size()).arg(elf.loadBytes).arg(elfPath)
+                            .arg(cfg.maxRetries)
+                            .arg(cfg.job.differential ? QString(", differential") : QString()),
+                        QColor(80, 80, 80));
+
+    if (!m_flashBatch.start(cfg, &err)) {
+        m_batchDialog->setStatusText(err);
+        return;
+    }
+    setUiEnabled(false);
+    m_batchDialog->setRunning(true);
+    m_batchDialog->setStatusText("烧录中…");
+    onBatchProgressTick();
+    m_batchProgressTimer.start(200);
+}
+
+void MainWindow::onBatchProgressTick() {
+    const FlashBatch::Stats s = m_flashBatch.stats();
+    if (m_batchDialog) {
+        m_batchDialog->setUnits(m_flashBatch.units());
+        m_batchDialog->setStats(s);
+    }
+    if (m_flashBatch.isRunning()) {
+        setStatus(QString("批量烧录：通过 %1 / 失败 %2 / 共 %3").arg(s.passed).arg(s.failed).arg(s.boards));
+    }
+}
+
+void MainWindow::onBatchUnitFinished(int index, bool ok, const QString &msg) {
+    const QString port = m_flashBatch.units().value(index).port;
+    if (ok) {
+        appendOutputColored(QString("[%1] %2: SUCCESS, %3\n").arg(ts(), port, msg), QColor(0, 120, 0));
+    } else {
+        appendOutputColored(QString("[%1] %2: ERROR: %3\n").arg(ts(), port, msg), QColor(180, 0, 0));
+    }
+}
+
+void MainWindow::onBatchFinished() {
+    m_batchProgressTimer.stop();
+    onBatchProgressTick();
+
+    const FlashBatch::Stats s = m_flashBatch.stats();
+    const QString summary = QString("%1 passed, %2 failed of %3 in %4 s (%5 KiB/s aggregate, %6 s/board)")
+                                .arg(s.passed).arg(s.failed).arg(s.boards)
+                                .arg(s.elapsed, 0, 'f', 1).arg(s.kbps, 0, 'f', 1)
+                                .arg(s.secsPerBoard, 0, 'f', 1);
+    appendOutputColored(QString("[%1] Batch done: %2\n").arg(ts(), summary),
+                        s.failed == 0 ? QColor(0, 120, 0) : QColor(180, 0, 0));
+    setStatus(QString("批量烧录完成：通过 %1 / 失败 %2").arg(s.passed).arg(s.failed), 12000);
+    if (m_batchDialog) {
+        m_batchDialog->setRunning(false);
+        m_batchDialog->setStatusText(s.failed == 0 ? QString("全部通过") : QString("%1 块失败").arg(s.failed));
+    }
+    setUiEnabled(true);
+}
+
+void MainWindow::appendChipInfo(const Stm32Bootloader::ChipInfo &chip) {
+    const QColor gray(80, 80, 80);
+    appendOutputColored(QString("\n[%1] Target info:\n").arg(ts()), gray);
+    appendOutputColored(QString("  Version    : 0x%1\n").arg(chip.bootloaderVersion, 2, 16, QLatin1Char('0')), gray);
+    appendOutputColored(QString("  Option 1   : 0x%1\n").arg(chip.option1, 2, 16, QLatin1Char('0')), gray);
+    appendOutputColored(QString("  Option 2   : 0x%1\n").arg(chip.option2, 2, 16, QLatin1Char('0')), gray);
+    const QString id = QString("0x%1").arg(chip.pid, 4, 16, QLatin1Char('0'));
+    if (!chip.deviceName.isEmpty())
+        appendOutputColored(QString("  Device ID  : %1 (%2)\n").arg(id, chip.deviceName), gray);
+    else
+        appendOutputColored(QString("  Device ID  : %1\n").arg(id), gray);
+    if (chip.flashSize > 0) {
+        const QString unit = chip.sectors ? QString("16/64/128KiB sectors")
+                                          : QString("%1b pages").arg(chip.pageSize);
+        appendOutputColored(QString("  Flash      : Up to %1KiB (%2)\n").arg(chip.flashSize / 1024).arg(unit), gray);
+    }
+    QStringList cmds;
+    for (char c : chip.commands) cmds << QString("%1").arg(quint8(c), 2, 16, QLatin1Char('0'));
+    appendOutputColored(QString("  Commands   : %1\n").arg(cmds.join(' ')), gray);
+}
+
 /* ---------------------------
  *  以下两个函数当前不再用于 AUTO（因为已改为 stm32flash -i 序列）
  *  先保留，避免你 mainwindow.h 里已有声明导致链接错误。
@@ -494,109 +832,26 @@ bool MainWindow::resetToRunByDtrRts(const QString &portPath, int baud, QString *
 /* ---------------------------
  *  从 stm32flash 输出中提取芯片信息
  * --------------------------- */
-void MainWindow::appendChipInfoFromText(const QString &text) {
-    // 目标字段
-    QString versionHex;
-    QString opt1Hex;
-    QString opt2Hex;
-
-    QString devId;
-    QString devIdDesc;
-
-    QString ram;
-    QString flash;
-    QString optionRam;
-    QString systemRam;
-
-    auto firstMatch = [&](const QRegularExpression &re) -> QRegularExpressionMatch {
-        auto it = re.globalMatch(text);
-        if (it.hasNext()) return it.next();
-        return {};
-    };
-
-    auto cap = [&](const QString &pattern, int group = 1) -> QString {
-        QRegularExpression re(pattern, QRegularExpression::CaseInsensitiveOption);
-        auto m = firstMatch(re);
-        return m.hasMatch() ? m.captured(group).trimmed() : QString();
-    };
-
-    // --- 1) 顶部 Key:Value ---
-    // Version      : 0x22
-    versionHex = cap(R"(Version\s*:\s*(0x[0-9a-fA-F]+))");
-
-    // Option 1     : 0x00
-    opt1Hex = cap(R"(Option\s*1\s*:\s*(0x[0-9a-fA-F]+))");
-
-    // Option 2     : 0x00
-    opt2Hex = cap(R"(Option\s*2\s*:\s*(0x[0-9a-fA-F]+))");
-
-    // Device ID    : 0x0410 (STM32F10xxx Medium-density)
-    {
-        QRegularExpression re(
-            R"(Device\s+ID\s*:\s*(0x[0-9a-fA-F]+)(?:\s*\(([^)]+)\))?)",
-            QRegularExpression::CaseInsensitiveOption
-            );
-        auto m = firstMatch(re);
-        if (m.hasMatch()) {
-            devId = m.captured(1).trimmed();
-            devIdDesc = m.captured(2).trimmed();
-        }
-    }
+void MainWindow::appendChipInfo(const Stm32flashParser::ChipFields &chip) {
+    const QColor gray(80, 80, 80);
+    appendOutputColored(QString("\n[%1] Target info (stm32flash):\n").arg(ts()), gray);
 
-    // 兼容其他输出：Chip ID / PID
-    if (devId.isEmpty()) {
-        QRegularExpression re(
-            R"((Chip\s+ID|PID)\s*:\s*(0x[0-9a-fA-F]+))",
-            QRegularExpression::CaseInsensitiveOption
-            );
-        auto m = firstMatch(re);
-        if (m.hasMatch()) devId = m.captured(2).trimmed();
-    }
-
-    // --- 2) 列表项：- RAM / - Flash / - Option RAM / - System RAM ---
-    // - RAM        : Up to 20KiB  (512b reserved by bootloader)
-    ram = cap(R"(-\s*RAM\s*:\s*([^\r\n]+))");
-
-    // - Flash      : Up to 128KiB (size first sector: 4x1024)
-    flash = cap(R"(-\s*Flash\s*:\s*([^\r\n]+))");
-
-    // - Option RAM : 16b
-    optionRam = cap(R"(-\s*Option\s*RAM\s*:\s*([^\r\n]+))");
-
-    // - System RAM : 2KiB
-    systemRam = cap(R"(-\s*System\s*RAM\s*:\s*([^\r\n]+))");
-
-    // --- 输出 ---
-    appendOutputColored(QString("\n[%1] Target info (stm32flash):\n").arg(ts()),
-                        QColor(80, 80, 80));
-
-    bool any = false;
-
-    auto emitLine = [&](const QString &k, const QString &v) {
-        if (v.isEmpty()) return;
-        appendOutputColored(QString("  %-11s %1\n").arg(v).arg(k), QColor(80, 80, 80)); // 这行不对齐也没关系
-    };
-
-    // 为了更清晰，直接手动格式化每行
-    if (!versionHex.isEmpty()) { appendOutputColored(QString("  Version    : %1\n").arg(versionHex), QColor(80,80,80)); any = true; }
-    if (!opt1Hex.isEmpty())    { appendOutputColored(QString("  Option 1   : %1\n").arg(opt1Hex),    QColor(80,80,80)); any = true; }
-    if (!opt2Hex.isEmpty())    { appendOutputColored(QString("  Option 2   : %1\n").arg(opt2Hex),    QColor(80,80,80)); any = true; }
-
-    if (!devId.isEmpty()) {
-        if (!devIdDesc.isEmpty())
-            appendOutputColored(QString("  Device ID  : %1 (%2)\n").arg(devId, devIdDesc), QColor(80,80,80));
-        else
-            appendOutputColored(QString("  Device ID  : %1\n").arg(devId), QColor(80,80,80));
-        any = true;
-    }
-
-    if (!ram.isEmpty())      { appendOutputColored(QString("  RAM        : %1\n").arg(ram),      QColor(80,80,80)); any = true; }
-    if (!flash.isEmpty())    { appendOutputColored(QString("  Flash      : %1\n").arg(flash),    QColor(80,80,80)); any = true; }
-    if (!optionRam.isEmpty()){ appendOutputColored(QString("  Option RAM : %1\n").arg(optionRam),QColor(80,80,80)); any = true; }
-    if (!systemRam.isEmpty()){ appendOutputColored(QString("  System RAM : %1\n").arg(systemRam),QColor(80,80,80)); any = true; }
-
-    if (!any) {
+    if (chip.isEmpty()) {
         appendOutputColored("  (No parsable device info found in stm32flash output)\n",
                             QColor(180, 90, 0));
+        return;
     }
+
+    auto line = [&](const char *label, const QString &value) {
+        if (!value.isEmpty()) appendOutputColored(QString("  %1: %2\n").arg(QLatin1String(label), value), gray);
+    };
+    line("Version    ", chip.version);
+    line("Option 1   ", chip.option1);
+    line("Option 2   ", chip.option2);
+    line("Device ID  ", chip.deviceName.isEmpty() ? chip.deviceId
+                                                 : QString("%1 (%2)").arg(chip.deviceId, chip.deviceName));
+    line("RAM        ", chip.ram);
+    line("Flash      ", chip.flash);
+    line("Option RAM ", chip.optionRam);
+    line("System RAM ", chip.systemRam);
 }
@@ -2,14 +2,21 @@
 
 #include <QMainWindow>
 #include <QProcess>
+#include <QTimer>
 #include <QtSerialPort/QSerialPort>
 #include "serial_terminal_widget.h"
 #include "plot_widget.h"
+#include "flash_job.h"
+#include "flash_batch.h"
+#include "stm32flash_parser.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+class FlashBatchDialog;
+class QProgressBar;
+
 class MainWindow final : public QMainWindow {
     Q_OBJECT
 
@@ -20,12 +27,22 @@ public:
 private slots:
     void onBrowseElf();
     void onRefreshPorts();
+    void onPortsChanged(const QStringList &added, const QStringList &removed);
     void onFlash();
 
     void onProcReadyStdout();
     void onProcReadyStderr();
     void onProcFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
+    void onFlashJobFinished(bool ok, const QString &msg);
+    void onFlashProgressTick();
+
+    void onOpenBatchFlash();
+    void onBatchFlashStart();
+    void onBatchProgressTick();
+    void onBatchUnitFinished(int index, bool ok, const QString &msg);
+    void onBatchFinished();
+
     void onClearOutput();
 
 private:
@@ -36,7 +53,11 @@ private:
     QString currentSelectedPortPath() const;
 
     void startObjcopy(const QString &elfPath, const QString &binPath);
-    void startFlash(const QString &binPath, const QString &portPath);
+    void startFlash(const QString &elfPath, const QString &portPath);   // built-in, straight from the ELF
+    void startStm32flash(const QString &binPath, const QString &portPath);
+    void applyFlashOptions(FlashJob::Config *cfg) const;   // main-panel checkboxes, shared by single and batch
+    void updateBatchPorts();
+    bool anyFlashRunning() const;
     void setStatus(const QString &msg, int timeoutMs = 0);
 
     void appendOutputColored(const QString &text, const QColor &color);
@@ -48,21 +69,33 @@ private:
     // 是否启用“一键烧录并复位运行”
     bool m_autoBootRun = false;
 
-    // 收集当前 QProcess 输出（用于解析芯片信息）
-    QString m_procAllText;
+    // stm32flash 输出逐行解析（芯片信息 / 进度），不再整段收集
+    Stm32flashParser m_flasherParser;
+    QVector<Stm32flashParser::Event> m_flasherEvents;
+    void handleFlasherOutput(const QByteArray &data, bool fromStderr);
+    void handleFlasherEvents();
+    void updateFlasherStatus();
+    QProgressBar *m_statusProgress = nullptr;
 
     // 控制线序列（RTS=BOOT0, DTR=RESET）
     bool enterBootloaderByDtrRts(const QString &portPath, int baud, QString *err = nullptr);
     bool resetToRunByDtrRts(const QString &portPath, int baud, QString *err = nullptr);
 
-    // 从 stm32flash 输出里提取信息（Device ID / Bootloader ver 等）
-    void appendChipInfoFromText(const QString &text);
+    // stm32flash 输出里解析出的芯片信息（Device ID / Bootloader ver 等）
+    void appendChipInfo(const Stm32flashParser::ChipFields &chip);
+    // 内置烧录：芯片信息直接来自 Get / Get Version / Get ID
+    void appendChipInfo(const Stm32Bootloader::ChipInfo &chip);
     PlotWidget *m_plotWidget = nullptr;
 
 private:
     Ui::MainWindow *ui = nullptr;
 
     QProcess *m_proc = nullptr;
+    FlashJob m_flashJob;
+    QTimer m_flashProgressTimer;
+    FlashBatch m_flashBatch;
+    FlashBatchDialog *m_batchDialog = nullptr;
+    QTimer m_batchProgressTimer;
     Step m_step = Step::None;
 
     QString m_currentElfPath;
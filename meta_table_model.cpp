@@ -0,0 +1,168 @@
+#include "meta_table_model.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+namespace {
+constexpr qint64 kAgeRefreshNs = 200 * 1000 * 1000LL;
+constexpr qint64 kRateWindowNs = 1000 * 1000 * 1000LL;
+
+QString formatAge(double secs) {
+    if (secs < 10.0) return QString("%1 s").arg(secs, 0, 'f', 1);
+    if (secs < 120.0) return QString("%1 s").arg(secs, 0, 'f', 0);
+    return QString("%1 min").arg(secs / 60.0, 0, 'f', 0);
+}
+}
+
+MetaTableModel::MetaTableModel(QObject *parent)
+    : QAbstractTableModel(parent) {
+}
+
+void MetaTableModel::update(const QString &key, const QString &value, const double *number, qint64 tsNs) {
+    Entry &e = m_entries[key];
+    e.value = value;
+    e.lastNs = tsNs;
+    ++e.updates;
+    e.dirty = true;
+
+    if (number) {
+        e.ring[e.head] = *number;
+        e.head = (e.head + 1) % kHistory;
+        if (e.count < kHistory) ++e.count;
+    }
+}
+
+void MetaTableModel::setShownKeys(const QStringList &keys) {
+    beginResetModel();
+    m_rows = keys;
+    m_rowOf.clear();
+    for (int i = 0; i < m_rows.size(); ++i) m_rowOf.insert(m_rows.at(i), i);
+    endResetModel();
+}
+
+void MetaTableModel::clear() {
+    beginResetModel();
+    m_entries.clear();
+    endResetModel();
+}
+
+void MetaTableModel::flush(qint64 nowNs) {
+    m_nowNs = nowNs;
+
+    // value / trend: one dataChanged spanning the rows that changed
+    int first = -1, last = -1;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (!it->dirty) continue;
+        it->dirty = false;
+        const int row = m_rowOf.value(it.key(), -1);
+        if (row < 0) continue;
+        first = first < 0 ? row : qMin(first, row);
+        last = qMax(last, row);
+    }
+    if (first >= 0) emit dataChanged(index(first, ColValue), index(last, ColTrend));
+
+    if (nowNs - m_lastRateNs >= kRateWindowNs) {
+        const double secs = m_lastRateNs > 0 ? double(nowNs - m_lastRateNs) / 1e9 : 0.0;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (secs > 0.0) it->rateHz = double(it->updates - it->updatesAtRate) / secs;
+            it->updatesAtRate = it->updates;
+        }
+        m_lastRateNs = nowNs;
+    }
+
+    // ages tick on their own; a few refreshes a second is plenty
+    if (!m_rows.isEmpty() && nowNs - m_lastAgeNs >= kAgeRefreshNs) {
+        m_lastAgeNs = nowNs;
+        emit dataChanged(index(0, ColAge), index(m_rows.size() - 1, ColRate));
+    }
+}
+
+QVector<double> MetaTableModel::history(int row) const {
+    QVector<double> out;
+    if (row < 0 || row >= m_rows.size()) return out;
+    const auto it = m_entries.constFind(m_rows.at(row));
+    if (it == m_entries.constEnd()) return out;
+
+    out.reserve(it->count);
+    const int start = (it->head - it->count + kHistory) % kHistory;
+    for (int i = 0; i < it->count; ++i) out.push_back(it->ring[(start + i) % kHistory]);
+    return out;
+}
+
+int MetaTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int MetaTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant MetaTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size()) return QVariant();
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) return QVariant();
+
+    const QString &key = m_rows.at(index.row());
+    const auto it = m_entries.constFind(key);
+    const bool seen = it != m_entries.constEnd();
+
+    switch (index.column()) {
+    case ColKey:
+        return key;
+    case ColValue:
+        return seen ? it->value : QString();
+    case ColTrend:
+        return role == Qt::ToolTipRole && seen ? QString("最近 %1 个数值").arg(it->count) : QVariant();
+    case ColAge:
+        if (!seen || m_nowNs == 0) return QString("—");
+        return formatAge(double(qMax<qint64>(0, m_nowNs - it->lastNs)) / 1e9);
+    case ColRate:
+        return seen ? QString("%1 Hz").arg(it->rateHz, 0, 'f', it->rateHz < 10.0 ? 1 : 0) : QString();
+    }
+    return QVariant();
+}
+
+QVariant MetaTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    switch (section) {
+    case ColKey:   return "键";
+    case ColValue: return "值";
+    case ColTrend: return "趋势";
+    case ColAge:   return "更新";
+    case ColRate:  return "频率";
+    }
+    return QVariant();
+}
+
+/* --------------------------- sparkline --------------------------- */
+
+void MetaSparklineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    QStyledItemDelegate::paint(painter, option, index);
+
+    const auto *model = qobject_cast<const MetaTableModel*>(index.model());
+    if (!model || index.column() != MetaTableModel::ColTrend) return;
+    const QVector<double> h = model->history(index.row());
+    if (h.size() < 2) return;
+
+    double lo = h.first(), hi = h.first();
+    for (double v : h) {
+        lo = qMin(lo, v);
+        hi = qMax(hi, v);
+    }
+    const double span = hi > lo ? hi - lo : 1.0;
+    const QRectF r = QRectF(option.rect).adjusted(2, 3, -2, -3);
+
+    QPainterPath path;
+    for (int i = 0; i < h.size(); ++i) {
+        const double x = r.left() + r.width() * i / (h.size() - 1);
+        const double y = r.bottom() - r.height() * (h.at(i) - lo) / span;
+        if (i == 0) path.moveTo(x, y);
+        else path.lineTo(x, y);
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setPen(QPen(option.state & QStyle::State_Selected ? option.palette.highlightedText().color()
+                                                               : option.palette.text().color(), 1.0));
+    painter->drawPath(path);
+    painter->restore();
+}
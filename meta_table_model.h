@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// 绘图页“字段解析”表：每个键一行（值 / 趋势 / 距上次更新 / 更新频率）。
+// update() 只记账不发信号；flush() 每帧最多调用一次，只对变化的行发 dataChanged，
+// 年龄 / 频率列按较低频率整列刷新。数值型的值额外记入定长环形历史，供趋势列画迷你折线。
+class MetaTableModel final : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { ColKey = 0, ColValue, ColTrend, ColAge, ColRate, ColumnCount };
+
+    static constexpr int kHistory = 64;
+
+    explicit MetaTableModel(QObject *parent = nullptr);
+
+    // every parsed key, shown or not; no signals. number: the value already parsed by the
+    // caller, nullptr when it is not numeric (the model never re-parses)
+    void update(const QString &key, const QString &value, const double *number, qint64 tsNs);
+    // rows = these keys in this order
+    void setShownKeys(const QStringList &keys);
+    void clear();                        // values and history; shown keys stay
+    void flush(qint64 nowNs);
+
+    // numeric history of a row, oldest first
+    QVector<double> history(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Entry {
+        QString value;
+        double ring[kHistory];
+        int head = 0;                    // next slot
+        int count = 0;
+        qint64 lastNs = 0;
+        quint64 updates = 0;
+        quint64 updatesAtRate = 0;       // updates at the last rate sample
+        double rateHz = 0.0;
+        bool dirty = false;
+    };
+
+    QHash<QString, Entry> m_entries;
+    QStringList m_rows;
+    QHash<QString, int> m_rowOf;
+    qint64 m_nowNs = 0;
+    qint64 m_lastAgeNs = 0;
+    qint64 m_lastRateNs = 0;
+};
+
+// 趋势列：按行的历史画迷你折线（自动纵向缩放）
+class MetaSparklineDelegate final : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
@@ -0,0 +1,241 @@
+#include "plot_export.h"
+
+#include <QThread>
+#include <QSaveFile>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+constexpr int kFlushBytes = 1 << 20;          // write in ~1 MiB pieces
+constexpr int kProgressStep = 1 << 16;        // samples between progress updates
+constexpr int kAlign = 64;
+
+// samples of one series inside the requested X range
+struct Span {
+    int first = 0;
+    int last = 0;                 // implicit X: [first, last); explicit: whole buffer, filtered per sample
+    qint64 count = 0;
+};
+
+bool inRange(const PlotExporter::Request &req, double x) {
+    return !req.limitX || (x >= req.x0 && x <= req.x1);
+}
+
+Span spanOf(const PlotExporter::Request &req, const CurveBuffer &buf) {
+    Span s;
+    s.last = buf.size();
+    if (!req.limitX) {
+        s.count = buf.size();
+    } else if (buf.isImplicitX()) {
+        buf.indexRange(req.x0, req.x1, &s.first, &s.last);
+        s.count = s.last - s.first;
+    } else {
+        for (int i = 0; i < buf.size(); ++i) {
+            if (inRange(req, buf.x(i))) ++s.count;
+        }
+    }
+    return s;
+}
+
+QByteArray dtype(char kind, int bytes) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const char order = '<';
+#else
+    const char order = '>';
+#endif
+    return QByteArray(1, order) + kind + QByteArray::number(bytes);
+}
+
+qint64 alignUp(qint64 v) {
+    return (v + kAlign - 1) / kAlign * kAlign;
+}
+
+template <typename T>
+void putRaw(QByteArray *out, T v) {
+    char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    out->append(b, int(sizeof(T)));
+}
+}
+
+PlotExporter::PlotExporter(QObject *parent)
+    : QObject(parent) {
+}
+
+PlotExporter::~PlotExporter() {
+    if (!m_thread) return;
+    m_cancel.store(true);
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void PlotExporter::start(const Request &req) {
+    if (m_thread) return;
+    m_cancel.store(false);
+    m_done.store(0);
+    m_total.store(0);
+
+    m_thread = QThread::create([this, req]() {
+        const Result r = run(req);
+        QMetaObject::invokeMethod(this, [this, r]() { onWorkerDone(r); }, Qt::QueuedConnection);
+    });
+    m_thread->setObjectName("PlotExport");
+    m_thread->start();
+}
+
+void PlotExporter::onWorkerDone(const Result &r) {
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    emit finished(r.ok, r.message);
+}
+
+PlotExporter::Result PlotExporter::run(const Request &req) {
+    Result r;
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<Span> spans;
+    spans.reserve(req.series.size());
+    qint64 total = 0;
+    for (const Series &s : req.series) {
+        spans.push_back(spanOf(req, s.samples));
+        total += spans.last().count;
+    }
+    // binary writes every sample twice (x column, y column)
+    m_total.store(req.format == Format::Binary ? 2 * total : total);
+
+    QSaveFile file(req.path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        r.message = QString("Cannot open %1: %2").arg(req.path, file.errorString());
+        return r;
+    }
+
+    QByteArray out;
+    out.reserve(kFlushBytes + 256);
+    bool failed = false;
+    auto flush = [&]() {
+        if (!out.isEmpty() && file.write(out) != out.size()) failed = true;
+        out.resize(0);
+    };
+    qint64 done = 0;
+    auto tick = [&]() {
+        if ((++done & (kProgressStep - 1)) == 0) m_done.store(done);
+        if (out.size() >= kFlushBytes) flush();
+    };
+
+    if (req.format == Format::Csv) {
+        out.append("curve,x,y\n");
+        for (int si = 0; si < req.series.size() && !failed && !m_cancel.load(); ++si) {
+            const CurveBuffer &buf = req.series.at(si).samples;
+            const Span &sp = spans.at(si);
+            QByteArray name = req.series.at(si).name.toUtf8();
+            if (name.contains(',') || name.contains('"')) name = '"' + name.replace("\"", "\"\"") + '"';
+            const int yDigits = buf.isImplicitX() ? 9 : 17;    // float y round-trips in 9
+
+            for (int i = sp.first; i < sp.last; ++i) {
+                const double x = buf.x(i);
+                if (!buf.isImplicitX() && !inRange(req, x)) continue;
+                out.append(name).append(',')
+                   .append(QByteArray::number(x, 'g', 17)).append(',')
+                   .append(QByteArray::number(buf.y(i), 'g', yDigits)).append('\n');
+                tick();
+                if ((i & 0xFFFF) == 0 && (failed || m_cancel.load())) break;
+            }
+        }
+    } else {
+        // header first: every column's offset follows from the counts
+        struct Col { int series; bool isX; QByteArray dtype; int bytes; qint64 offset; };
+        QVector<Col> cols;
+        for (int si = 0; si < req.series.size(); ++si) {
+            const CurveBuffer::XMode mode = req.series.at(si).samples.mode();
+            const bool implicitX = mode != CurveBuffer::XMode::Explicit;
+            cols.push_back({si, true, mode == CurveBuffer::XMode::Index ? dtype('i', 8) : dtype('f', 8), 8, 0});
+            cols.push_back({si, false, implicitX ? dtype('f', 4) : dtype('f', 8), implicitX ? 4 : 8, 0});
+        }
+
+        // the header lists the offsets, which depend on the header size: grow until it fits
+        QByteArray json;
+        qint64 dataStart = kAlign;
+        for (;;) {
+            qint64 pos = dataStart;
+            QJsonArray jsonCols;
+            for (Col &c : cols) {
+                c.offset = pos;
+                const qint64 count = spans.at(c.series).count;
+                QJsonObject o;
+                o.insert("curve", req.series.at(c.series).name);
+                o.insert("name", c.isX ? "x" : "y");
+                o.insert("dtype", QString::fromLatin1(c.dtype));
+                o.insert("offset", double(c.offset));
+                o.insert("count", double(count));
+                jsonCols.append(o);
+                pos = alignUp(pos + count * c.bytes);
+            }
+            QJsonObject root;
+            root.insert("version", 1);
+            root.insert("columns", jsonCols);
+            json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+
+            const qint64 need = alignUp(12 + json.size());
+            if (need <= dataStart) break;
+            dataStart = need;
+        }
+        json.append(QByteArray(int(dataStart - 12 - json.size()), ' '));
+
+        out.append("STCOL001", 8);
+        putRaw<quint32>(&out, qToLittleEndian(quint32(json.size())));
+        out.append(json);
+
+        qint64 written = dataStart;
+        for (const Col &c : cols) {
+            if (failed || m_cancel.load()) break;
+            if (c.offset > written) {
+                out.append(QByteArray(int(c.offset - written), '\0'));
+                written = c.offset;
+            }
+            const CurveBuffer &buf = req.series.at(c.series).samples;
+            const Span &sp = spans.at(c.series);
+            const CurveBuffer::XMode mode = buf.mode();
+
+            for (int i = sp.first; i < sp.last; ++i) {
+                if (!buf.isImplicitX() && !inRange(req, buf.x(i))) continue;
+                if (c.isX) {
+                    if (mode == CurveBuffer::XMode::Index) putRaw<qint64>(&out, qint64(buf.x(i)));
+                    else putRaw<double>(&out, buf.x(i));
+                } else {
+                    if (buf.isImplicitX()) putRaw<float>(&out, float(buf.y(i)));
+                    else putRaw<double>(&out, buf.y(i));
+                }
+                tick();
+                if ((i & 0xFFFF) == 0 && (failed || m_cancel.load())) break;
+            }
+            written += sp.count * c.bytes;
+        }
+    }
+
+    flush();
+    m_done.store(done);
+
+    if (m_cancel.load()) {
+        file.cancelWriting();
+        r.message = "Export cancelled.";
+        return r;
+    }
+    if (failed || !file.commit()) {
+        r.message = QString("Write failed: %1").arg(file.errorString());
+        return r;
+    }
+
+    r.ok = true;
+    r.message = QString("Exported %1 samples of %2 curve(s) in %3 s.")
+                    .arg(total).arg(req.series.size()).arg(double(timer.elapsed()) / 1000.0, 0, 'f', 1);
+    return r;
+}
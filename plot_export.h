@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+#include "curve_buffer.h"
+
+class QThread;
+
+// 绘图数据导出（后台线程，流式写盘）。
+// 输入是各曲线 CurveBuffer 的快照（只复制块指针，不复制采样），采集可以照常继续。
+//
+// CSV：一行一个采样 "curve,x,y"。
+// 二进制列存（.stcol）：
+//   [0, 8)   magic "STCOL001"
+//   [8, 12)  uint32 LE，JSON 表头字节数 H
+//   [12, 12+H) UTF-8 JSON：{"version":1,"columns":[{"curve","name","dtype","offset","count"}, ...]}
+//   之后每条曲线依次是 x 列、y 列，各列起点按 64 字节对齐，dtype 为 numpy 写法（"<f8" / "<f4" / "<i8"）。
+// numpy 读取：
+//   h = json.loads(raw[12:12 + int.from_bytes(raw[8:12], "little")])
+//   np.fromfile(path, dtype=c["dtype"], count=c["count"], offset=c["offset"])
+class PlotExporter final : public QObject {
+    Q_OBJECT
+public:
+    enum class Format { Csv, Binary };
+
+    struct Series {
+        QString name;
+        CurveBuffer samples;         // snapshot
+    };
+
+    struct Request {
+        QString path;
+        Format format = Format::Csv;
+        bool limitX = false;         // only samples with x in [x0, x1]
+        double x0 = 0.0;
+        double x1 = 0.0;
+        QVector<Series> series;
+    };
+
+    explicit PlotExporter(QObject *parent = nullptr);
+    ~PlotExporter() override;
+
+    bool isRunning() const { return m_thread != nullptr; }
+    void start(const Request &req);
+    void cancel() { m_cancel.store(true); }
+
+    // samples written / to write; safe to poll from the GUI
+    qint64 doneSamples() const { return m_done.load(); }
+    qint64 totalSamples() const { return m_total.load(); }
+
+signals:
+    void finished(bool ok, const QString &message);
+
+private:
+    struct Result {
+        bool ok = false;
+        QString message;
+    };
+
+    Result run(const Request &req);
+    void onWorkerDone(const Result &r);
+
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<qint64> m_done{0};
+    std::atomic<qint64> m_total{0};
+};
@@ -0,0 +1,204 @@
+#include "plot_export_dialog.h"
+
+#include <QListWidget>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QDoubleSpinBox>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QLabel>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <limits>
+
+PlotExportDialog::PlotExportDialog(QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("导出曲线数据");
+    setModal(false);
+    resize(460, 480);
+
+    m_curveList = new QListWidget(this);
+    m_allBtn = new QPushButton("全选", this);
+
+    m_limitCheck = new QCheckBox("仅导出 X 范围", this);
+    auto makeSpin = [this]() {
+        auto *spin = new QDoubleSpinBox(this);
+        spin->setDecimals(6);
+        spin->setRange(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+        spin->setEnabled(false);
+        return spin;
+    };
+    m_x0Spin = makeSpin();
+    m_x1Spin = makeSpin();
+    m_viewBtn = new QPushButton("当前视图", this);
+    m_fullBtn = new QPushButton("全部", this);
+
+    m_formatCombo = new QComboBox(this);
+    m_formatCombo->addItem("CSV (*.csv)", int(PlotExporter::Format::Csv));
+    m_formatCombo->addItem("二进制列存 (*.stcol，numpy 可读)", int(PlotExporter::Format::Binary));
+
+    m_pathEdit = new QLineEdit(this);
+    m_browseBtn = new QPushButton("浏览…", this);
+
+    m_progress = new QProgressBar(this);
+    m_progress->setRange(0, 1000);
+    m_progress->setValue(0);
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+
+    m_startBtn = new QPushButton("导出", this);
+    m_cancelBtn = new QPushButton("取消", this);
+    m_cancelBtn->setEnabled(false);
+
+    auto *curveBtns = new QHBoxLayout();
+    curveBtns->addWidget(m_allBtn);
+    curveBtns->addStretch(1);
+
+    auto *range = new QHBoxLayout();
+    range->addWidget(m_x0Spin, 1);
+    range->addWidget(new QLabel("~", this));
+    range->addWidget(m_x1Spin, 1);
+    range->addWidget(m_viewBtn);
+    range->addWidget(m_fullBtn);
+
+    auto *file = new QHBoxLayout();
+    file->addWidget(m_pathEdit, 1);
+    file->addWidget(m_browseBtn);
+
+    auto *form = new QFormLayout();
+    form->addRow(m_limitCheck);
+    form->addRow("X", range);
+    form->addRow("格式", m_formatCombo);
+    form->addRow("文件", file);
+
+    auto *runBtns = new QHBoxLayout();
+    runBtns->addStretch(1);
+    runBtns->addWidget(m_startBtn);
+    runBtns->addWidget(m_cancelBtn);
+
+    auto *root = new QVBoxLayout(this);
+    root->addWidget(m_curveList, 1);
+    root->addLayout(curveBtns);
+    root->addLayout(form);
+    root->addWidget(m_progress);
+    root->addWidget(m_statusLabel);
+    root->addLayout(runBtns);
+
+    connect(m_allBtn, &QPushButton::clicked, this, [this]() {
+        for (int i = 0; i < m_curveList->count(); ++i) m_curveList->item(i)->setCheckState(Qt::Checked);
+    });
+    connect(m_limitCheck, &QCheckBox::toggled, this, [this](bool on) {
+        m_x0Spin->setEnabled(on);
+        m_x1Spin->setEnabled(on);
+    });
+    connect(m_viewBtn, &QPushButton::clicked, this, [this]() {
+        m_limitCheck->setChecked(true);
+        m_x0Spin->setValue(m_viewX0);
+        m_x1Spin->setValue(m_viewX1);
+    });
+    connect(m_fullBtn, &QPushButton::clicked, this, [this]() {
+        m_x0Spin->setValue(m_fullX0);
+        m_x1Spin->setValue(m_fullX1);
+    });
+    connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        // keep the typed name, swap the extension
+        const QString p = m_pathEdit->text().trimmed();
+        if (p.isEmpty()) return;
+        const QFileInfo fi(p);
+        const QString ext = format() == PlotExporter::Format::Csv ? "csv" : "stcol";
+        m_pathEdit->setText(fi.dir().filePath(fi.completeBaseName() + "." + ext));
+    });
+    connect(m_browseBtn, &QPushButton::clicked, this, &PlotExportDialog::onBrowse);
+    connect(m_startBtn, &QPushButton::clicked, this, &PlotExportDialog::startRequested);
+    connect(m_cancelBtn, &QPushButton::clicked, this, &PlotExportDialog::cancelRequested);
+}
+
+void PlotExportDialog::setCurves(const QList<QPair<int, QString>> &curves) {
+    const QList<int> checked = selectedChannels();
+    const bool first = m_curveList->count() == 0;
+    m_curveList->clear();
+    for (const auto &c : curves) {
+        auto *item = new QListWidgetItem(c.second, m_curveList);
+        item->setData(Qt::UserRole, c.first);
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+        item->setCheckState(first || checked.contains(c.first) ? Qt::Checked : Qt::Unchecked);
+    }
+}
+
+QList<int> PlotExportDialog::selectedChannels() const {
+    QList<int> out;
+    for (int i = 0; i < m_curveList->count(); ++i) {
+        const QListWidgetItem *item = m_curveList->item(i);
+        if (item->checkState() == Qt::Checked) out << item->data(Qt::UserRole).toInt();
+    }
+    return out;
+}
+
+void PlotExportDialog::setRanges(double fullX0, double fullX1, double viewX0, double viewX1) {
+    m_fullX0 = fullX0;
+    m_fullX1 = fullX1;
+    m_viewX0 = viewX0;
+    m_viewX1 = viewX1;
+    if (!m_limitCheck->isChecked()) {
+        m_x0Spin->setValue(fullX0);
+        m_x1Spin->setValue(fullX1);
+    }
+}
+
+PlotExporter::Format PlotExportDialog::format() const {
+    return PlotExporter::Format(m_formatCombo->currentData().toInt());
+}
+
+QString PlotExportDialog::path() const {
+    return m_pathEdit->text().trimmed();
+}
+
+bool PlotExportDialog::limitX() const {
+    return m_limitCheck->isChecked();
+}
+
+double PlotExportDialog::x0() const {
+    return qMin(m_x0Spin->value(), m_x1Spin->value());
+}
+
+double PlotExportDialog::x1() const {
+    return qMax(m_x0Spin->value(), m_x1Spin->value());
+}
+
+void PlotExportDialog::setRunning(bool running) {
+    m_startBtn->setEnabled(!running);
+    m_cancelBtn->setEnabled(running);
+    m_curveList->setEnabled(!running);
+    m_allBtn->setEnabled(!running);
+    m_limitCheck->setEnabled(!running);
+    m_x0Spin->setEnabled(!running && m_limitCheck->isChecked());
+    m_x1Spin->setEnabled(!running && m_limitCheck->isChecked());
+    m_viewBtn->setEnabled(!running);
+    m_fullBtn->setEnabled(!running);
+    m_formatCombo->setEnabled(!running);
+    m_pathEdit->setEnabled(!running);
+    m_browseBtn->setEnabled(!running);
+}
+
+void PlotExportDialog::setProgress(qint64 done, qint64 total) {
+    m_progress->setValue(total > 0 ? int(qMin<qint64>(1000, done * 1000 / total)) : 0);
+}
+
+void PlotExportDialog::setStatusText(const QString &text) {
+    m_statusLabel->setText(text);
+}
+
+void PlotExportDialog::onBrowse() {
+    const bool csv = format() == PlotExporter::Format::Csv;
+    const QString file = QFileDialog::getSaveFileName(
+        this, "导出到", path().isEmpty() ? (csv ? "plot.csv" : "plot.stcol") : path(),
+        csv ? "CSV (*.csv)" : "二进制列存 (*.stcol)");
+    if (!file.isEmpty()) m_pathEdit->setText(file);
+}
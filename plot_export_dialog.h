@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QDialog>
+#include <QPair>
+
+#include "plot_export.h"
+
+class QListWidget;
+class QPushButton;
+class QCheckBox;
+class QDoubleSpinBox;
+class QComboBox;
+class QLineEdit;
+class QProgressBar;
+class QLabel;
+
+// 绘图数据导出窗口（非模态）：勾选曲线、X 范围、格式与文件；实际导出由 PlotWidget 驱动。
+class PlotExportDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit PlotExportDialog(QWidget *parent = nullptr);
+
+    // (channel, name); keeps the check state of curves that are still present
+    void setCurves(const QList<QPair<int, QString>> &curves);
+    QList<int> selectedChannels() const;
+
+    // full extent of the data and the chart's visible window
+    void setRanges(double fullX0, double fullX1, double viewX0, double viewX1);
+
+    PlotExporter::Format format() const;
+    QString path() const;
+    bool limitX() const;
+    double x0() const;
+    double x1() const;
+
+    void setRunning(bool running);
+    void setProgress(qint64 done, qint64 total);
+    void setStatusText(const QString &text);
+
+signals:
+    void startRequested();
+    void cancelRequested();
+
+private:
+    void onBrowse();
+
+    QListWidget *m_curveList = nullptr;
+    QPushButton *m_allBtn = nullptr;
+    QCheckBox *m_limitCheck = nullptr;
+    QDoubleSpinBox *m_x0Spin = nullptr;
+    QDoubleSpinBox *m_x1Spin = nullptr;
+    QPushButton *m_viewBtn = nullptr;
+    QPushButton *m_fullBtn = nullptr;
+    QComboBox *m_formatCombo = nullptr;
+    QLineEdit *m_pathEdit = nullptr;
+    QPushButton *m_browseBtn = nullptr;
+    QProgressBar *m_progress = nullptr;
+    QLabel *m_statusLabel = nullptr;
+    QPushButton *m_startBtn = nullptr;
+    QPushButton *m_cancelBtn = nullptr;
+
+    double m_fullX0 = 0.0, m_fullX1 = 0.0;
+    double m_viewX0 = 0.0, m_viewX1 = 0.0;
+};
@@ -0,0 +1,241 @@
+#include "plot_import.h"
+#include "plot_line.h"
+
+#include <QThread>
+#include <QMutexLocker>
+#include <QtNumeric>
+
+#include <cstring>
+
+namespace {
+constexpr qint64 kBlockBytes = 4 << 20;       // ~4 MiB of text per block
+constexpr int kCaptureTextOffset = 19;        // "HH:mm:ss.zzzuuu RX "
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int digits(const char *p, int n) {
+    int v = 0;
+    for (int i = 0; i < n; ++i) v = v * 10 + (p[i] - '0');
+    return v;
+}
+
+// SessionLogger line: stamp, direction tag, escaped text
+bool captureLine(const char *p, int len, double *t, bool *rx) {
+    if (len < kCaptureTextOffset) return false;
+    static const char kShape[] = "dd:dd:dd.dddddd ";
+    for (int i = 0; i < 16; ++i) {
+        if (kShape[i] == 'd' ? !isDigit(p[i]) : p[i] != kShape[i]) return false;
+    }
+    const bool isRx = p[16] == 'R' && p[17] == 'X';
+    const bool isOther = (p[16] == 'T' && p[17] == 'X') || (p[16] == '-' && p[17] == '-');
+    if ((!isRx && !isOther) || p[18] != ' ') return false;
+
+    *t = digits(p, 2) * 3600.0 + digits(p + 3, 2) * 60.0 + digits(p + 6, 2)
+         + digits(p + 9, 6) * 1e-6;
+    *rx = isRx;
+    return true;
+}
+}
+
+PlotImporter::PlotImporter(QObject *parent)
+    : QObject(parent) {
+}
+
+PlotImporter::~PlotImporter() {
+    cancel();
+    finish();
+}
+
+bool PlotImporter::start(const Options &opt, QString *err) {
+    if (isRunning()) return false;
+    finish();
+
+    m_opt = opt;
+    m_file.setFileName(opt.path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (err) *err = QString("Cannot open %1: %2").arg(opt.path, m_file.errorString());
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size <= 0) {
+        if (err) *err = QString("%1 is empty.").arg(opt.path);
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, m_size);
+    if (!m_map) {
+        if (err) *err = QString("Cannot map %1: %2").arg(opt.path, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+
+    // block ends move forward to the next '\n': no line is split between two workers
+    m_bounds.clear();
+    m_bounds.push_back(0);
+    const char *base = reinterpret_cast<const char *>(m_map);
+    qint64 pos = 0;
+    while (pos < m_size) {
+        qint64 end = pos + kBlockBytes;
+        if (end >= m_size) {
+            end = m_size;
+        } else {
+            const void *nl = std::memchr(base + end, '\n', size_t(m_size - end));
+            end = nl ? qint64(static_cast<const char *>(nl) - base) + 1 : m_size;
+        }
+        m_bounds.push_back(end);
+        pos = end;
+    }
+
+    const int workers = qBound(1, QThread::idealThreadCount(), int(m_bounds.size()) - 1);
+    m_cancel.store(false);
+    m_parsedBytes.store(0);
+    m_parsedLines.store(0);
+    m_nextClaim = 0;
+    m_nextTake = 0;
+    m_ready.clear();
+    m_window = 2 * workers;
+    m_running.store(workers);
+
+    for (int i = 0; i < workers; ++i) {
+        QThread *t = QThread::create([this]() {
+            runWorker();
+            m_running.fetch_sub(1);
+        });
+        t->setObjectName(QString("PlotImport%1").arg(i));
+        m_threads.push_back(t);
+        t->start();
+    }
+    return true;
+}
+
+void PlotImporter::cancel() {
+    m_cancel.store(true);
+    QMutexLocker lock(&m_mutex);
+    m_space.wakeAll();
+}
+
+bool PlotImporter::takeNext(Block *out) {
+    QMutexLocker lock(&m_mutex);
+    auto it = m_ready.find(m_nextTake);
+    if (it == m_ready.end()) return false;
+    *out = std::move(it.value());
+    m_ready.erase(it);
+    ++m_nextTake;
+    m_space.wakeAll();
+    return true;
+}
+
+bool PlotImporter::atEnd() const {
+    if (!isRunning()) return true;
+    if (m_cancel.load()) return m_running.load() == 0;
+    QMutexLocker lock(&m_mutex);
+    return m_nextTake >= int(m_bounds.size()) - 1;
+}
+
+void PlotImporter::finish() {
+    for (QThread *t : m_threads) {
+        t->wait();
+        delete t;
+    }
+    m_threads.clear();
+    m_ready.clear();
+
+    if (m_map) {
+        m_file.unmap(const_cast<uchar *>(m_map));
+        m_map = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+}
+
+void PlotImporter::runWorker() {
+    const char *base = reinterpret_cast<const char *>(m_map);
+    const int blocks = int(m_bounds.size()) - 1;
+
+    for (;;) {
+        int i = 0;
+        {
+            // stay within m_window blocks of the merge so memory stays bounded
+            QMutexLocker lock(&m_mutex);
+            while (!m_cancel.load() && m_nextClaim < blocks && m_nextClaim >= m_nextTake + m_window)
+                m_space.wait(&m_mutex);
+            if (m_cancel.load() || m_nextClaim >= blocks) return;
+            i = m_nextClaim++;
+        }
+
+        qint64 lines = 0;
+        Block b = parseRange(base + m_bounds.at(i), base + m_bounds.at(i + 1), &lines);
+        m_parsedBytes.fetch_add(m_bounds.at(i + 1) - m_bounds.at(i));
+        m_parsedLines.fetch_add(lines);
+
+        QMutexLocker lock(&m_mutex);
+        m_ready.insert(i, std::move(b));
+    }
+}
+
+PlotImporter::Block PlotImporter::parseRange(const char *begin, const char *end, qint64 *lines) const {
+    Block b;
+    ColumnParser columns;
+    columns.setConfig(m_opt.column);
+    QVector<double> values;
+    const bool firstIsX = m_opt.column.firstIsX;
+
+    const char *p = begin;
+    while (p < end) {
+        if ((*lines & 0xFFF) == 0 && m_cancel.load()) break;
+
+        const void *nl = std::memchr(p, '\n', size_t(end - p));
+        const char *lineEnd = nl ? static_cast<const char *>(nl) : end;
+        int len = int(lineEnd - p);
+        if (len > 0 && p[len - 1] == '\r') --len;
+        const char *text = p;
+        p = lineEnd + 1;
+        ++*lines;
+
+        Record r;
+        bool rx = true;
+        if (captureLine(text, len, &r.t, &rx)) {
+            if (!rx) continue;          // TX echo / system notes
+            r.hasTime = true;
+            text += kCaptureTextOffset;
+            len -= kCaptureTextOffset;
+        }
+        const QString line = QString::fromUtf8(text, len);
+
+        if (!m_opt.columns) {
+            const PlotLine pl = parsePlotLine(line);
+            if (!pl.hasPoint && !pl.hasValue) continue;
+            r.channel = pl.hasChannel ? pl.channel : -1;
+            if (pl.hasPoint) {
+                r.kind = Record::Kind::Point;
+                r.x = pl.point.x();
+                r.y = pl.point.y();
+            } else {
+                r.y = pl.value;
+            }
+            b.records.push_back(r);
+            continue;
+        }
+
+        const ColumnParser::Kind kind = columns.parse(line, &values);
+        if (kind == ColumnParser::Kind::Header) {
+            r.kind = Record::Kind::Header;
+            r.channel = int(b.headers.size());
+            b.headers.push_back(columns.names());
+            b.records.push_back(r);
+            continue;
+        }
+        if (kind != ColumnParser::Kind::Row) continue;
+        if (firstIsX && (values.size() < 2 || qIsNaN(values.first()))) continue;
+
+        const int first = firstIsX ? 1 : 0;
+        r.kind = firstIsX ? Record::Kind::Point : Record::Kind::Value;
+        r.x = firstIsX ? values.first() : 0.0;
+        for (int i = first; i < values.size(); ++i) {
+            if (qIsNaN(values.at(i))) continue;
+            r.channel = i - first;
+            r.y = values.at(i);
+            b.records.push_back(r);
+        }
+    }
+    return b;
+}
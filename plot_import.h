@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "column_parser.h"
+
+class QThread;
+
+// 大文件离线导入：QFile::map 整个文件，按行边界切成若干块，所有核心并行解析
+// （逐行语法与实时串口相同：parsePlotLine / ColumnParser），GUI 线程按块号顺序取回结果并入曲线，
+// 导入未结束时已合并的部分即可查看。解析最多领先合并若干块，内存占用与文件大小无关。
+//
+// 会话日志（SessionLogger 的 "HH:mm:ss.zzzuuu RX text"）自动识别：只取 RX 行，
+// 去掉前缀后按普通行解析，接收时间随采样带出（供“接收时间”X 来源使用）。
+// 并入数据的曲线缓冲上限提高到 1000 万点（PlotWidget kImportMaxPoints，导入后保留，可再调小），
+// 超出时丢弃最早的采样并报告个数。
+// 只支持未压缩文件（.gz 分段需先解压）。
+class PlotImporter final : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QString path;
+        bool columns = false;          // column mode instead of the line grammar
+        ColumnParser::Config column;
+    };
+
+    // one parsed item, in file order
+    struct Record {
+        enum class Kind : quint8 { Point, Value, Header };
+        Kind kind = Kind::Value;
+        bool hasTime = false;          // capture file: t is the receive time
+        int channel = -1;              // CH:n / value column (-1 = none); Header: index into Block::headers
+        double x = 0.0;                // Point only
+        double y = 0.0;
+        double t = 0.0;                // seconds since midnight
+    };
+
+    struct Block {
+        QVector<Record> records;
+        QVector<QStringList> headers;  // column mode header rows
+    };
+
+    explicit PlotImporter(QObject *parent = nullptr);
+    ~PlotImporter() override;
+
+    bool start(const Options &opt, QString *err = nullptr);
+    void cancel();
+    bool isRunning() const { return !m_threads.isEmpty(); }
+    bool isCancelled() const { return m_cancel.load(); }
+
+    // GUI thread: the next block in file order; false while it is still being parsed
+    bool takeNext(Block *out);
+    // every block taken, or cancelled and the workers are done
+    bool atEnd() const;
+    // joins the workers and unmaps the file
+    void finish();
+
+    QString path() const { return m_file.fileName(); }
+    // safe to poll from the GUI
+    qint64 parsedBytes() const { return m_parsedBytes.load(); }
+    qint64 totalBytes() const { return m_size; }
+    qint64 parsedLines() const { return m_parsedLines.load(); }
+
+private:
+    void runWorker();
+    Block parseRange(const char *begin, const char *end, qint64 *lines) const;
+
+    Options m_opt;
+    QFile m_file;
+    const uchar *m_map = nullptr;
+    qint64 m_size = 0;
+    QVector<qint64> m_bounds;          // block i = [m_bounds[i], m_bounds[i + 1])
+
+    QVector<QThread*> m_threads;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<int> m_running{0};     // workers still inside runWorker
+
+    // claim / hand-over, guarded by m_mutex
+    mutable QMutex m_mutex;
+    QWaitCondition m_space;            // a block was taken: workers may run further ahead
+    int m_window = 0;                  // parsed-but-not-taken blocks allowed
+    int m_nextClaim = 0;
+    int m_nextTake = 0;
+    QHash<int, Block> m_ready;
+
+    std::atomic<qint64> m_parsedBytes{0};
+    std::atomic<qint64> m_parsedLines{0};
+};
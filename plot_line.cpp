@@ -0,0 +1,91 @@
+#include "plot_line.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace {
+// compiled once per thread: the importer parses on several threads at once
+const QRegularExpression &channelRe() {
+    static thread_local const QRegularExpression re(R"((?:^|,)\s*CH\s*:\s*([+-]?\d+)\s*(?=,|$))",
+                                                    QRegularExpression::CaseInsensitiveOption);
+    return re;
+}
+
+const QRegularExpression &bracketPointRe() {
+    static thread_local const QRegularExpression re(R"(\[\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*,\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*\])");
+    return re;
+}
+
+const QRegularExpression &leadingPointRe() {
+    static thread_local const QRegularExpression re(R"(^\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*,\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*)");
+    return re;
+}
+
+bool parseDouble(const QString &s, double *out) {
+    bool ok = false;
+    const double v = s.trimmed().toDouble(&ok);
+    if (!ok) return false;
+    if (out) *out = v;
+    return true;
+}
+}
+
+PlotLine parsePlotLine(const QString &line) {
+    PlotLine r;
+    QString s = line.trimmed();
+    if (s.isEmpty()) return r;
+
+    // CH:n anywhere
+    {
+        QRegularExpressionMatch m = channelRe().match(s);
+        if (m.hasMatch()) {
+            r.hasChannel = true;
+            r.channel = m.captured(1).toInt();
+        }
+    }
+
+    // point: [x,y] anywhere, else x,y at beginning
+    int pointStart = -1, pointLen = 0;
+    for (const QRegularExpression *re : {&bracketPointRe(), &leadingPointRe()}) {
+        auto m = re->match(s);
+        if (!m.hasMatch()) continue;
+        double x=0,y=0;
+        if (parseDouble(m.captured(1), &x) && parseDouble(m.captured(2), &y)) {
+            r.hasPoint = true;
+            r.point = QPointF(x,y);
+            pointStart = m.capturedStart(0);
+            pointLen = m.capturedLength(0);
+            break;
+        }
+    }
+
+    // remove point substring to parse remaining key:value safely
+    QString rest = s;
+    if (pointStart >= 0 && pointLen > 0) {
+        rest.remove(pointStart, pointLen);
+    }
+
+    rest = rest.trimmed();
+    while (rest.startsWith(',')) rest.remove(0,1);
+    rest = rest.trimmed();
+
+    if (!rest.isEmpty()) {
+        const QStringList parts = rest.split(',', Qt::SkipEmptyParts);
+        for (const QString &p0 : parts) {
+            const QString p = p0.trimmed();
+            const int colon = p.indexOf(':');
+            // y-only streams: the first bare number is the value
+            if (colon < 0 && !r.hasPoint && !r.hasValue) {
+                r.hasValue = parseDouble(p, &r.value);
+                continue;
+            }
+            if (colon <= 0) continue;
+            const QString key = p.left(colon).trimmed();
+            const QString val = p.mid(colon+1).trimmed();
+            if (key.isEmpty()) continue;
+            r.kv.insert(key, val);
+        }
+    }
+
+    return r;
+}
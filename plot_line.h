@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QMap>
+#include <QPointF>
+#include <QString>
+
+// 绘图页的单行文本语法，实时串口和离线导入共用：
+//   CH:n            任意位置，选择曲线
+//   [x,y] / 行首 x,y 显式点
+//   单独的数字       y-only 数据（取第一个）
+//   key:value       meta
+// 可在任意线程调用（正则每个线程编译一次）。
+struct PlotLine {
+    bool hasPoint = false;
+    QPointF point;
+    bool hasValue = false;     // a bare number (y-only line)
+    double value = 0.0;
+    bool hasChannel = false;
+    int channel = -1;
+    QMap<QString, QString> kv; // key:value
+};
+
+PlotLine parsePlotLine(const QString &line);
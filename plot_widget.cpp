@@ -1,4 +1,8 @@
 #include "plot_widget.h"
+#include "scope_trigger_dialog.h"
+#include "plot_export_dialog.h"
+#include "timestamp_clock.h"
+#include "plot_line.h"
 
 #include <QListWidget>
 #include <QComboBox>
@@ -7,11 +11,15 @@
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QLineEdit>
-#include <QPlainTextEdit>
+#include <QTableView>
+#include <QHeaderView>
 #include <QScrollBar>
 #include <QColorDialog>
-#include <QRegularExpression>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QSignalBlocker>
 #include <QtMath>
+#include <QtNumeric>
 
 // Qt Charts (Qt6: global classes, module Qt::Charts)
 #include <QtCharts/QChartView>
@@ -19,11 +27,47 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
+#include <QtCharts/QLegend>
+#include <QtCharts/QLegendMarker>
+
+#include <cmath>
 
 static QString normKey(const QString &k) { return k.trimmed(); }
 
+// meta curves get channel ids far above anything a CH:n line uses
+static constexpr int kMetaChannelBase = 1 << 24;
+// rolling buffer of a meta key that is not plotted (same as a new curve's default)
+static constexpr int kMetaMaxPoints = 2000;
+
+// scroll / resume: delay of the one-shot frame, whatever the paced interval
+static constexpr int kSoonFrameMs = 16;
+
+// import: GUI time spent merging parsed records per timer tick
+static constexpr int kImportMergeBudgetMs = 12;
+// import: live lines held back while it runs (beyond this they are dropped from the plot)
+static constexpr int kImportHoldMaxLines = 100000;
+// import: a curve that receives file data keeps up to this many samples (the rolling
+// default would leave only the tail of a long log); also the top of the max-points spin box
+static constexpr int kImportMaxPoints = 10000000;
+
+// comboBoxPlotXSource rows
+static CurveBuffer::XMode xModeForIndex(int idx) {
+    switch (idx) {
+    case 1: return CurveBuffer::XMode::Index;
+    case 2: return CurveBuffer::XMode::HostTime;
+    default: return CurveBuffer::XMode::Explicit;
+    }
+}
+static int indexForXMode(CurveBuffer::XMode mode) {
+    switch (mode) {
+    case CurveBuffer::XMode::Index:    return 1;
+    case CurveBuffer::XMode::HostTime: return 2;
+    default:                           return 0;
+    }
+}
+
 PlotWidget::PlotWidget(QWidget *tabRoot, QWidget *parent)
-    : QWidget(parent) {
+    : QWidget(parent), m_tabRoot(tabRoot) {
 
     bindUi(tabRoot);
     initChartIfNeeded();
@@ -42,10 +86,32 @@ PlotWidget::PlotWidget(QWidget *tabRoot, QWidget *parent)
         if (m_fitWindowSpin->value() == 0) m_fitWindowSpin->setValue(200);
     }
     if (m_maxPointsSpin) {
-        m_maxPointsSpin->setRange(100, 2000000);
+        m_maxPointsSpin->setRange(100, kImportMaxPoints);
         if (m_maxPointsSpin->value() == 0) m_maxPointsSpin->setValue(2000);
     }
-    if (m_metaDisplay) m_metaDisplay->setReadOnly(true);
+    if (m_xSourceCombo && m_xSourceCombo->count() == 0) {
+        m_xSourceCombo->addItems({"显式 x,y", "采样序号", "接收时间"});
+        m_xSourceCombo->setCurrentIndex(0);
+    }
+    if (m_columnSepCombo && m_columnSepCombo->count() == 0) {
+        m_columnSepCombo->addItem(",", QChar(','));
+        m_columnSepCombo->addItem(";", QChar(';'));
+        m_columnSepCombo->addItem("Tab", QChar('\t'));
+        m_columnSepCombo->addItem("空格", QChar(' '));
+    }
+    if (m_metaDisplay) {
+        m_metaDisplay->setModel(&m_metaModel);
+        m_metaDisplay->setItemDelegateForColumn(MetaTableModel::ColTrend, new MetaSparklineDelegate(m_metaDisplay));
+        m_metaDisplay->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        m_metaDisplay->setSelectionMode(QAbstractItemView::NoSelection);
+        m_metaDisplay->verticalHeader()->setVisible(false);
+        m_metaDisplay->verticalHeader()->setDefaultSectionSize(20);
+        m_metaDisplay->horizontalHeader()->setStretchLastSection(true);
+        m_metaDisplay->setColumnWidth(MetaTableModel::ColKey, 50);
+        m_metaDisplay->setColumnWidth(MetaTableModel::ColValue, 55);
+        m_metaDisplay->setColumnWidth(MetaTableModel::ColTrend, 56);
+        m_metaDisplay->setColumnWidth(MetaTableModel::ColAge, 40);
+    }
     if (m_scrollBarX) {
         m_scrollBarX->setOrientation(Qt::Horizontal);
         m_scrollBarX->setRange(0, 0);
@@ -79,18 +145,43 @@ PlotWidget::PlotWidget(QWidget *tabRoot, QWidget *parent)
     if (m_maxPointsSpin) connect(m_maxPointsSpin, QOverload<int>::of(&QSpinBox::valueChanged),
                 this, &PlotWidget::onMaxPointsChanged);
 
+    if (m_xSourceCombo) connect(m_xSourceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, &PlotWidget::onXSourceChanged);
+
+    if (m_columnsCheck) connect(m_columnsCheck, &QCheckBox::toggled, this, &PlotWidget::onColumnSettingsChanged);
+    if (m_columnSepCombo) connect(m_columnSepCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, &PlotWidget::onColumnSettingsChanged);
+    if (m_columnXCheck) connect(m_columnXCheck, &QCheckBox::toggled, this, &PlotWidget::onColumnSettingsChanged);
+    onColumnSettingsChanged();
+
     if (m_clearBtn) connect(m_clearBtn, &QPushButton::clicked, this, &PlotWidget::onClearAll);
 
     if (m_metaAddBtn) connect(m_metaAddBtn, &QPushButton::clicked, this, &PlotWidget::onMetaAdd);
     if (m_metaRemoveBtn) connect(m_metaRemoveBtn, &QPushButton::clicked, this, &PlotWidget::onMetaRemove);
+    if (m_metaPlotBtn) connect(m_metaPlotBtn, &QPushButton::clicked, this, &PlotWidget::onMetaPlot);
 
     if (m_scrollBarX) connect(m_scrollBarX, &QScrollBar::valueChanged,
                 this, &PlotWidget::onScrollBarXChanged);
 
-    // render timer (UI throttling)
+    if (m_scopeBtn) connect(m_scopeBtn, &QPushButton::clicked, this, &PlotWidget::onOpenScopeTrigger);
+
+    if (m_exportBtn) connect(m_exportBtn, &QPushButton::clicked, this, &PlotWidget::onOpenExport);
+    connect(&m_exporter, &PlotExporter::finished, this, &PlotWidget::onExportFinished);
+    m_exportTimer.setInterval(100);
+    connect(&m_exportTimer, &QTimer::timeout, this, &PlotWidget::onExportTick);
+
+    if (m_importBtn) connect(m_importBtn, &QPushButton::clicked, this, &PlotWidget::onImport);
+    m_importTimer.setInterval(30);
+    connect(&m_importTimer, &QTimer::timeout, this, &PlotWidget::onImportTick);
+
+    // render timer (UI throttling): interval follows the pacer, stopped while the tab is hidden
     m_renderTimer.setTimerType(Qt::CoarseTimer);
     connect(&m_renderTimer, &QTimer::timeout, this, &PlotWidget::onRenderTick);
-    m_renderTimer.start(33); // ~30 FPS
+    m_soonTimer.setSingleShot(true);
+    connect(&m_soonTimer, &QTimer::timeout, this, &PlotWidget::onRenderTick);
+    if (m_chartView) m_chartView->viewport()->installEventFilter(this);
+    if (m_tabRoot) m_tabRoot->installEventFilter(this);
+    setRenderActive(!m_tabRoot || m_tabRoot->isVisible());
 
     // create a default curve (CH:0) for convenience
     ensureCurveForChannel(0);
@@ -101,6 +192,23 @@ PlotWidget::PlotWidget(QWidget *tabRoot, QWidget *parent)
 
 PlotWidget::~PlotWidget() = default;
 
+bool PlotWidget::eventFilter(QObject *obj, QEvent *ev) {
+    if (obj == m_tabRoot) {
+        if (ev->type() == QEvent::Show) setRenderActive(true);
+        else if (ev->type() == QEvent::Hide) setRenderActive(false);
+    } else if (m_chartView && obj == m_chartView->viewport() && ev->type() == QEvent::Paint && !m_paintTiming) {
+        // the chart paints after onRenderTick returns: time it up to the end of this dispatch
+        m_paintTiming = true;
+        m_paintClock.start();
+        QMetaObject::invokeMethod(this, [this]() {
+            m_paintTiming = false;
+            if (m_frameWorkNs < 0) return;          // repaint without a new frame (resize, hover)
+            frameMeasured(m_frameWorkNs + m_paintClock.nsecsElapsed());
+        }, Qt::QueuedConnection);
+    }
+    return QWidget::eventFilter(obj, ev);
+}
+
 void PlotWidget::bindUi(QWidget *root) {
     if (!root) return;
 
@@ -121,13 +229,21 @@ void PlotWidget::bindUi(QWidget *root) {
     m_showRawPointsCheck = root->findChild<QCheckBox*>("checkBoxPlotShowRawPoints");
     m_fitWindowSpin = root->findChild<QSpinBox*>("spinBoxPlotFitWindow");
     m_maxPointsSpin = root->findChild<QSpinBox*>("spinBoxPlotMaxPoints");
+    m_xSourceCombo = root->findChild<QComboBox*>("comboBoxPlotXSource");
+    m_columnsCheck = root->findChild<QCheckBox*>("checkBoxPlotColumns");
+    m_columnSepCombo = root->findChild<QComboBox*>("comboBoxPlotColumnSep");
+    m_columnXCheck = root->findChild<QCheckBox*>("checkBoxPlotColumnX");
     m_clearBtn = root->findChild<QPushButton*>("pushButtonPlotClear");
 
     m_metaKeyEdit = root->findChild<QLineEdit*>("lineEditPlotMetaKey");
     m_metaAddBtn = root->findChild<QPushButton*>("pushButtonPlotMetaAdd");
     m_metaKeysList = root->findChild<QListWidget*>("listWidgetPlotMetaKeys");
     m_metaRemoveBtn = root->findChild<QPushButton*>("pushButtonPlotMetaRemove");
-    m_metaDisplay = root->findChild<QPlainTextEdit*>("plainTextEditPlotMetaDisplay");
+    m_metaPlotBtn = root->findChild<QPushButton*>("pushButtonPlotMetaPlot");
+    m_metaDisplay = root->findChild<QTableView*>("tableViewPlotMeta");
+    m_scopeBtn = root->findChild<QPushButton*>("pushButtonPlotScope");
+    m_exportBtn = root->findChild<QPushButton*>("pushButtonPlotExport");
+    m_importBtn = root->findChild<QPushButton*>("pushButtonPlotImport");
 }
 
 bool PlotWidget::isUiComplete() const {
@@ -189,13 +305,29 @@ QColor PlotWidget::defaultColorForIndex(int idx) const {
 }
 
 PlotWidget::Curve* PlotWidget::ensureCurveForChannel(int ch) {
-    for (auto &c : m_curves) {
-        if (c.channelId == ch) return &c;
+    if (Curve *existing = m_curves.find(ch)) return existing;
+    return createCurve(ch, QString("CH:%1").arg(ch));
+}
+
+PlotWidget::Curve* PlotWidget::ensureCurveForMetaKey(const QString &key) {
+    MetaSeries &s = m_metaSeries[key];
+    if (s.channel >= 0) {
+        if (Curve *existing = m_curves.find(s.channel)) return existing;
     }
 
+    const int ch = m_curves.firstFreeChannel(kMetaChannelBase);
+    Curve *c = createCurve(ch, key);
+    c->metaKey = key;
+    c->samples = std::move(s.samples);    // HostTime layout, whatever the X source combo says
+    s.samples.clear();
+    s.channel = ch;
+    return c;
+}
+
+PlotWidget::Curve* PlotWidget::createCurve(int ch, const QString &name) {
     Curve c;
     c.channelId = ch;
-    c.name = QString("CH:%1").arg(ch);
+    c.name = name;
     c.color = defaultColorForIndex(m_curves.size());
 
     // initial from UI defaults
@@ -215,6 +347,7 @@ PlotWidget::Curve* PlotWidget::ensureCurveForChannel(int ch) {
     if (m_showRawPointsCheck) c.showRawPointsInFit = m_showRawPointsCheck->isChecked();
     if (m_fitWindowSpin) c.fitWindow = m_fitWindowSpin->value();
     if (m_maxPointsSpin) c.maxPoints = m_maxPointsSpin->value();
+    if (m_xSourceCombo) c.samples.setMode(xModeForIndex(m_xSourceCombo->currentIndex()));
 
     // create series
     if (m_chart && m_axisX && m_axisY) {
@@ -244,27 +377,33 @@ PlotWidget::Curve* PlotWidget::ensureCurveForChannel(int ch) {
         //qDebug() << "SERIES CREATED for" << c.name;
     }
 
-    m_curves.push_back(c);
-    return &m_curves.back();
+    m_curveListStale = true;
+    return m_curves.add(ch, std::make_unique<Curve>(std::move(c)));
 }
 
 PlotWidget::Curve* PlotWidget::activeCurve() {
     if (m_activeCurveIndex < 0 || m_activeCurveIndex >= m_curves.size()) return nullptr;
-    return &m_curves[m_activeCurveIndex];
+    return m_curves.at(m_activeCurveIndex);
 }
 const PlotWidget::Curve* PlotWidget::activeCurve() const {
     if (m_activeCurveIndex < 0 || m_activeCurveIndex >= m_curves.size()) return nullptr;
-    return &m_curves[m_activeCurveIndex];
+    return m_curves.at(m_activeCurveIndex);
 }
 
 void PlotWidget::rebuildCurveListUi() {
     if (!m_curveList || !m_activeCurveCombo) return;
+    m_curveListStale = false;
+
+    // one repaint for the whole list; clear() must not bounce the active curve through index -1
+    const QSignalBlocker blockList(m_curveList);
+    const QSignalBlocker blockCombo(m_activeCurveCombo);
+    m_curveList->setUpdatesEnabled(false);
 
     m_curveList->clear();
     m_activeCurveCombo->clear();
 
     for (int i = 0; i < m_curves.size(); ++i) {
-        const auto &c = m_curves[i];
+        const Curve &c = *m_curves.at(i);
 
         auto *item = new QListWidgetItem(c.name);
         item->setData(Qt::UserRole, i);
@@ -273,6 +412,7 @@ void PlotWidget::rebuildCurveListUi() {
 
         m_activeCurveCombo->addItem(c.name, i);
     }
+    m_curveList->setUpdatesEnabled(true);
 
     if (m_activeCurveIndex >= 0 && m_activeCurveIndex < m_curves.size()) {
         for (int i = 0; i < m_activeCurveCombo->count(); ++i) {
@@ -284,18 +424,52 @@ void PlotWidget::rebuildCurveListUi() {
         if (m_activeCurveIndex < m_curveList->count()) {
             m_curveList->setCurrentRow(m_activeCurveIndex);
         }
-        syncUiFromCurve(m_curves[m_activeCurveIndex]);
+        syncUiFromCurve(*m_curves.at(m_activeCurveIndex));
     } else if (!m_curves.isEmpty()) {
         m_activeCurveIndex = 0;
         m_activeCurveCombo->setCurrentIndex(0);
         m_curveList->setCurrentRow(0);
-        syncUiFromCurve(m_curves[0]);
+        syncUiFromCurve(*m_curves.at(0));
     }
 }
 
+void PlotWidget::appendNewCurvesToListUi() {
+    if (!m_curveList || !m_activeCurveCombo) return;
+    m_curveListStale = false;
+    if (m_curveList->count() > m_curves.size()) {
+        rebuildCurveListUi();
+        return;
+    }
+
+    // new channels only ever append; existing rows and the selection stay put
+    const QSignalBlocker blockList(m_curveList);
+    const QSignalBlocker blockCombo(m_activeCurveCombo);
+    m_curveList->setUpdatesEnabled(false);
+    for (int i = m_curveList->count(); i < m_curves.size(); ++i) {
+        const Curve &c = *m_curves.at(i);
+
+        auto *item = new QListWidgetItem(c.name);
+        item->setData(Qt::UserRole, i);
+        item->setForeground(c.color);
+        m_curveList->addItem(item);
+
+        m_activeCurveCombo->addItem(c.name, i);
+    }
+    m_curveList->setUpdatesEnabled(true);
+}
+
 void PlotWidget::syncUiFromCurve(const Curve &c) {
     if (!isUiComplete()) return;
 
+    // each setter would otherwise apply the half-synced controls back onto the curve
+    // (switching the X source drops the samples)
+    const QSignalBlocker blockRender(m_renderModeCombo);
+    const QSignalBlocker blockFit(m_fitTypeCombo);
+    const QSignalBlocker blockRaw(m_showRawPointsCheck);
+    const QSignalBlocker blockWindow(m_fitWindowSpin);
+    const QSignalBlocker blockMax(m_maxPointsSpin);
+    const QSignalBlocker blockXSource(m_xSourceCombo);
+
     if (m_colorPreview) {
         m_colorPreview->setAutoFillBackground(true);
         QPalette pal = m_colorPreview->palette();
@@ -322,6 +496,10 @@ void PlotWidget::syncUiFromCurve(const Curve &c) {
     if (m_showRawPointsCheck) m_showRawPointsCheck->setChecked(c.showRawPointsInFit);
     if (m_fitWindowSpin) m_fitWindowSpin->setValue(c.fitWindow);
     if (m_maxPointsSpin) m_maxPointsSpin->setValue(c.maxPoints);
+    if (m_xSourceCombo) {
+        m_xSourceCombo->setCurrentIndex(indexForXMode(c.samples.mode()));
+        m_xSourceCombo->setEnabled(c.metaKey.isEmpty());   // meta curves are host-time by nature
+    }
 }
 
 void PlotWidget::applyUiToCurve(Curve &c) {
@@ -345,6 +523,7 @@ void PlotWidget::applyUiToCurve(Curve &c) {
     if (m_showRawPointsCheck) c.showRawPointsInFit = m_showRawPointsCheck->isChecked();
     if (m_fitWindowSpin) c.fitWindow = m_fitWindowSpin->value();
     if (m_maxPointsSpin) c.maxPoints = m_maxPointsSpin->value();
+    if (m_xSourceCombo && c.metaKey.isEmpty()) c.samples.setMode(xModeForIndex(m_xSourceCombo->currentIndex()));
 
     updateStyleForCurve(c);
     updateVisibilityForCurve(c);
@@ -384,17 +563,7 @@ void PlotWidget::updateVisibilityForCurve(Curve &c) {
 }
 
 void PlotWidget::onAddCurve() {
-    int ch = 0;
-    while (true) {
-        bool used = false;
-        for (const auto &c : m_curves) {
-            if (c.channelId == ch) { used = true; break; }
-        }
-        if (!used) break;
-        ++ch;
-    }
-
-    ensureCurveForChannel(ch);
+    ensureCurveForChannel(m_curves.firstFreeChannel());
     m_activeCurveIndex = m_curves.size() - 1;
     rebuildCurveListUi();
     m_dirty = true;
@@ -404,7 +573,7 @@ void PlotWidget::onRemoveCurve() {
     if (m_activeCurveIndex < 0 || m_activeCurveIndex >= m_curves.size()) return;
     if (m_curves.size() == 1) return;
 
-    Curve &c = m_curves[m_activeCurveIndex];
+    Curve &c = *m_curves.at(m_activeCurveIndex);
     if (m_chart) {
         if (c.scatter) m_chart->removeSeries(c.scatter);
         if (c.line) m_chart->removeSeries(c.line);
@@ -414,7 +583,17 @@ void PlotWidget::onRemoveCurve() {
     delete c.line;
     delete c.fitLine;
 
-    m_curves.removeAt(m_activeCurveIndex);
+    // a meta key keeps collecting after its curve is gone
+    if (!c.metaKey.isEmpty()) {
+        auto it = m_metaSeries.find(c.metaKey);
+        if (it != m_metaSeries.end()) {
+            it->samples = std::move(c.samples);
+            it->channel = -1;
+        }
+    }
+
+    m_curves.takeAt(m_activeCurveIndex, c.channelId);
+    m_columnCurves.clear();
     if (m_activeCurveIndex >= m_curves.size()) m_activeCurveIndex = m_curves.size() - 1;
 
     rebuildCurveListUi();
@@ -429,7 +608,7 @@ void PlotWidget::onActiveCurveChanged(int index) {
     m_activeCurveIndex = curveIdx;
 
     if (m_curveList) m_curveList->setCurrentRow(curveIdx);
-    syncUiFromCurve(m_curves[curveIdx]);
+    syncUiFromCurve(*m_curves.at(curveIdx));
 }
 
 void PlotWidget::onCurveListSelectionChanged() {
@@ -445,7 +624,7 @@ void PlotWidget::onCurveListSelectionChanged() {
             break;
         }
     }
-    syncUiFromCurve(m_curves[row]);
+    syncUiFromCurve(*m_curves.at(row));
 }
 
 void PlotWidget::onPickColor() {
@@ -496,16 +675,44 @@ void PlotWidget::onMaxPointsChanged(int) {
     m_dirty = true;
 }
 
+void PlotWidget::onXSourceChanged(int) {
+    Curve *c = activeCurve();
+    if (!c) return;
+    applyUiToCurve(*c);
+    m_pinnedToRight = true;
+    m_dirty = true;
+}
+
+void PlotWidget::onColumnSettingsChanged() {
+    m_columnMode = m_columnsCheck && m_columnsCheck->isChecked();
+
+    ColumnParser::Config cfg;
+    if (m_columnSepCombo && m_columnSepCombo->currentIndex() >= 0)
+        cfg.separator = m_columnSepCombo->currentData().toChar();
+    cfg.firstIsX = !m_columnXCheck || m_columnXCheck->isChecked();
+    m_columnParser.setConfig(cfg);
+
+    if (m_columnSepCombo) m_columnSepCombo->setEnabled(m_columnMode);
+    if (m_columnXCheck) m_columnXCheck->setEnabled(m_columnMode);
+    if (!m_columnMode && m_axisX) m_axisX->setTitleText("X");
+    m_columnCurves.clear();
+}
+
 void PlotWidget::onClearAll() {
     for (auto &c : m_curves) {
-        c.points.clear();
+        c.samples.clear();
         if (c.scatter) c.scatter->clear();
         if (c.line) c.line->clear();
         if (c.fitLine) c.fitLine->clear();
     }
 
-    m_latestMeta.clear();
-    updateMetaDisplay();
+    m_metaModel.clear();
+    // plotted keys keep their curve; the rest start over with the key list
+    for (auto it = m_metaSeries.begin(); it != m_metaSeries.end();) {
+        if (it->channel < 0) it = m_metaSeries.erase(it);
+        else ++it;
+    }
+    m_hostT0Ns = 0;
 
     m_pinnedToRight = true;
     if (m_scrollBarX) {
@@ -515,6 +722,10 @@ void PlotWidget::onClearAll() {
     if (m_axisX) m_axisX->setRange(0, 1);
     if (m_axisY) m_axisY->setRange(0, 1);
 
+    m_scopeFrames.clear();
+    if (m_scopeEnabled) m_scope.arm();
+    updateScopeStatus();
+
     m_dirty = true;
     m_selectedMetaKeys.clear();
     m_seenMetaKeys.clear();
@@ -558,115 +769,79 @@ void PlotWidget::onMetaRemove() {
     updateMetaDisplay();
 }
 
-void PlotWidget::updateMetaDisplay() {
-    if (!m_metaDisplay) return;
+void PlotWidget::onMetaPlot() {
+    if (!m_metaKeysList) return;
 
-    QStringList lines;
-    // 按字母序输出（可选）
-    QStringList keys = QStringList(m_selectedMetaKeys.begin(), m_selectedMetaKeys.end());
-    keys.sort(Qt::CaseInsensitive);
+    const auto items = m_metaKeysList->selectedItems();
+    if (items.isEmpty()) return;
 
-    for (const QString &k : keys) {
-        const QString v = m_latestMeta.value(k, "");
-        lines << QString("%1=%2").arg(k, v);
+    Curve *last = nullptr;
+    for (auto *it : items) {
+        const QString k = it->text().trimmed();
+        if (k.isEmpty() || !m_metaSeries.contains(k)) continue;   // never numeric
+        last = ensureCurveForMetaKey(k);
     }
-    m_metaDisplay->setPlainText(lines.join("\n"));
-}
+    if (!last) return;
 
-void PlotWidget::onScrollBarXChanged(int value) {
-    if (!m_scrollBarX) return;
-    const int maxv = m_scrollBarX->maximum();
-    m_pinnedToRight = (maxv <= 0) ? true : (value >= maxv);
-
-    updateAxesAndScrollbar(false);
+    m_activeCurveIndex = m_curves.indexOf(last->channelId);
+    rebuildCurveListUi();
     m_dirty = true;
 }
 
-static bool parseDouble(const QString &s, double *out) {
-    bool ok = false;
-    const double v = s.trimmed().toDouble(&ok);
-    if (!ok) return false;
-    if (out) *out = v;
-    return true;
-}
-
-PlotWidget::ParsedLine PlotWidget::parseLine(const QString &line) {
-    ParsedLine r;
-    QString s = line.trimmed();
-    if (s.isEmpty()) return r;
+void PlotWidget::appendMetaSample(const QString &key, double value, qint64 tsNs) {
+    const double x = hostSeconds(tsNs);
 
-    // CH:n anywhere
-    {
-        QRegularExpression re(R"((?:^|,)\s*CH\s*:\s*([+-]?\d+)\s*(?=,|$))",
-                              QRegularExpression::CaseInsensitiveOption);
-        QRegularExpressionMatch m = re.match(s);
-        if (m.hasMatch()) {
-            r.hasChannel = true;
-            r.channel = m.captured(1).toInt();
-        }
-    }
-
-    // point: [x,y] anywhere
-    int pointStart = -1, pointLen = 0;
-    {
-        QRegularExpression re(R"(\[\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*,\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*\])");
-        auto m = re.match(s);
-        if (m.hasMatch()) {
-            double x=0,y=0;
-            if (parseDouble(m.captured(1), &x) && parseDouble(m.captured(2), &y)) {
-                r.hasPoint = true;
-                r.point = QPointF(x,y);
-                pointStart = m.capturedStart(0);
-                pointLen = m.capturedLength(0);
-            }
-        }
+    MetaSeries &s = m_metaSeries[key];
+    Curve *curve = s.channel >= 0 ? m_curves.find(s.channel) : nullptr;
+    if (!curve) {
+        appendTrimmed(s.samples, x, value, kMetaMaxPoints);
+        return;
     }
 
-    // fallback: x,y at beginning
-    if (!r.hasPoint) {
-        QRegularExpression re(R"(^\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*,\s*([+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)\s*)");
-        auto m = re.match(s);
-        if (m.hasMatch()) {
-            double x=0,y=0;
-            if (parseDouble(m.captured(1), &x) && parseDouble(m.captured(2), &y)) {
-                r.hasPoint = true;
-                r.point = QPointF(x,y);
-                pointStart = m.capturedStart(0);
-                pointLen = m.capturedLength(0);
-            }
-        }
-    }
+    appendTrimmed(curve->samples, x, value, curve->maxPoints);
+    if (m_scopeEnabled && curve->channelId == m_scopeChannel) feedScope(QPointF(x, value));
+    if (!m_scopeEnabled) m_dirty = true;
+}
 
-    // remove point substring to parse remaining key:value safely
-    QString rest = s;
-    if (pointStart >= 0 && pointLen > 0) {
-        rest.remove(pointStart, pointLen);
-    }
+double PlotWidget::hostSeconds(qint64 tsNs) {
+    if (m_hostT0Ns == 0) m_hostT0Ns = tsNs;
+    return double(tsNs - m_hostT0Ns) / 1e9;
+}
 
-    rest = rest.trimmed();
-    while (rest.startsWith(',')) rest.remove(0,1);
-    rest = rest.trimmed();
+void PlotWidget::updateMetaDisplay() {
+    // rows only change with the selection; values refresh from onRenderTick
+    QStringList keys = QStringList(m_selectedMetaKeys.begin(), m_selectedMetaKeys.end());
+    keys.sort(Qt::CaseInsensitive);
+    m_metaModel.setShownKeys(keys);
+    m_metaModel.flush(TimestampClock::nowNs());
+}
 
-    if (!rest.isEmpty()) {
-        const QStringList parts = rest.split(',', Qt::SkipEmptyParts);
-        for (const QString &p0 : parts) {
-            const QString p = p0.trimmed();
-            const int colon = p.indexOf(':');
-            if (colon <= 0) continue;
-            const QString key = p.left(colon).trimmed();
-            const QString val = p.mid(colon+1).trimmed();
-            if (key.isEmpty()) continue;
-            r.kv.insert(key, val);
-        }
-    }
+void PlotWidget::onScrollBarXChanged(int value) {
+    if (!m_scrollBarX) return;
+    const int maxv = m_scrollBarX->maximum();
+    m_pinnedToRight = (maxv <= 0) ? true : (value >= maxv);
+    if (m_inFrame) return;
 
-    return r;
+    // a drag fires many of these: they all land in one frame
+    m_dirty = true;
+    requestFrameSoon();
 }
 
-void PlotWidget::onSerialLineReceived(const QString &line) {
-    const ParsedLine pl = parseLine(line);
+void PlotWidget::onSerialLineReceived(const QString &line, qint64 tsNs) {
+    if (m_importer.isRunning()) {
+        // live samples would interleave with the file's: replayed after it (finishImport)
+        if (m_importHeld.size() < kImportHoldMaxLines) m_importHeld.push_back({line, tsNs});
+        else ++m_importHeldDropped;
+        return;
+    }
+    if (m_columnMode) {
+        ingestColumnLine(line, tsNs);
+        return;
+    }
+
+    const PlotLine pl = parsePlotLine(line);
 
-    // meta update (global)
+    // meta update (global); the table catches up once per frame
     for (auto it = pl.kv.constBegin(); it != pl.kv.constEnd(); ++it) {
         const QString k = it.key().trimmed();
         const QString v = it.value().trimmed();
@@ -674,7 +849,11 @@ void PlotWidget::onSerialLineReceived(const QString &line) {
         if (k.isEmpty()) continue;
         if (k.compare("CH", Qt::CaseInsensitive) == 0) continue;
 
-        m_latestMeta[k] = v;
+        // parsed once here: the table history and the series share the number
+        bool numeric = false;
+        const double number = v.toDouble(&numeric);
+        m_metaModel.update(k, v, numeric ? &number : nullptr, tsNs);
+        if (numeric) appendMetaSample(k, number, tsNs);
 
         // NEW: first time seen -> add into listWidgetPlotMetaKeys
         if (m_metaKeysList && !m_seenMetaKeys.contains(k)) {
@@ -686,41 +865,189 @@ void PlotWidget::onSerialLineReceived(const QString &line) {
             m_metaKeysList->addItem(item);
         }
     }
-    updateMetaDisplay();
 
-    if (!pl.hasPoint) return;
+    if (!pl.hasPoint && !pl.hasValue) return;
 
     Curve *curve = nullptr;
     if (pl.hasChannel && pl.channel >= 0) {
         curve = ensureCurveForChannel(pl.channel);
     } else {
         curve = activeCurve();
-        if (!curve) curve = ensureCurveForChannel(0);
+        // meta curves are fed by their key only
+        if (!curve || !curve->metaKey.isEmpty()) curve = ensureCurveForChannel(0);
     }
     if (!curve) return;
 
-    curve->points.push_back(pl.point);
+    // implicit X takes the y of an x,y pair as well as a bare value
+    const double y = pl.hasPoint ? pl.point.y() : pl.value;
+    double x = 0.0;     // Index: the buffer numbers the samples itself
+    switch (curve->samples.mode()) {
+    case CurveBuffer::XMode::Explicit:
+        if (!pl.hasPoint) return;
+        x = pl.point.x();
+        break;
+    case CurveBuffer::XMode::Index:
+        break;
+    case CurveBuffer::XMode::HostTime:
+        x = hostSeconds(tsNs);
+        break;
+    }
+    appendTrimmed(curve->samples, x, y, curve->maxPoints);
+    const QPointF p = curve->samples.at(curve->samples.size() - 1);
 
-    const int maxPts = qMax(100, curve->maxPoints);
-    if (curve->points.size() > maxPts) {
-        const int drop = curve->points.size() - maxPts;
-        curve->points.erase(curve->points.begin(), curve->points.begin() + drop);
+    if (m_scopeEnabled && curve->channelId == m_scopeChannel) feedScope(p);
+
+    // list / combo catch up in bulk on the next render tick
+
+    // scope view redraws only when a frame completes (feedScope)
+    if (!m_scopeEnabled) m_dirty = true;
+    //qDebug() << "PLOT LINE" << line;
+}
+
+void PlotWidget::ingestColumnLine(const QString &line, qint64 tsNs) {
+    const ColumnParser::Kind kind = m_columnParser.parse(line, &m_columnValues);
+    if (kind == ColumnParser::Kind::Header) {
+        applyColumnNames(m_columnParser.names());
+        return;
     }
+    if (kind != ColumnParser::Kind::Row) return;
 
-    if (m_activeCurveCombo && m_activeCurveCombo->count() != m_curves.size()) {
-        rebuildCurveListUi();
+    const bool firstIsX = m_columnParser.config().firstIsX;
+    const int first = firstIsX ? 1 : 0;
+    if (firstIsX && (m_columnValues.size() < 2 || qIsNaN(m_columnValues.first()))) return;
+
+    const double rowX = firstIsX ? m_columnValues.first() : 0.0;
+    const double hostX = hostSeconds(tsNs);
+
+    for (int i = first; i < m_columnValues.size(); ++i) {
+        const double y = m_columnValues.at(i);
+        if (qIsNaN(y)) continue;          // empty / non-numeric field
+
+        Curve *curve = columnCurve(i - first);
+        double x = 0.0;
+        switch (curve->samples.mode()) {
+        case CurveBuffer::XMode::Explicit:
+            if (!firstIsX) continue;
+            x = rowX;
+            break;
+        case CurveBuffer::XMode::Index:
+            break;
+        case CurveBuffer::XMode::HostTime:
+            x = hostX;
+            break;
+        }
+        appendTrimmed(curve->samples, x, y, curve->maxPoints);
+
+        if (m_scopeEnabled && curve->channelId == m_scopeChannel)
+            feedScope(curve->samples.at(curve->samples.size() - 1));
     }
 
-    m_dirty = true;
-    //qDebug() << "PLOT LINE" << line;
+    if (!m_scopeEnabled) m_dirty = true;
+}
+
+PlotWidget::Curve* PlotWidget::columnCurve(int col) {
+    if (col < m_columnCurves.size() && m_columnCurves.at(col)) return m_columnCurves.at(col);
+    if (m_columnCurves.size() <= col) m_columnCurves.resize(col + 1);
+
+    Curve *c = ensureCurveForChannel(col);
+    const bool firstIsX = m_columnParser.config().firstIsX;
+
+    // without an X column a fresh explicit curve would never plot anything
+    if (!firstIsX && c->samples.mode() == CurveBuffer::XMode::Explicit && c->samples.isEmpty()) {
+        c->samples.setMode(CurveBuffer::XMode::Index);
+        if (c == activeCurve()) syncUiFromCurve(*c);
+    }
+
+    const QString name = m_columnNames.value(col + (firstIsX ? 1 : 0));
+    if (!name.isEmpty() && c->name != name) {
+        setCurveName(*c, name);
+        m_curveListStale = true;
+        if (m_curveList && m_curves.indexOf(col) < m_curveList->count()) rebuildCurveListUi();
+    }
+
+    m_columnCurves[col] = c;
+    return c;
+}
+
+void PlotWidget::applyColumnNames(const QStringList &names) {
+    m_columnNames = names;
+    const int first = m_columnParser.config().firstIsX ? 1 : 0;
+
+    if (first && m_axisX && !names.first().isEmpty()) m_axisX->setTitleText(names.first());
+    for (int col = 0; col + first < names.size(); ++col) {
+        const QString &name = names.at(col + first);
+        Curve *c = m_curves.find(col);
+        if (c && !name.isEmpty()) setCurveName(*c, name);
+    }
+    rebuildCurveListUi();
+}
+
+void PlotWidget::setCurveName(Curve &c, const QString &name) {
+    c.name = name;
+    if (c.scatter) c.scatter->setName(name + " (pts)");
+    if (c.line) c.line->setName(name);
+    if (c.fitLine) c.fitLine->setName(name + " (fit)");
 }
 
 void PlotWidget::onRenderTick() {
+    if (!m_renderActive) return;
+    // the previous frame drew nothing new: its own work is all it cost
+    if (m_frameWorkNs >= 0 && !m_paintTiming) frameMeasured(m_frameWorkNs);
+
+    if (m_curveListStale) appendNewCurvesToListUi();
+    m_metaModel.flush(TimestampClock::nowNs());
     if (!m_dirty) return;
     m_dirty = false;
+    m_soonTimer.stop();
+
+    QElapsedTimer work;
+    work.start();
+    m_inFrame = true;
+    if (m_scopeEnabled) {
+        updateScopeView();
+    } else {
+        // the view picks the samples to draw, so the axes go first
+        updateAxesAndScrollbar(true);
+        updateSeriesForAllCurves();
+    }
+    m_inFrame = false;
+    m_frameWorkNs = work.nsecsElapsed();
+}
+
+void PlotWidget::frameMeasured(qint64 costNs) {
+    m_frameWorkNs = -1;
+    m_pacer.frameDone(costNs);
+    if (m_renderActive && m_renderTimer.interval() != m_pacer.intervalMs())
+        m_renderTimer.start(m_pacer.intervalMs());
 
-    updateSeriesForAllCurves();
-    updateAxesAndScrollbar(true);
+    if (m_labelRange) {
+        m_labelRange->setToolTip(QString("帧耗时 %1 ms，帧间隔 %2 ms，每条曲线最多 %3 点")
+                                     .arg(m_pacer.costMs(), 0, 'f', 1)
+                                     .arg(m_pacer.intervalMs())
+                                     .arg(m_pacer.pointBudget()));
+    }
+}
+
+void PlotWidget::requestFrameSoon() {
+    if (m_renderActive && !m_soonTimer.isActive()) m_soonTimer.start(kSoonFrameMs);
+}
+
+void PlotWidget::setRenderActive(bool active) {
+    if (active == m_renderActive) return;
+    m_renderActive = active;
+
+    // ingest keeps filling the buffers meanwhile; the first frame back shows it all
+    if (!active) {
+        m_renderTimer.stop();
+        m_soonTimer.stop();
+        m_frameWorkNs = -1;
+        return;
+    }
+    // costs measured before the pause say nothing about now (other load, other data)
+    m_pacer.reset();
+    m_renderTimer.start(m_pacer.intervalMs());
+    m_dirty = true;
+    m_soonTimer.start(0);
 }
 
 static QList<QPointF> toList(const QVector<QPointF> &v) {
@@ -731,15 +1058,24 @@ static QList<QPointF> toList(const QVector<QPointF> &v) {
 }
 
 void PlotWidget::updateSeriesForAllCurves() {
+    // only the samples in view, reduced to the pacer's point budget
+    const int budget = m_pacer.pointBudget();
     for (auto &c : m_curves) {
         if (!c.scatter || !c.line || !c.fitLine) continue;
 
+        int first = 0, last = c.samples.size();
+        if (c.samples.isImplicitX()) {
+            c.samples.indexRange(m_viewXStart, m_viewXEnd, &first, &last);
+            first = qMax(0, first - 1);             // one sample past each edge: lines reach the border
+            last = qMin(c.samples.size(), last + 1);
+        }
+
         if (c.renderMode == RenderMode::Points) {
-            c.scatter->replace(toList(c.points));
+            c.scatter->replace(c.samples.decimated(first, last, budget));
         } else if (c.renderMode == RenderMode::Lines) {
-            c.line->replace(toList(c.points));
+            c.line->replace(c.samples.decimated(first, last, budget));
         } else {
-            if (c.showRawPointsInFit) c.scatter->replace(toList(c.points));
+            if (c.showRawPointsInFit) c.scatter->replace(c.samples.decimated(first, last, budget));
             else c.scatter->clear();
             // fit computed in updateAxesAndScrollbar (needs x-range)
         }
@@ -749,44 +1085,429 @@ void PlotWidget::updateSeriesForAllCurves() {
     }
 }
 
-static void globalMinMaxX_fromPoints(const QVector<QVector<QPointF>> &allPts, double *xmin, double *xmax) {
-    double mn = 0, mx = 0;
-    bool init = false;
-    for (const auto &pts : allPts) {
-        for (const auto &p : pts) {
-            if (!init) { mn = mx = p.x(); init = true; }
-            else { mn = qMin(mn, p.x()); mx = qMax(mx, p.x()); }
+/* --------------------------- export --------------------------- */
+
+void PlotWidget::onOpenExport() {
+    if (!m_exportDialog) {
+        m_exportDialog = new PlotExportDialog(this);
+        connect(m_exportDialog, &PlotExportDialog::startRequested, this, &PlotWidget::onExportStart);
+        connect(m_exportDialog, &PlotExportDialog::cancelRequested, &m_exporter, &PlotExporter::cancel);
+    }
+
+    QList<QPair<int, QString>> curves;
+    double x0 = 0, x1 = 0;
+    bool any = false;
+    for (const auto &c : m_curves) {
+        curves.push_back({c.channelId, c.name});
+        double a = 0, b = 0;
+        if (!c.samples.xRange(&a, &b)) continue;
+        x0 = any ? qMin(x0, a) : a;
+        x1 = any ? qMax(x1, b) : b;
+        any = true;
+    }
+    if (!m_exporter.isRunning()) m_exportDialog->setCurves(curves);
+    m_exportDialog->setRanges(x0, x1, m_viewXStart, m_viewXEnd);
+
+    m_exportDialog->show();
+    m_exportDialog->raise();
+    m_exportDialog->activateWindow();
+}
+
+void PlotWidget::onExportStart() {
+    if (!m_exportDialog || m_exporter.isRunning()) return;
+
+    PlotExporter::Request req;
+    req.path = m_exportDialog->path();
+    req.format = m_exportDialog->format();
+    req.limitX = m_exportDialog->limitX();
+    req.x0 = m_exportDialog->x0();
+    req.x1 = m_exportDialog->x1();
+
+    // snapshot: copies chunk pointers only, ingest keeps appending meanwhile
+    const QList<int> channels = m_exportDialog->selectedChannels();
+    for (int ch : channels) {
+        const Curve *c = m_curves.find(ch);
+        if (c) req.series.push_back({c->name, c->samples});
+    }
+
+    if (req.series.isEmpty()) {
+        m_exportDialog->setStatusText("请至少勾选一条曲线。");
+        return;
+    }
+    if (req.path.isEmpty()) {
+        m_exportDialog->setStatusText("请选择导出文件。");
+        return;
+    }
+
+    m_exporter.start(req);
+    m_exportDialog->setRunning(true);
+    m_exportDialog->setProgress(0, 0);
+    m_exportDialog->setStatusText("导出中…");
+    m_exportTimer.start();
+}
+
+void PlotWidget::onExportTick() {
+    if (m_exportDialog) m_exportDialog->setProgress(m_exporter.doneSamples(), m_exporter.totalSamples());
+}
+
+void PlotWidget::onExportFinished(bool ok, const QString &message) {
+    m_exportTimer.stop();
+    if (!m_exportDialog) return;
+    m_exportDialog->setRunning(false);
+    if (ok) m_exportDialog->setProgress(1, 1);
+    m_exportDialog->setStatusText(message);
+}
+
+/* --------------------------- import --------------------------- */
+
+void PlotWidget::onImport() {
+    if (m_importer.isRunning()) {
+        m_importer.cancel();
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, "导入数据", QString(), "数据 / 会话日志 (*.csv *.txt *.log);;所有文件 (*)");
+    if (path.isEmpty()) return;
+
+    // same grammar as the live stream: the column settings at import start apply to the whole file
+    PlotImporter::Options opt;
+    opt.path = path;
+    opt.columns = m_columnMode;
+    opt.column = m_columnParser.config();
+
+    QString err;
+    if (!m_importer.start(opt, &err)) {
+        emit statusMessage(err, 6000);
+        return;
+    }
+
+    m_importColumns = opt.columns;
+    m_importBlock = PlotImporter::Block();
+    m_importPos = 0;
+    m_importSamples = 0;
+    m_importDropped = 0;
+    m_importHasT0 = false;
+    m_importDay = 0.0;
+    // host-time X continues from the live clock instead of restarting at 0
+    m_importXBase = hostSeconds(TimestampClock::nowNs());
+    m_importLastX = m_importXBase;
+    m_importHeld.clear();
+    m_importHeldDropped = 0;
+    m_importClock.start();
+
+    if (m_importBtn) m_importBtn->setText("取消导入");
+    if (m_columnsCheck) m_columnsCheck->setEnabled(false);
+    if (m_columnSepCombo) m_columnSepCombo->setEnabled(false);
+    if (m_columnXCheck) m_columnXCheck->setEnabled(false);
+    m_pinnedToRight = true;
+    m_importTimer.start();
+}
+
+void PlotWidget::onImportTick() {
+    // merge in file order until the budget is spent; the render tick shows what is in so far
+    QElapsedTimer budget;
+    budget.start();
+    bool merged = false;
+    while (!m_importer.isCancelled() && budget.elapsed() < kImportMergeBudgetMs) {
+        if (m_importPos >= m_importBlock.records.size()) {
+            if (!m_importer.takeNext(&m_importBlock)) break;
+            m_importPos = 0;
         }
+        const int end = qMin(int(m_importBlock.records.size()), m_importPos + 4096);
+        for (; m_importPos < end; ++m_importPos) mergeImportRecord(m_importBlock.records.at(m_importPos));
+        merged = true;
+    }
+    if (merged && !m_scopeEnabled) m_dirty = true;
+
+    const double secs = qMax(1e-3, double(m_importClock.elapsed()) / 1000.0);
+    const qint64 total = m_importer.totalBytes();
+    emit statusMessage(QString("导入 %1：%2%，%3 行，%4 行/s")
+                           .arg(QFileInfo(m_importer.path()).fileName())
+                           .arg(total > 0 ? m_importer.parsedBytes() * 100 / total : 0)
+                           .arg(m_importer.parsedLines())
+                           .arg(qint64(double(m_importer.parsedLines()) / secs)));
+
+    if (m_importer.atEnd() && (m_importer.isCancelled() || m_importPos >= m_importBlock.records.size()))
+        finishImport();
+}
+
+void PlotWidget::mergeImportRecord(const PlotImporter::Record &r) {
+    if (r.kind == PlotImporter::Record::Kind::Header) {
+        applyColumnNames(m_importBlock.headers.at(r.channel));
+        return;
+    }
+
+    Curve *curve = nullptr;
+    if (m_importColumns) {
+        curve = columnCurve(r.channel);
+    } else if (r.channel >= 0) {
+        curve = ensureCurveForChannel(r.channel);
+    } else {
+        curve = activeCurve();
+        if (!curve || !curve->metaKey.isEmpty()) curve = ensureCurveForChannel(0);
+    }
+    if (!curve) return;
+
+    double x = 0.0;
+    switch (curve->samples.mode()) {
+    case CurveBuffer::XMode::Explicit:
+        if (r.kind != PlotImporter::Record::Kind::Point) return;
+        x = r.x;
+        break;
+    case CurveBuffer::XMode::Index:
+        break;
+    case CurveBuffer::XMode::HostTime:
+        // only capture files carry a receive time
+        if (!r.hasTime) return;
+        x = importSeconds(r.t);
+        m_importLastX = qMax(m_importLastX, x);
+        break;
+    }
+    // the file is kept whole up to kImportMaxPoints; beyond that the oldest samples go, counted
+    if (curve->maxPoints < kImportMaxPoints) curve->maxPoints = kImportMaxPoints;
+    if (curve->samples.size() >= curve->maxPoints) ++m_importDropped;
+    appendTrimmed(curve->samples, x, r.y, curve->maxPoints);
+    ++m_importSamples;
+
+    if (m_scopeEnabled && curve->channelId == m_scopeChannel)
+        feedScope(curve->samples.at(curve->samples.size() - 1));
+}
+
+double PlotWidget::importSeconds(double t) {
+    if (!m_importHasT0) {
+        m_importHasT0 = true;
+        m_importT0 = t;
+        m_importPrevT = t;
+    }
+    // log stamps are time of day: a large step back means midnight passed
+    if (t < m_importPrevT - 43200.0) m_importDay += 86400.0;
+    m_importPrevT = t;
+    return m_importXBase + t + m_importDay - m_importT0;
+}
+
+void PlotWidget::finishImport() {
+    m_importTimer.stop();
+    const bool cancelled = m_importer.isCancelled();
+    const qint64 lines = m_importer.parsedLines();
+    const QString name = QFileInfo(m_importer.path()).fileName();
+    m_importer.finish();
+    m_importBlock = PlotImporter::Block();
+    m_importPos = 0;
+
+    if (m_importBtn) m_importBtn->setText("导入…");
+    if (m_columnsCheck) m_columnsCheck->setEnabled(true);
+    if (m_columnSepCombo) m_columnSepCombo->setEnabled(m_columnMode);
+    if (m_columnXCheck) m_columnXCheck->setEnabled(m_columnMode);
+
+    // live host-time X resumes past the imported span, then the held lines go in behind it
+    const QVector<HeldLine> held = std::move(m_importHeld);
+    m_importHeld.clear();
+    const double liveX = hostSeconds(held.isEmpty() ? TimestampClock::nowNs() : held.first().tsNs);
+    if (m_importLastX > liveX) m_hostT0Ns -= qint64(std::ceil((m_importLastX - liveX) * 1e9));
+    for (const HeldLine &h : held) onSerialLineReceived(h.line, h.tsNs);
+
+    const double secs = double(m_importClock.elapsed()) / 1000.0;
+    QString text = cancelled
+                       ? QString("导入已取消：%1（已并入 %2 个采样）").arg(name).arg(m_importSamples)
+                       : QString("导入完成：%1，%2 行，%3 个采样，用时 %4 s")
+                             .arg(name).arg(lines).arg(m_importSamples).arg(secs, 0, 'f', 1);
+    if (m_importDropped > 0)
+        text += QString("；超出每条曲线 %1 点上限，最早的 %2 个采样已丢弃").arg(kImportMaxPoints).arg(m_importDropped);
+    if (m_importHeldDropped > 0) text += QString("；导入期间丢弃实时行 %1").arg(m_importHeldDropped);
+    // imported curves keep the raised buffer size: show it on the active one
+    if (const Curve *c = activeCurve()) syncUiFromCurve(*c);
+    emit statusMessage(text, 8000);
+    m_dirty = true;
+}
+
+/* --------------------------- */
+
+void PlotWidget::onOpenScopeTrigger() {
+    if (!m_scopeDialog) {
+        m_scopeDialog = new ScopeTriggerDialog(this);
+        connect(m_scopeDialog, &ScopeTriggerDialog::settingsChanged, this, &PlotWidget::onScopeSettingsChanged);
+        connect(m_scopeDialog, &ScopeTriggerDialog::rearmRequested, this, &PlotWidget::onScopeRearm);
+        updateScopeStatus();
+    }
+    m_scopeDialog->show();
+    m_scopeDialog->raise();
+    m_scopeDialog->activateWindow();
+}
+
+void PlotWidget::onScopeSettingsChanged() {
+    if (!m_scopeDialog) return;
+
+    const bool enable = m_scopeDialog->isTriggerEnabled();
+    m_scopeChannel = m_scopeDialog->channel();
+    m_scopeOverlay = m_scopeDialog->overlayFrames();
+
+    // any change restarts acquisition; old frames no longer match the settings
+    m_scopeFrames.clear();
+    m_scope.setConfig(m_scopeDialog->config());
+
+    if (enable) {
+        m_scope.arm();
+    } else {
+        m_scope.stop();
+        if (m_scopeEnabled) leaveScopeView();
     }
-    if (!init) { mn = 0; mx = 1; }
-    if (xmin) *xmin = mn;
-    if (xmax) *xmax = mx;
+    m_scopeEnabled = enable;
+
+    updateScopeStatus();
+    m_dirty = true;
+}
+
+void PlotWidget::onScopeRearm() {
+    if (!m_scopeEnabled) return;
+    m_scope.arm();
+    updateScopeStatus();
 }
 
-static void minMaxYInXRange_fromPoints(const QVector<QVector<QPointF>> &allPts, double x0, double x1, double *ymin, double *ymax) {
-    double mn = 0, mx = 0;
+void PlotWidget::feedScope(const QPointF &p) {
+    ScopeTrigger::Frame frame;
+    if (!m_scope.feed(p, &frame)) return;
+
+    m_scopeFrames.push_back(std::move(frame));
+    const int keep = qMax(1, m_scopeOverlay);
+    if (m_scopeFrames.size() > keep) m_scopeFrames.remove(0, m_scopeFrames.size() - keep);
+
+    updateScopeStatus();
+    m_dirty = true;
+}
+
+void PlotWidget::updateScopeStatus() {
+    if (!m_scopeDialog) return;
+
+    QString state;
+    switch (m_scope.state()) {
+    case ScopeTrigger::State::Idle:       state = "未启用"; break;
+    case ScopeTrigger::State::Armed:      state = "等待触发"; break;
+    case ScopeTrigger::State::Collecting: state = "采集中"; break;
+    case ScopeTrigger::State::Done:       state = "已捕获（单次）"; break;
+    }
+    m_scopeDialog->setStatusText(QString("%1 · 已触发 %2 帧").arg(state).arg(m_scope.frameCount()));
+}
+
+void PlotWidget::updateScopeView() {
+    if (!m_chart || !m_axisX || !m_axisY) return;
+
+    // the scope owns the chart while enabled
+    for (auto &c : m_curves) {
+        if (c.scatter) c.scatter->setVisible(false);
+        if (c.line) c.line->setVisible(false);
+        if (c.fitLine) c.fitLine->setVisible(false);
+    }
+
+    const Curve *scopeCurve = m_curves.find(m_scopeChannel);
+    const QColor color = scopeCurve ? scopeCurve->color : defaultColorForIndex(0);
+
+    const int overlay = qMax(1, m_scopeOverlay);
+    while (m_scopeSeries.size() > overlay) {
+        QLineSeries *s = m_scopeSeries.takeLast();
+        m_chart->removeSeries(s);
+        delete s;
+    }
+    while (m_scopeSeries.size() < overlay) {
+        auto *s = new QLineSeries();
+        m_chart->addSeries(s);
+        s->attachAxis(m_axisX);
+        s->attachAxis(m_axisY);
+        m_scopeSeries.push_back(s);
+    }
+    if (!m_scopeLevelLine) {
+        m_scopeLevelLine = new QLineSeries();
+        m_scopeLevelLine->setName("Trigger");
+        m_chart->addSeries(m_scopeLevelLine);
+        m_scopeLevelLine->attachAxis(m_axisX);
+        m_scopeLevelLine->attachAxis(m_axisY);
+        QPen pen(QColor(160, 160, 160));
+        pen.setStyle(Qt::DashLine);
+        m_scopeLevelLine->setPen(pen);
+    }
+
+    const ScopeTrigger::Config &cfg = m_scope.config();
+    double x0 = 0, x1 = 1, y0 = cfg.level, y1 = cfg.level;
     bool init = false;
-    for (const auto &pts : allPts) {
+
+    // oldest frame first, newest drawn last and fully opaque
+    const int n = m_scopeFrames.size();
+    for (int i = 0; i < overlay; ++i) {
+        QLineSeries *s = m_scopeSeries[i];
+        const int idx = n - overlay + i;
+        const bool newest = (i == overlay - 1);
+
+        QColor col = color;
+        col.setAlpha(newest ? 255 : qMax(50, 200 * (i + 1) / overlay));
+        QPen pen(col);
+        pen.setWidthF(newest ? 1.6 : 1.0);
+        s->setPen(pen);
+        s->setName(newest ? QString("CH:%1 (trig)").arg(m_scopeChannel) : QString());
+        const auto markers = m_chart->legend()->markers(s);
+        for (auto *mk : markers) mk->setVisible(newest);
+
+        if (idx < 0) {
+            s->clear();
+            continue;
+        }
+        const auto &pts = m_scopeFrames[idx].points;
+        s->replace(toList(pts));
         for (const auto &p : pts) {
-            if (p.x() < x0 || p.x() > x1) continue;
-            if (!init) { mn = mx = p.y(); init = true; }
-            else { mn = qMin(mn, p.y()); mx = qMax(mx, p.y()); }
+            if (!init) { x0 = x1 = p.x(); init = true; }
+            x0 = qMin(x0, p.x()); x1 = qMax(x1, p.x());
+            y0 = qMin(y0, p.y()); y1 = qMax(y1, p.y());
         }
     }
-    if (!init) { mn = 0; mx = 1; }
-    if (ymin) *ymin = mn;
-    if (ymax) *ymax = mx;
+
+    if (x1 - x0 < 1e-12) x1 = x0 + 1.0;
+    double ySpan = y1 - y0;
+    if (ySpan <= 1e-12) ySpan = 1.0;
+    const double pad = ySpan * 0.08;
+
+    m_axisX->setRange(x0, x1);
+    m_axisY->setRange(y0 - pad, y1 + pad);
+    m_scopeLevelLine->replace(QList<QPointF>{QPointF(x0, cfg.level), QPointF(x1, cfg.level)});
+
+    if (m_scrollBarX) {
+        m_scrollBarX->setRange(0, 0);
+        m_scrollBarX->setValue(0);
+    }
+    if (m_labelRange) {
+        if (n == 0) m_labelRange->setText("等待触发…");
+        else m_labelRange->setText(QString("Trig @%1").arg(m_scopeFrames.last().triggerX, 0, 'g', 6)
+                                   + (m_scopeFrames.last().forced ? " (auto)" : ""));
+    }
 }
 
+void PlotWidget::leaveScopeView() {
+    if (m_chart) {
+        for (QLineSeries *s : m_scopeSeries) m_chart->removeSeries(s);
+        if (m_scopeLevelLine) m_chart->removeSeries(m_scopeLevelLine);
+    }
+    qDeleteAll(m_scopeSeries);
+    m_scopeSeries.clear();
+    delete m_scopeLevelLine;
+    m_scopeLevelLine = nullptr;
+
+    for (auto &c : m_curves) updateVisibilityForCurve(c);
+    m_pinnedToRight = true;
+    m_dirty = true;
+}
+
+/* --------------------------- */
+
 void PlotWidget::updateAxesAndScrollbar(bool keepRightIfPinned) {
     if (!m_axisX || !m_axisY || !m_scrollBarX) return;
 
-    QVector<QVector<QPointF>> allPts;
-    allPts.reserve(m_curves.size());
+    // implicit-X curves answer from their first / last sample
+    double gx0=0, gx1=1;
     bool any = false;
     for (const auto &c : m_curves) {
-        allPts.push_back(c.points);
-        if (!c.points.isEmpty()) any = true;
+        double a = 0, b = 0;
+        if (!c.samples.xRange(&a, &b)) continue;
+        gx0 = any ? qMin(gx0, a) : a;
+        gx1 = any ? qMax(gx1, b) : b;
+        any = true;
     }
 
     if (!any) {
@@ -798,8 +1519,6 @@ void PlotWidget::updateAxesAndScrollbar(bool keepRightIfPinned) {
         return;
     }
 
-    double gx0=0, gx1=1;
-    globalMinMaxX_fromPoints(allPts, &gx0, &gx1);
     double gSpan = gx1 - gx0;
     if (gSpan <= 0) gSpan = 1.0;
 
@@ -833,8 +1552,16 @@ void PlotWidget::updateAxesAndScrollbar(bool keepRightIfPinned) {
     m_viewXStart = start;
     m_viewXEnd = end;
 
+    // ... and only touch the samples inside the view
     double y0=0,y1=1;
-    minMaxYInXRange_fromPoints(allPts, m_viewXStart, m_viewXEnd, &y0, &y1);
+    bool anyY = false;
+    for (const auto &c : m_curves) {
+        double a = 0, b = 0;
+        if (!c.samples.yRangeIn(m_viewXStart, m_viewXEnd, &a, &b)) continue;
+        y0 = anyY ? qMin(y0, a) : a;
+        y1 = anyY ? qMax(y1, b) : b;
+        anyY = true;
+    }
     double ySpan = y1 - y0;
     if (ySpan <= 1e-12) ySpan = 1.0;
     const double pad = ySpan * 0.08;
@@ -860,14 +1587,13 @@ void PlotWidget::updateAxesAndScrollbar(bool keepRightIfPinned) {
     }
 }
 
-QVector<QPointF> PlotWidget::lastNPoints(const QVector<QPointF> &pts, int n) {
-    if (n <= 0 || pts.isEmpty()) return {};
-    if (pts.size() <= n) return pts;
-    return pts.mid(pts.size() - n);
+void PlotWidget::appendTrimmed(CurveBuffer &buf, double x, double y, int maxPoints) {
+    buf.append(x, y);
+    buf.keepLast(qMax(100, maxPoints));
 }
 
 QVector<QPointF> PlotWidget::computeFitCurve(const Curve &c, double xMin, double xMax, int samples) const {
-    QVector<QPointF> window = lastNPoints(c.points, qMax(20, c.fitWindow));
+    QVector<QPointF> window = c.samples.lastPoints(qMax(20, c.fitWindow));
     if (window.size() < 20) return {};
 
     QVector<QPointF> inRange;
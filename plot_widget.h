@@ -2,13 +2,24 @@
 
 #include <QWidget>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QMap>
 #include <QSet>
+#include <QHash>
 #include <QVector>
 #include <QColor>
 #include <QPointF>
 #include <QString>
 
+#include "scope_trigger.h"
+#include "channel_registry.h"
+#include "curve_buffer.h"
+#include "column_parser.h"
+#include "plot_export.h"
+#include "plot_import.h"
+#include "frame_pacer.h"
+#include "meta_table_model.h"
+
 class QListWidget;
 class QComboBox;
 class QPushButton;
@@ -16,8 +27,10 @@ class QLabel;
 class QCheckBox;
 class QSpinBox;
 class QLineEdit;
-class QPlainTextEdit;
+class QTableView;
 class QScrollBar;
+class ScopeTriggerDialog;
+class PlotExportDialog;
 
 // Qt Charts forward declarations (Qt6: in global namespace)
 class QChartView;
@@ -32,9 +45,17 @@ public:
     explicit PlotWidget(QWidget *tabRoot, QWidget *parent = nullptr);
     ~PlotWidget() override;
 
+protected:
+    // tab show / hide (pause rendering), chart paints (frame cost)
+    bool eventFilter(QObject *obj, QEvent *ev) override;
+
 public slots:
-    // from SerialTerminalWidget (shared serial): one full line (no trailing newline)
-    void onSerialLineReceived(const QString &line);
+    // from SerialTerminalWidget (shared serial): one full line (no trailing newline),
+    // tsNs = CLOCK_MONOTONIC stamp taken by the reader when the line arrived
+    void onSerialLineReceived(const QString &line, qint64 tsNs);
+
+signals:
+    void statusMessage(const QString &msg, int timeoutMs = 0);
 
 private slots:
     void onAddCurve();
@@ -48,23 +69,39 @@ private slots:
     void onShowRawPointsToggled(bool);
     void onFitWindowChanged(int);
     void onMaxPointsChanged(int);
+    void onXSourceChanged(int);
+    void onColumnSettingsChanged();
 
     void onClearAll();
 
     void onMetaAdd();
     void onMetaRemove();
+    void onMetaPlot();
 
     void onScrollBarXChanged(int value);
 
     void onRenderTick();
 
+    void onOpenScopeTrigger();
+    void onScopeSettingsChanged();
+    void onScopeRearm();
+
+    void onOpenExport();
+    void onExportStart();
+    void onExportTick();
+    void onExportFinished(bool ok, const QString &message);
+
+    void onImport();
+    void onImportTick();
+
 private:
     enum class RenderMode { Points, Lines, Fit };
     enum class FitType { None, Sine, Triangle, Square };
 
     struct Curve {
-        int channelId = -1;                // CH:n
+        int channelId = -1;                // CH:n (meta curves: synthetic id >= kMetaChannelBase)
         QString name;                      // display name
+        QString metaKey;                   // non-empty: samples come from this meta key
         QColor color;
 
         RenderMode renderMode = RenderMode::Lines;
@@ -74,7 +111,7 @@ private:
         int fitWindow = 200;               // last N points
         int maxPoints = 2000;              // rolling buffer
 
-        QVector<QPointF> points;
+        CurveBuffer samples;               // layout follows the X source
 
         // series
         QScatterSeries *scatter = nullptr;
@@ -86,27 +123,29 @@ private:
     bool isUiComplete() const;
 
     // curves
+    Curve* createCurve(int ch, const QString &name);
     Curve* ensureCurveForChannel(int ch);
+    Curve* ensureCurveForMetaKey(const QString &key);
     Curve* activeCurve();
     const Curve* activeCurve() const;
     void rebuildCurveListUi();
+    void appendNewCurvesToListUi();   // channels discovered since the last render tick
     void syncUiFromCurve(const Curve &c);
     void applyUiToCurve(Curve &c);
 
     QColor defaultColorForIndex(int idx) const;
 
-    // parsing
-    struct ParsedLine {
-        bool hasPoint = false;
-        QPointF point;
-        bool hasChannel = false;
-        int channel = -1;
-        QMap<QString, QString> kv; // key:value
-    };
-    static ParsedLine parseLine(const QString &line);
+    // column mode: one line -> one sample on every column's curve (value column i = CH:i)
+    void ingestColumnLine(const QString &line, qint64 tsNs);
+    Curve* columnCurve(int col);
+    void applyColumnNames(const QStringList &names);
+    void setCurveName(Curve &c, const QString &name);
 
     // chart
     void initChartIfNeeded();
+    void setRenderActive(bool active);
+    void requestFrameSoon();
+    void frameMeasured(qint64 costNs);
     void updateSeriesForAllCurves();
     void updateVisibilityForCurve(Curve &c);
     void updateStyleForCurve(Curve &c);
@@ -118,10 +157,24 @@ private:
     QVector<QPointF> fitTriangle(const QVector<QPointF> &pts, double xMin, double xMax, int samples) const;
     QVector<QPointF> fitSquare(const QVector<QPointF> &pts, double xMin, double xMax, int samples) const;
 
-    static QVector<QPointF> lastNPoints(const QVector<QPointF> &pts, int n);
+    static void appendTrimmed(CurveBuffer &buf, double x, double y, int maxPoints);
+
+    // import: merges parsed blocks in file order
+    void mergeImportRecord(const PlotImporter::Record &r);
+    double importSeconds(double t);
+    void finishImport();
 
     // meta
     void updateMetaDisplay();
+    void appendMetaSample(const QString &key, double value, qint64 tsNs);
+    // host-time X (meta series, HostTime curves): seconds since the first stamped sample
+    double hostSeconds(qint64 tsNs);
+
+    // scope trigger
+    void feedScope(const QPointF &p);
+    void updateScopeView();
+    void leaveScopeView();
+    void updateScopeStatus();
 
 private:
     // UI pointers
@@ -142,26 +195,43 @@ private:
     QCheckBox *m_showRawPointsCheck = nullptr;
     QSpinBox *m_fitWindowSpin = nullptr;
     QSpinBox *m_maxPointsSpin = nullptr;
+    QComboBox *m_xSourceCombo = nullptr;   // optional
+    QCheckBox *m_columnsCheck = nullptr;   // optional (column mode)
+    QComboBox *m_columnSepCombo = nullptr;
+    QCheckBox *m_columnXCheck = nullptr;
     QPushButton *m_clearBtn = nullptr;
 
     QLineEdit *m_metaKeyEdit = nullptr;
     QPushButton *m_metaAddBtn = nullptr;
     QListWidget *m_metaKeysList = nullptr;
     QPushButton *m_metaRemoveBtn = nullptr;
-    QPlainTextEdit *m_metaDisplay = nullptr;
+    QPushButton *m_metaPlotBtn = nullptr;  // optional
+    QTableView *m_metaDisplay = nullptr;
+    QPushButton *m_scopeBtn = nullptr;     // optional
+    QPushButton *m_exportBtn = nullptr;    // optional
+    QPushButton *m_importBtn = nullptr;    // optional
 
     // chart objects
     QChart *m_chart = nullptr;
     QValueAxis *m_axisX = nullptr;
     QValueAxis *m_axisY = nullptr;
 
-    // data
-    QVector<Curve> m_curves;
+    // data: stable per-curve storage, O(1) channel lookup
+    ChannelRegistry<Curve> m_curves;
     int m_activeCurveIndex = -1;
+    bool m_curveListStale = false;    // new channels not yet in the list / combo
 
-    // rendering control
+    // rendering control: frames only while the tab is visible, paced by measured cost
+    QWidget *m_tabRoot = nullptr;
     QTimer m_renderTimer;
+    QTimer m_soonTimer;               // one-shot frame request (scroll, tab shown); coalesces
+    FramePacer m_pacer;
     bool m_dirty = false;
+    bool m_renderActive = false;
+    bool m_inFrame = false;           // scrollbar changes made by the frame itself
+    qint64 m_frameWorkNs = -1;        // last frame's own work, waiting for its paint (-1 = none)
+    bool m_paintTiming = false;
+    QElapsedTimer m_paintClock;
 
     // scrollbar mapping
     bool m_pinnedToRight = true;  // user at right edge => auto follow latest
@@ -171,6 +241,62 @@ private:
 
     // meta selected keys and latest values (global)
     QSet<QString> m_selectedMetaKeys;
-    QMap<QString, QString> m_latestMeta;
+    MetaTableModel m_metaModel;       // latest values + history, refreshed once per frame
     QSet<QString> m_seenMetaKeys;   // NEW: all keys ever seen from serial
+
+    // numeric meta keys as time series: x = host receive time, y = value.
+    // Until a key is plotted its samples live here; plotting moves them into the curve and
+    // later samples append to the curve directly, so a key is never stored twice.
+    struct MetaSeries {
+        MetaSeries() { samples.setMode(CurveBuffer::XMode::HostTime); }
+        CurveBuffer samples;          // only while not plotted
+        int channel = -1;             // curve channel once plotted
+    };
+    QHash<QString, MetaSeries> m_metaSeries;
+
+    qint64 m_hostT0Ns = 0;            // host-time X origin, reset by Clear
+
+    // column mode
+    bool m_columnMode = false;
+    ColumnParser m_columnParser;
+    QVector<double> m_columnValues;   // scratch row, reused per line
+    QVector<Curve*> m_columnCurves;   // value column -> curve, dropped when curves go away
+    QStringList m_columnNames;        // last header row
+
+    // scope trigger: detection runs per ingested sample, the chart only redraws on new frames
+    ScopeTriggerDialog *m_scopeDialog = nullptr;
+    ScopeTrigger m_scope;
+    bool m_scopeEnabled = false;
+    int m_scopeChannel = 0;
+    int m_scopeOverlay = 1;
+    QVector<ScopeTrigger::Frame> m_scopeFrames;     // newest last
+    QVector<QLineSeries*> m_scopeSeries;            // one per overlaid frame
+    QLineSeries *m_scopeLevelLine = nullptr;
+
+    // export: streams snapshots of the curve buffers on a worker thread
+    PlotExportDialog *m_exportDialog = nullptr;
+    PlotExporter m_exporter;
+    QTimer m_exportTimer;             // progress polling while an export runs
+
+    // import: workers parse blocks ahead, the timer merges them in order under a time budget
+    PlotImporter m_importer;
+    QTimer m_importTimer;
+    QElapsedTimer m_importClock;
+    bool m_importColumns = false;     // column mode at import start
+    PlotImporter::Block m_importBlock;
+    int m_importPos = 0;              // next record of m_importBlock
+    qint64 m_importSamples = 0;
+    qint64 m_importDropped = 0;       // evicted by the per-curve import cap
+    bool m_importHasT0 = false;       // capture files: receive time of the first sample
+    double m_importT0 = 0.0;
+    double m_importPrevT = 0.0;
+    double m_importDay = 0.0;         // += 86400 each time the stamps wrap past midnight
+    double m_importXBase = 0.0;       // host-time X of the first imported stamp (live clock at start)
+    double m_importLastX = 0.0;
+    struct HeldLine {
+        QString line;
+        qint64 tsNs = 0;
+    };
+    QVector<HeldLine> m_importHeld;   // live lines that arrived during the import
+    qint64 m_importHeldDropped = 0;
 };
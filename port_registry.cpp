@@ -0,0 +1,135 @@
+#include "port_registry.h"
+
+#include <QCoreApplication>
+#include <QSerialPortInfo>
+#include <QThread>
+#include <QSet>
+
+#include <algorithm>
+
+namespace {
+constexpr int kDebounceMs = 300;
+constexpr int kPollMs = 2000;
+
+QVector<PortRegistry::Port> scanPorts() {
+    QVector<PortRegistry::Port> out;
+    const auto infos = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : infos) {
+        const QString sys = info.systemLocation();
+        if (!PortRegistry::acceptPath(sys)) continue;
+
+        PortRegistry::Port p;
+        p.path = sys;
+        p.description = info.description();
+        p.manufacturer = info.manufacturer();
+        p.serialNumber = info.serialNumber();
+        if (info.hasVendorIdentifier()) p.vid = info.vendorIdentifier();
+        if (info.hasProductIdentifier()) p.pid = info.productIdentifier();
+        out.push_back(p);
+    }
+    std::sort(out.begin(), out.end(), [](const PortRegistry::Port &a, const PortRegistry::Port &b) {
+        return a.path < b.path;
+    });
+    return out;
+}
+}
+
+QString PortRegistry::Port::label() const {
+    return QString("%1  (%2)").arg(path, description.isEmpty() ? QString("No description") : description);
+}
+
+PortRegistry *PortRegistry::instance() {
+    static PortRegistry *registry = new PortRegistry(QCoreApplication::instance());
+    return registry;
+}
+
+PortRegistry::PortRegistry(QObject *parent)
+    : QObject(parent) {
+
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(kDebounceMs);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &PortRegistry::rescan);
+
+    if (m_watcher.addPath("/dev")) {
+        connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            m_debounceTimer.start();
+        });
+    } else {
+        m_pollTimer.setTimerType(Qt::VeryCoarseTimer);
+        connect(&m_pollTimer, &QTimer::timeout, this, &PortRegistry::rescan);
+        m_pollTimer.start(kPollMs);
+    }
+
+    rescan();
+}
+
+PortRegistry::~PortRegistry() {
+    if (!m_thread) return;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool PortRegistry::acceptPath(const QString &path) {
+#if defined(Q_OS_MAC)
+    if (!path.startsWith("/dev/cu.")) return false;
+    if (path.contains("debug-console", Qt::CaseInsensitive)) return false;
+    if (path.contains("Bluetooth-Incoming-Port", Qt::CaseInsensitive)) return false;
+    return true;
+#elif defined(Q_OS_LINUX)
+    // on-board ttyS* exist whether or not anything is attached
+    return path.startsWith("/dev/ttyUSB") || path.startsWith("/dev/ttyACM");
+#else
+    return !path.isEmpty();
+#endif
+}
+
+int PortRegistry::preferredIndex(const QVector<Port> &ports) {
+    static const char *const kHints[] = { "usbserial", "wch", "slab", "usbmodem", "ttyUSB", "ttyACM" };
+    for (int i = 0; i < ports.size(); ++i) {
+        for (const char *hint : kHints) {
+            if (ports.at(i).path.contains(QLatin1String(hint), Qt::CaseInsensitive)) return i;
+        }
+    }
+    return ports.isEmpty() ? -1 : 0;
+}
+
+void PortRegistry::rescan() {
+    if (m_thread) {
+        m_rescanPending = true;
+        return;
+    }
+    m_rescanPending = false;
+
+    m_thread = QThread::create([this]() {
+        const QVector<Port> ports = scanPorts();
+        QMetaObject::invokeMethod(this, [this, ports]() { onScanDone(ports); }, Qt::QueuedConnection);
+    });
+    m_thread->setObjectName("PortScan");
+    m_thread->start();
+}
+
+void PortRegistry::onScanDone(const QVector<Port> &ports) {
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    QSet<QString> before, after;
+    for (const Port &p : m_ports) before.insert(p.path);
+    for (const Port &p : ports) after.insert(p.path);
+
+    QStringList added, removed;
+    for (const Port &p : ports) {
+        if (!before.contains(p.path)) added << p.path;
+    }
+    for (const Port &p : m_ports) {
+        if (!after.contains(p.path)) removed << p.path;
+    }
+
+    const bool first = !m_scanned;
+    m_ports = ports;
+    m_scanned = true;
+    if (first || !added.isEmpty() || !removed.isEmpty()) emit portsChanged(added, removed);
+
+    if (m_rescanPending) rescan();
+}
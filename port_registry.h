@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QTimer>
+#include <QFileSystemWatcher>
+
+class QThread;
+
+// 共享的串口列表服务：后台线程枚举（QSerialPortInfo::availablePorts 在多 USB 转串口的主机上
+// 可能阻塞数百 ms），结果过滤后缓存；监视 /dev 目录（Linux inotify / macOS kqueue）
+// 的增删自动重新枚举，没有 /dev 的平台退化为定时轮询。
+// 各界面只读缓存并响应 portsChanged()，不再各自同步枚举。
+class PortRegistry final : public QObject {
+    Q_OBJECT
+public:
+    struct Port {
+        QString path;                // system location, e.g. /dev/ttyUSB0, /dev/cu.usbserial-110
+        QString description;
+        QString manufacturer;
+        QString serialNumber;
+        quint16 vid = 0;
+        quint16 pid = 0;
+
+        QString label() const;       // "path  (description)", as shown in the combos
+    };
+
+    static PortRegistry *instance();
+
+    // cached and filtered; never blocks
+    const QVector<Port> &ports() const { return m_ports; }
+    bool hasScanned() const { return m_scanned; }
+
+    // asynchronous; repeated calls while a scan runs coalesce into one more scan
+    void rescan();
+
+    // macOS: /dev/cu.* without debug-console / Bluetooth; Linux: ttyUSB* / ttyACM*
+    static bool acceptPath(const QString &path);
+    // index of the most likely USB-serial adapter, -1 if the list is empty
+    static int preferredIndex(const QVector<Port> &ports);
+
+signals:
+    void portsChanged(const QStringList &added, const QStringList &removed);
+
+private:
+    explicit PortRegistry(QObject *parent = nullptr);
+    ~PortRegistry() override;
+
+    void onScanDone(const QVector<Port> &ports);
+
+    QVector<Port> m_ports;
+    bool m_scanned = false;
+
+    QThread *m_thread = nullptr;
+    bool m_rescanPending = false;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounceTimer;          // udev creates the node first, symlinks and sysfs info a bit later
+    QTimer m_pollTimer;              // only when /dev cannot be watched
+};
@@ -0,0 +1,127 @@
+#include "scope_trigger.h"
+
+#include <QtGlobal>
+
+void ScopeTrigger::setConfig(const Config &cfg) {
+    m_cfg = cfg;
+    m_cfg.preSamples = qMax(0, m_cfg.preSamples);
+    m_cfg.postSamples = qMax(1, m_cfg.postSamples);
+    m_cfg.hysteresis = qMax(0.0, m_cfg.hysteresis);
+
+    m_history = QVector<QPointF>(m_cfg.preSamples + m_cfg.postSamples + 1);
+    m_historyHead = 0;
+    m_historyCount = 0;
+
+    if (m_state != State::Idle) arm();
+}
+
+void ScopeTrigger::arm() {
+    if (m_history.isEmpty()) m_history = QVector<QPointF>(m_cfg.preSamples + m_cfg.postSamples + 1);
+    m_state = State::Armed;
+    m_armedRise = false;
+    m_armedFall = false;
+    m_hasPrev = false;
+    m_postLeft = 0;
+    m_sinceFrame = 0;
+    m_pending = Frame();
+}
+
+void ScopeTrigger::stop() {
+    m_state = State::Idle;
+    m_pending = Frame();
+}
+
+void ScopeTrigger::pushHistory(const QPointF &p) {
+    const int cap = m_history.size();
+    if (cap == 0) return;
+    m_history[m_historyHead] = p;
+    m_historyHead = (m_historyHead + 1) % cap;
+    if (m_historyCount < cap) ++m_historyCount;
+}
+
+QPointF ScopeTrigger::historyAt(int back) const {
+    const int cap = m_history.size();
+    return m_history[(m_historyHead - 1 - back + 2 * cap) % cap];
+}
+
+void ScopeTrigger::beginFrame(double triggerX, int preCount, bool forced) {
+    m_pending = Frame();
+    m_pending.triggerX = triggerX;
+    m_pending.forced = forced;
+    m_pending.points.reserve(preCount + m_cfg.postSamples + 1);
+    for (int back = preCount - 1; back >= 0; --back) m_pending.points.push_back(historyAt(back));
+}
+
+void ScopeTrigger::finishFrame(Frame *out) {
+    for (QPointF &p : m_pending.points) p.setX(p.x() - m_pending.triggerX);
+    if (out) *out = std::move(m_pending);
+    m_pending = Frame();
+    ++m_frames;
+    m_sinceFrame = 0;
+
+    if (m_cfg.mode == Mode::Single) {
+        m_state = State::Done;
+    } else {
+        // re-arm; the hysteresis band must be crossed again before the next trigger
+        m_state = State::Armed;
+        m_armedRise = false;
+        m_armedFall = false;
+    }
+}
+
+bool ScopeTrigger::feed(const QPointF &p, Frame *out) {
+    if (m_state == State::Idle || m_state == State::Done) return false;
+
+    pushHistory(p);
+    const QPointF prev = m_prev;
+    const bool hasPrev = m_hasPrev;
+    m_prev = p;
+    m_hasPrev = true;
+
+    if (m_state == State::Collecting) {
+        m_pending.points.push_back(p);
+        if (--m_postLeft > 0) return false;
+        finishFrame(out);
+        return true;
+    }
+
+    // Armed
+    const double y = p.y();
+    const double lo = m_cfg.level - m_cfg.hysteresis;
+    const double hi = m_cfg.level + m_cfg.hysteresis;
+    const bool wantRise = m_cfg.edge != Edge::Falling;
+    const bool wantFall = m_cfg.edge != Edge::Rising;
+
+    bool fired = false;
+    if (wantRise && m_armedRise && y >= m_cfg.level) fired = true;
+    if (wantFall && m_armedFall && y <= m_cfg.level) fired = true;
+
+    if (wantRise && (m_cfg.hysteresis > 0.0 ? y <= lo : y < m_cfg.level)) m_armedRise = true;
+    if (wantFall && (m_cfg.hysteresis > 0.0 ? y >= hi : y > m_cfg.level)) m_armedFall = true;
+
+    if (fired) {
+        double tx = p.x();
+        if (hasPrev && prev.y() != y) {
+            const double t = qBound(0.0, (m_cfg.level - prev.y()) / (y - prev.y()), 1.0);
+            tx = prev.x() + t * (p.x() - prev.x());
+        }
+        m_armedRise = false;
+        m_armedFall = false;
+
+        // pre-trigger samples plus the triggering one
+        beginFrame(tx, qMin(m_historyCount, m_cfg.preSamples + 1), false);
+        m_postLeft = m_cfg.postSamples;
+        m_state = State::Collecting;
+        return false;
+    }
+
+    if (m_cfg.mode == Mode::Auto && ++m_sinceFrame >= m_cfg.preSamples + m_cfg.postSamples
+        && m_historyCount >= m_cfg.preSamples + m_cfg.postSamples) {
+        // free-running frame: the last pre + post samples, "trigger" at the pre boundary
+        const int total = m_cfg.preSamples + m_cfg.postSamples;
+        beginFrame(historyAt(m_cfg.postSamples - 1).x(), total, true);
+        finishFrame(out);
+        return true;
+    }
+    return false;
+}
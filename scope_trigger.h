@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+// 示波器式触发：在样本进入时增量检测电平穿越，收集触发前 / 后样本组成一帧。
+//
+// 迟滞：上升沿要求信号先低于 level - hysteresis 才重新布防，下降沿反之，避免噪声反复触发。
+// 触发点在相邻两个样本间线性插值，帧内 x 以触发点为 0，叠加显示时各帧对齐。
+// 模式：Normal 每次触发出一帧；Single 出一帧后停止，需重新布防；
+//       Auto 在 pre + post 个样本内没有触发时也强制出一帧（自由运行）。
+class ScopeTrigger final {
+public:
+    enum class Edge { Rising, Falling, Both };
+    enum class Mode { Auto, Normal, Single };
+    enum class State { Idle, Armed, Collecting, Done };
+
+    struct Config {
+        Edge edge = Edge::Rising;
+        Mode mode = Mode::Normal;
+        double level = 0.0;
+        double hysteresis = 0.0;
+        int preSamples = 200;
+        int postSamples = 800;
+    };
+
+    struct Frame {
+        QVector<QPointF> points;   // x relative to the trigger point
+        double triggerX = 0.0;     // absolute x of the trigger point
+        bool forced = false;       // produced by Auto without a trigger
+    };
+
+    void setConfig(const Config &cfg);
+    const Config &config() const { return m_cfg; }
+
+    void arm();        // start (or restart after Single)
+    void stop();
+
+    State state() const { return m_state; }
+    quint64 frameCount() const { return m_frames; }
+
+    // returns true when `p` completes a frame (written to *out)
+    bool feed(const QPointF &p, Frame *out);
+
+private:
+    void pushHistory(const QPointF &p);
+    QPointF historyAt(int back) const;   // 0 = newest
+    void beginFrame(double triggerX, int preCount, bool forced);
+    void finishFrame(Frame *out);
+
+    Config m_cfg;
+    State m_state = State::Idle;
+
+    // last pre + post + 1 samples (post is kept for Auto's free-running frames)
+    QVector<QPointF> m_history;
+    int m_historyHead = 0;
+    int m_historyCount = 0;
+
+    bool m_armedRise = false;
+    bool m_armedFall = false;
+    bool m_hasPrev = false;
+    QPointF m_prev;
+
+    Frame m_pending;
+    int m_postLeft = 0;
+    int m_sinceFrame = 0;
+    quint64 m_frames = 0;
+};
@@ -0,0 +1,117 @@
+#include "scope_trigger_dialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QFormLayout>
+#include <QVBoxLayout>
+
+#include <limits>
+
+ScopeTriggerDialog::ScopeTriggerDialog(QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("示波器触发");
+    setModal(false);
+
+    m_enableCheck = new QCheckBox("启用触发显示", this);
+
+    m_channelSpin = new QSpinBox(this);
+    m_channelSpin->setRange(0, 9999);
+    m_channelSpin->setPrefix("CH:");
+
+    m_edgeCombo = new QComboBox(this);
+    m_edgeCombo->addItem("上升沿", int(ScopeTrigger::Edge::Rising));
+    m_edgeCombo->addItem("下降沿", int(ScopeTrigger::Edge::Falling));
+    m_edgeCombo->addItem("双沿", int(ScopeTrigger::Edge::Both));
+
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem("Normal", int(ScopeTrigger::Mode::Normal));
+    m_modeCombo->addItem("Auto", int(ScopeTrigger::Mode::Auto));
+    m_modeCombo->addItem("Single", int(ScopeTrigger::Mode::Single));
+
+    const double big = std::numeric_limits<float>::max();
+    m_levelSpin = new QDoubleSpinBox(this);
+    m_levelSpin->setRange(-big, big);
+    m_levelSpin->setDecimals(4);
+
+    m_hystSpin = new QDoubleSpinBox(this);
+    m_hystSpin->setRange(0.0, big);
+    m_hystSpin->setDecimals(4);
+
+    m_preSpin = new QSpinBox(this);
+    m_preSpin->setRange(0, 1000000);
+    m_preSpin->setValue(200);
+    m_preSpin->setSuffix(" 点");
+
+    m_postSpin = new QSpinBox(this);
+    m_postSpin->setRange(1, 1000000);
+    m_postSpin->setValue(800);
+    m_postSpin->setSuffix(" 点");
+
+    m_overlaySpin = new QSpinBox(this);
+    m_overlaySpin->setRange(1, 32);
+    m_overlaySpin->setValue(1);
+    m_overlaySpin->setSuffix(" 帧");
+
+    m_rearmBtn = new QPushButton("重新布防", this);
+    m_statusLabel = new QLabel(this);
+
+    auto *form = new QFormLayout();
+    form->addRow(m_enableCheck);
+    form->addRow("通道", m_channelSpin);
+    form->addRow("边沿", m_edgeCombo);
+    form->addRow("模式", m_modeCombo);
+    form->addRow("电平", m_levelSpin);
+    form->addRow("迟滞", m_hystSpin);
+    form->addRow("触发前", m_preSpin);
+    form->addRow("触发后", m_postSpin);
+    form->addRow("叠加", m_overlaySpin);
+
+    auto *root = new QVBoxLayout(this);
+    root->addLayout(form);
+    root->addWidget(m_rearmBtn);
+    root->addWidget(m_statusLabel);
+
+    auto changed = [this]() { emit settingsChanged(); };
+    connect(m_enableCheck, &QCheckBox::toggled, this, changed);
+    connect(m_channelSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, changed);
+    connect(m_edgeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, changed);
+    connect(m_modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, changed);
+    connect(m_levelSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, changed);
+    connect(m_hystSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, changed);
+    connect(m_preSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, changed);
+    connect(m_postSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, changed);
+    connect(m_overlaySpin, QOverload<int>::of(&QSpinBox::valueChanged), this, changed);
+    connect(m_rearmBtn, &QPushButton::clicked, this, &ScopeTriggerDialog::rearmRequested);
+}
+
+bool ScopeTriggerDialog::isTriggerEnabled() const {
+    return m_enableCheck->isChecked();
+}
+
+int ScopeTriggerDialog::channel() const {
+    return m_channelSpin->value();
+}
+
+int ScopeTriggerDialog::overlayFrames() const {
+    return m_overlaySpin->value();
+}
+
+ScopeTrigger::Config ScopeTriggerDialog::config() const {
+    ScopeTrigger::Config c;
+    c.edge = ScopeTrigger::Edge(m_edgeCombo->currentData().toInt());
+    c.mode = ScopeTrigger::Mode(m_modeCombo->currentData().toInt());
+    c.level = m_levelSpin->value();
+    c.hysteresis = m_hystSpin->value();
+    c.preSamples = m_preSpin->value();
+    c.postSamples = m_postSpin->value();
+    return c;
+}
+
+void ScopeTriggerDialog::setStatusText(const QString &text) {
+    m_statusLabel->setText(text);
+}
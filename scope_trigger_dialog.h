@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QDialog>
+
+#include "scope_trigger.h"
+
+class QCheckBox;
+class QComboBox;
+class QDoubleSpinBox;
+class QSpinBox;
+class QPushButton;
+class QLabel;
+
+// 示波器触发设置（非模态）：修改即时生效，状态行由 PlotWidget 刷新。
+class ScopeTriggerDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit ScopeTriggerDialog(QWidget *parent = nullptr);
+
+    bool isTriggerEnabled() const;
+    int channel() const;
+    int overlayFrames() const;
+    ScopeTrigger::Config config() const;
+
+    void setStatusText(const QString &text);
+
+signals:
+    void settingsChanged();
+    void rearmRequested();
+
+private:
+    QCheckBox *m_enableCheck = nullptr;
+    QSpinBox *m_channelSpin = nullptr;
+    QComboBox *m_edgeCombo = nullptr;
+    QComboBox *m_modeCombo = nullptr;
+    QDoubleSpinBox *m_levelSpin = nullptr;
+    QDoubleSpinBox *m_hystSpin = nullptr;
+    QSpinBox *m_preSpin = nullptr;
+    QSpinBox *m_postSpin = nullptr;
+    QSpinBox *m_overlaySpin = nullptr;
+    QPushButton *m_rearmBtn = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -1,4 +1,10 @@
 #include "serial_terminal_widget.h"
+#include "byte_runs.h"
+#include "history_search_dialog.h"
+#include "trigger_rules_dialog.h"
+#include "tx_sequence_dialog.h"
+#include "file_transfer_dialog.h"
+#include "port_registry.h"
 
 #include <QComboBox>
 #include <QPushButton>
@@ -9,31 +15,62 @@
 #include <QSpinBox>
 #include <QLabel>
 
-#include <QSerialPortInfo>
+#include <QFileDialog>
+#include <QStandardPaths>
+#include <QDir>
 
 #include <QTextCursor>
 #include <QTextBlockFormat>
 #include <QTextCharFormat>
 #include <QFont>
-#include <QDateTime>
 #include <QFontMetrics>
-
-static QString tsHmsZ() {
-    return QDateTime::currentDateTime().toString("HH:mm:ss.zzz");
-}
+#include <QShortcut>
+#include <QKeySequence>
+#include <QTextDocument>
+#include <QRegularExpression>
 
 SerialTerminalWidget::SerialTerminalWidget(QWidget *tabRoot, QWidget *parent)
     : QWidget(parent) {
 
-    m_mono.start();
     bindUi(tabRoot);
 
     // serial signals
     connect(&m_serial, &QSerialPort::readyRead, this, &SerialTerminalWidget::onReadyRead);
 
-    // timer
-    m_timedSendTimer.setTimerType(Qt::CoarseTimer);
-    connect(&m_timedSendTimer, &QTimer::timeout, this, &SerialTerminalWidget::onTimedSendTick);
+    // interactive TX queue
+    m_txQueueStatsTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_txQueueStatsTimer, &QTimer::timeout, this, &SerialTerminalWidget::onTxQueueStatsTick);
+    connect(&m_txQueue, &TxQueue::written, this, &SerialTerminalWidget::onTxWritten);
+    connect(&m_txQueue, &TxQueue::error, this, [this](const QString &msg) {
+        logSystem(QString("TX queue write failed: %1").arg(msg));
+    });
+
+    // file send worker
+    m_fileProgressTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_fileProgressTimer, &QTimer::timeout, this, &SerialTerminalWidget::onFileTransferProgressTick);
+    connect(&m_fileTransfer, &FileTransfer::finished, this, &SerialTerminalWidget::onFileTransferFinished);
+
+    // timed send (scheduler thread) + stats/echo polling
+    m_txStatsTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_txStatsTimer, &QTimer::timeout, this, &SerialTerminalWidget::onTxStatsTick);
+    connect(&m_txScheduler, &TxScheduler::framesReady, this, &SerialTerminalWidget::onTxFramesReady, Qt::QueuedConnection);
+    connect(&m_txScheduler, &TxScheduler::finished, this, &SerialTerminalWidget::onTxSchedulerFinished);
+    connect(&m_txScheduler, &TxScheduler::error, this, [this](const QString &msg) {
+        logSystem(QString("Timed send error: %1").arg(msg));
+    });
+
+    // session log
+    m_logDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+               + "/STM32_Serial_Tool/logs";
+    m_logStatsTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_logStatsTimer, &QTimer::timeout, this, &SerialTerminalWidget::onLogStatsTick);
+    connect(&m_logger, &SessionLogger::error, this, [this](const QString &msg) {
+        logSystem(QString("Log error: %1").arg(msg));
+        if (!m_logger.hasFailed() || !m_logger.isRunning()) return;
+        emit statusMessage(QString("日志写入失败: %1").arg(msg), 5000);
+        if (m_logToFileCheck && m_logToFileCheck->isChecked()) m_logToFileCheck->setChecked(false);   // -> onLogToggled
+        else onLogToggled(false);
+    });
 
     if (isUiComplete()) {
         // terminal view styles
@@ -78,6 +115,10 @@ SerialTerminalWidget::SerialTerminalWidget(QWidget *tabRoot, QWidget *parent)
             m_recvModeCombo->addItems({"ASCII","HEX"});
             m_recvModeCombo->setCurrentText("ASCII");
         }
+        if (m_hexBytesPerRowCombo && m_hexBytesPerRowCombo->count() == 0) {
+            m_hexBytesPerRowCombo->addItems({"16","32"});
+            m_hexBytesPerRowCombo->setCurrentText("16");
+        }
         if (m_sendModeCombo && m_sendModeCombo->count() == 0) {
             m_sendModeCombo->addItems({"ASCII","HEX"});
             m_sendModeCombo->setCurrentText("ASCII");
@@ -92,6 +133,44 @@ SerialTerminalWidget::SerialTerminalWidget(QWidget *tabRoot, QWidget *parent)
             if (m_sendIntervalMsSpin->value() == 0) m_sendIntervalMsSpin->setValue(1000);
         }
 
+        // session log controls (optional group box)
+        if (m_logRotateMbSpin) {
+            m_logRotateMbSpin->setRange(1, 4096);
+            if (m_logRotateMbSpin->value() <= 1) m_logRotateMbSpin->setValue(64);
+        }
+        if (m_logRotateTimeCombo && m_logRotateTimeCombo->count() == 0) {
+            m_logRotateTimeCombo->addItem("不限", 0);
+            m_logRotateTimeCombo->addItem("1小时", 3600);
+            m_logRotateTimeCombo->addItem("1天", 86400);
+        }
+        if (m_logMaxTotalGbSpin) {
+            m_logMaxTotalGbSpin->setRange(1, 1024);
+            if (m_logMaxTotalGbSpin->value() <= 1) m_logMaxTotalGbSpin->setValue(4);
+        }
+        if (m_logDirLabel) {
+            m_logDirLabel->setText(QDir::toNativeSeparators(m_logDir));
+            m_logDirLabel->setToolTip(m_logDirLabel->text());
+        }
+        if (m_logToFileCheck) connect(m_logToFileCheck, &QCheckBox::toggled, this, &SerialTerminalWidget::onLogToggled);
+        if (m_logDirBtn) connect(m_logDirBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onPickLogDir);
+
+        // history search: button (optional) + Ctrl/Cmd+F on the terminal tab
+        if (m_searchHistoryBtn) connect(m_searchHistoryBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onOpenHistorySearch);
+        if (m_fileTransferBtn) connect(m_fileTransferBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onOpenFileTransfer);
+        auto *findShortcut = new QShortcut(QKeySequence::Find, tabRoot);
+        findShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        connect(findShortcut, &QShortcut::activated, this, &SerialTerminalWidget::onOpenHistorySearch);
+
+        if (m_txSequenceBtn) connect(m_txSequenceBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onOpenTxSequence);
+
+        // triggers (optional group)
+        if (m_triggerRulesBtn) connect(m_triggerRulesBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onEditTriggers);
+        if (m_pauseViewBtn) {
+            m_pauseViewBtn->setCheckable(true);
+            connect(m_pauseViewBtn, &QPushButton::toggled, this, &SerialTerminalWidget::onPauseViewToggled);
+        }
+        updateTriggerStats(-1, 0);
+
         // connect UI
         connect(m_refreshPortsBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onRefreshPorts);
         connect(m_openBtn, &QPushButton::clicked, this, &SerialTerminalWidget::onOpenPort);
@@ -104,7 +183,8 @@ SerialTerminalWidget::SerialTerminalWidget(QWidget *tabRoot, QWidget *parent)
 
         // initial state
         setConnectedUi(false);
-        onRefreshPorts();
+        connect(PortRegistry::instance(), &PortRegistry::portsChanged, this, &SerialTerminalWidget::onPortsChanged);
+        if (PortRegistry::instance()->hasScanned()) populatePorts();
         logSystem("Serial terminal ready.");
         emit statusMessage("串口终端已就绪。",3000);
     } else {
@@ -133,9 +213,12 @@ void SerialTerminalWidget::bindUi(QWidget *root) {
 
     m_terminalEdit = root->findChild<QTextEdit*>("textEditTerminal");
     m_clearBtn = root->findChild<QPushButton*>("pushButtonClearTerminal");
+    m_searchHistoryBtn = root->findChild<QPushButton*>("pushButtonSearchHistory");
+    m_fileTransferBtn = root->findChild<QPushButton*>("pushButtonFileTransfer");
 
     m_recvModeCombo = root->findChild<QComboBox*>("comboBoxRecvMode");
     m_showEscapesRadio = root->findChild<QRadioButton*>("radioButtonShowEscapes");
+    m_hexBytesPerRowCombo = root->findChild<QComboBox*>("comboBoxHexBytesPerRow");
 
     m_autoWrapCheck = root->findChild<QCheckBox*>("checkBoxAutoWrap");
     m_autoWrapMsSpin = root->findChild<QSpinBox*>("spinBoxAutoWrapMs");
@@ -147,8 +230,23 @@ void SerialTerminalWidget::bindUi(QWidget *root) {
     m_timedSendCheck = root->findChild<QCheckBox*>("checkBoxTimedSend");
     m_sendIntervalMsSpin = root->findChild<QSpinBox*>("spinBoxSendIntervalMs");
     m_timedSendToggleBtn = root->findChild<QPushButton*>("pushButtonTimedSendToggle");
+    m_txSequenceBtn = root->findChild<QPushButton*>("pushButtonTxSequence");
     m_sendCountLabel = root->findChild<QLabel*>("labelSendCount");
     m_failCountLabel = root->findChild<QLabel*>("labelFailCount");
+    m_txQueueStatsLabel = root->findChild<QLabel*>("labelTxQueueStats");
+
+    m_logToFileCheck = root->findChild<QCheckBox*>("checkBoxLogToFile");
+    m_logDirBtn = root->findChild<QPushButton*>("pushButtonLogDir");
+    m_logDirLabel = root->findChild<QLabel*>("labelLogDir");
+    m_logRotateMbSpin = root->findChild<QSpinBox*>("spinBoxLogRotateMb");
+    m_logRotateTimeCombo = root->findChild<QComboBox*>("comboBoxLogRotateTime");
+    m_logMaxTotalGbSpin = root->findChild<QSpinBox*>("spinBoxLogMaxTotalGb");
+    m_logCompressCheck = root->findChild<QCheckBox*>("checkBoxLogCompress");
+    m_logStatsLabel = root->findChild<QLabel*>("labelLogStats");
+
+    m_triggerRulesBtn = root->findChild<QPushButton*>("pushButtonTriggerRules");
+    m_pauseViewBtn = root->findChild<QPushButton*>("pushButtonPauseView");
+    m_triggerStatsLabel = root->findChild<QLabel*>("labelTriggerStats");
 }
 
 bool SerialTerminalWidget::isUiComplete() const {
@@ -179,27 +277,33 @@ bool SerialTerminalWidget::showEscapes() const {
     return m_showEscapesRadio && m_showEscapesRadio->isChecked();
 }
 
-bool SerialTerminalWidget::acceptPortPath(const QString &sysPath) {
-    // macOS: only keep /dev/cu.* and filter debug-console & Bluetooth
-    if (!sysPath.startsWith("/dev/cu.")) return false;
-    if (sysPath.contains("debug-console", Qt::CaseInsensitive)) return false;
-    if (sysPath.contains("Bluetooth-Incoming-Port", Qt::CaseInsensitive)) return false;
-    return true;
+void SerialTerminalWidget::onRefreshPorts() {
+    // enumeration runs in the background; the combo follows portsChanged()
+    PortRegistry::instance()->rescan();
+    emit statusMessage("正在刷新端口…", 2000);
 }
 
-void SerialTerminalWidget::onRefreshPorts() {
+void SerialTerminalWidget::onPortsChanged(const QStringList &added, const QStringList &removed) {
+    for (const QString &path : added) logSystem(QString("Port added: %1").arg(path));
+    for (const QString &path : removed) logSystem(QString("Port removed: %1").arg(path));
+
+    // don't pull the open port out from under the combo; catch up after close
+    if (m_serial.isOpen()) {
+        m_portsDirty = true;
+        return;
+    }
+    populatePorts();
+    emit statusMessage(QString("端口列表已更新：%1").arg(m_portCombo ? m_portCombo->count() : 0), 3000);
+}
+
+void SerialTerminalWidget::populatePorts() {
     if (!m_portCombo) return;
+    m_portsDirty = false;
     const QString prev = m_portCombo->currentData().toString();
 
+    const QVector<PortRegistry::Port> &ports = PortRegistry::instance()->ports();
     m_portCombo->clear();
-    const auto ports = QSerialPortInfo::availablePorts();
-    for (const auto &p : ports) {
-        const QString sys = p.systemLocation();
-        if (!acceptPortPath(sys)) continue;
-
-        const QString desc = p.description().isEmpty() ? "No description" : p.description();
-        m_portCombo->addItem(QString("%1  (%2)").arg(sys, desc), sys);
-    }
+    for (const PortRegistry::Port &p : ports) m_portCombo->addItem(p.label(), p.path);
 
     // restore
     if (!prev.isEmpty()) {
@@ -211,25 +315,8 @@ void SerialTerminalWidget::onRefreshPorts() {
         }
     }
 
-    // prefer usbserial
-    if (m_portCombo->currentIndex() < 0) {
-        for (int i = 0; i < m_portCombo->count(); ++i) {
-            const QString pth = m_portCombo->itemData(i).toString();
-            if (pth.contains("usbserial", Qt::CaseInsensitive) ||
-                pth.contains("wch", Qt::CaseInsensitive) ||
-                pth.contains("slab", Qt::CaseInsensitive) ||
-                pth.contains("usbmodem", Qt::CaseInsensitive)) {
-                m_portCombo->setCurrentIndex(i);
-                break;
-            }
-        }
-        if (m_portCombo->currentIndex() < 0 && m_portCombo->count() > 0) {
-            m_portCombo->setCurrentIndex(0);
-        }
-    }
-
-    logSystem(QString("Ports refreshed: %1").arg(m_portCombo->count()));
-    emit statusMessage(QString("已刷新端口：%1").arg(m_portCombo->count()), 3000);
+    // prefer usb-serial adapters
+    if (m_portCombo->currentIndex() < 0) m_portCombo->setCurrentIndex(PortRegistry::preferredIndex(ports));
 }
 
 void SerialTerminalWidget::setConnectedUi(bool connected) {
@@ -254,9 +341,14 @@ void SerialTerminalWidget::setConnectedUi(bool connected) {
     m_timedSendCheck->setEnabled(connected);
     m_sendIntervalMsSpin->setEnabled(connected);
     m_timedSendToggleBtn->setEnabled(connected);
+
+    if (!connected && m_portsDirty) populatePorts();
 }
 
 void SerialTerminalWidget::logSystem(const QString &msg) {
+    if (m_logger.isRunning()) {
+        m_logger.append(TimestampClock::nowNs(), SessionLogger::Dir::System, msg.toUtf8(), false);
+    }
     if (!m_terminalEdit) return;
 
     // system line in grey, left aligned
@@ -269,13 +361,13 @@ void SerialTerminalWidget::logSystem(const QString &msg) {
 
     QTextCharFormat fmt;
     fmt.setForeground(QColor(80,80,80));
-    c.insertText(QString("[%1] %2").arg(tsHmsZ(), msg), fmt);
+    c.insertText(QString("[%1] %2").arg(m_tsClock.formatHmsZ(TimestampClock::nowNs()), msg), fmt);
 
     m_terminalEdit->setTextCursor(c);
     m_terminalEdit->ensureCursorVisible();
 }
 
-void SerialTerminalWidget::appendDividerLine() {
+void SerialTerminalWidget::appendDividerLine(qint64 tsNs) {
     if (!m_terminalEdit) return;
 
     QTextCursor c = m_terminalEdit->textCursor();
@@ -288,7 +380,12 @@ void SerialTerminalWidget::appendDividerLine() {
     QTextCharFormat fmt;
     fmt.setForeground(QColor(140,140,140));
 
-    const QString prefix = QString("[%1]---").arg(tsHmsZ());
+    // 到达时间（读取时打戳），µs 精度
+    QString prefix;
+    prefix.reserve(24);
+    prefix += QLatin1Char('[');
+    prefix += m_tsClock.formatHmsUs(tsNs);
+    prefix += QLatin1String("]---");
 
     // 根据可视宽度动态计算 '-' 数量，确保一行不换行
     const int availablePx = m_terminalEdit->viewport()->width();
@@ -311,43 +408,44 @@ void SerialTerminalWidget::appendDividerLine() {
 }
 
 QString SerialTerminalWidget::renderHexString(const QByteArray &bytes) const {
-    QByteArray hex = bytes.toHex(' ').toUpper();
+    QByteArray hex;
+    HexDumpFormatter::encodeSpaced(bytes.constData(), int(bytes.size()), &hex);
     return QString::fromLatin1(hex);
 }
 
+QString SerialTerminalWidget::renderHexDump(const QByteArray &bytes) {
+    if (m_hexBytesPerRowCombo) {
+        bool ok = false;
+        const int n = m_hexBytesPerRowCombo->currentText().trimmed().toInt(&ok);
+        if (ok) m_hexDump.setBytesPerRow(n);
+    }
+    return m_hexDump.format(bytes, m_rxStreamOffset);
+}
+
 QVector<QPair<QString,bool>> SerialTerminalWidget::renderAsciiSegments(const QByteArray &bytes, bool escapesEnabled) const {
     QVector<QPair<QString,bool>> segs;
-    segs.reserve(bytes.size());
+    if (bytes.isEmpty()) return segs;
 
-    auto push = [&](const QString &s, bool isEsc) {
-        if (s.isEmpty()) return;
-        if (!segs.isEmpty() && segs.last().second == isEsc) {
-            segs.last().first += s;
-        } else {
-            segs.push_back({s, isEsc});
-        }
-    };
-
-    for (unsigned char b : bytes) {
-        if (!escapesEnabled) {
-            // real meaning: allow \n \r \t to act
-            push(QString(QChar(b)), false);
-            continue;
-        }
+    if (!escapesEnabled) {
+        // real meaning: allow \n \r \t to act
+        segs.push_back({QString::fromLatin1(bytes), false});
+        return segs;
+    }
 
-        // show escapes explicitly
-        switch (b) {
-        case '\n': push("\\n", true); break;
-        case '\r': push("\\r", true); break;
-        case '\t': push("\\t", true); break;
-        case 0x1B: push("\\x1B", true); break;
-        default:
-            if (b < 0x20 || b == 0x7F) {
-                push(QString("\\x%1").arg(b, 2, 16, QLatin1Char('0')).toUpper(), true);
-            } else {
-                push(QString(QChar(b)), false);
-            }
-            break;
+    // one pass: alternating printable / control runs; escape text only for control runs
+    QVector<ByteRun> runs;
+    classifyByteRuns(bytes.constData(), int(bytes.size()), &runs);
+
+    segs.reserve(runs.size());
+    for (const ByteRun &r : runs) {
+        const char *p = bytes.constData() + r.offset;
+        if (r.control) {
+            QString esc;
+            esc.reserve(r.length * 4);
+            appendControlEscapes(p, r.length, &esc);
+            segs.push_back({esc, true});
+        } else {
+            segs.push_back({QString::fromLatin1(p, r.length), false});
         }
     }
     return segs;
@@ -395,37 +493,49 @@ void SerialTerminalWidget::appendAlignedSegments(const QVector<QPair<QString,boo
     m_terminalEdit->ensureCursorVisible();
 }
 
-void SerialTerminalWidget::maybeAutoWrapBeforeNewMessage() {
+void SerialTerminalWidget::maybeAutoWrapBeforeNewMessage(qint64 tsNs) {
     if (!m_autoWrapCheck || !m_autoWrapMsSpin) return;
     if (!m_autoWrapCheck->isChecked()) return;
 
-    const int gap = m_autoWrapMsSpin->value();
-    const qint64 now = m_mono.elapsed();
+    const qint64 gapNs = qint64(m_autoWrapMsSpin->value()) * 1000000LL;
 
-    if (m_lastMessageMs >= 0 && (now - m_lastMessageMs) > gap) {
+    if (m_lastMessageNs >= 0 && (tsNs - m_lastMessageNs) > gapNs) {
         // insert a blank line as separator
         QTextCursor c = m_terminalEdit->textCursor();
         c.movePosition(QTextCursor::End);
         c.insertBlock();
         m_terminalEdit->setTextCursor(c);
     }
-    m_lastMessageMs = now;
+    m_lastMessageNs = tsNs;
 }
 
-void SerialTerminalWidget::appendMessage(const QByteArray &bytes, bool isRx) {
-    maybeAutoWrapBeforeNewMessage();
-    appendDividerLine();
-
+void SerialTerminalWidget::appendMessage(const QByteArray &bytes, bool isRx, qint64 tsNs) {
     const auto mode = isRx ? recvMode() : sendMode();
 
+    if (m_logger.isRunning()) {
+        m_logger.append(tsNs, isRx ? SessionLogger::Dir::Rx : SessionLogger::Dir::Tx,
+                        bytes, mode == DisplayMode::HEX);
+    }
+
+    // paused by the user or a trigger: keep logging, stop rendering RX
+    if (isRx && m_viewPaused) {
+        m_lastMessageBodyPos = -1;
+        return;
+    }
+
+    maybeAutoWrapBeforeNewMessage(tsNs);
+    appendDividerLine(tsNs);
+    // the payload starts after the timestamp / divider line (trigger highlight searches from here)
+    m_lastMessageBodyPos = m_terminalEdit ? m_terminalEdit->document()->characterCount() - 1 : -1;
+
     // colors: RX green-ish, TX blue-ish; escapes orange-ish
     const QColor rxColor(0, 120, 0);
     const QColor txColor(0, 90, 180);
     const QColor escColor(180, 90, 0);
 
     if (mode == DisplayMode::HEX) {
-        // HEX is "ASCII bytes hex representation" for TX; for RX it is raw bytes hex
-        const QString s = renderHexString(bytes);
+        // HEX is "ASCII bytes hex representation" for TX; for RX it is a dump at the stream offset
+        const QString s = isRx ? renderHexDump(bytes) : renderHexString(bytes);
         appendAlignedText(s, isRx, isRx ? rxColor : txColor);
         return;
     }
@@ -532,15 +642,24 @@ void SerialTerminalWidget::onOpenPort() {
     if (m_sendCountLabel) m_sendCountLabel->setText("0");
     if (m_failCountLabel) m_failCountLabel->setText("0");
 
-    m_lastMessageMs = -1;
+    m_lastMessageNs = -1;
+    m_rxStreamOffset = 0;
+    m_history.clearLive();      // a new session: stale matches would point at nothing
+    m_triggers.reset();
+    m_txQueue.clear();
+    m_txQueueStatsTimer.start(500);
+    onTxQueueStatsTick();
     logSystem(QString("Opened %1 @%2").arg(portPath).arg(baud));
     emit statusMessage(QString("已打开 %1 @%2").arg(portPath).arg(baud), 3000);
     setConnectedUi(true);
 }
 
 void SerialTerminalWidget::onClosePort() {
+    stopTimedSend();
+    m_txQueue.clear();
+    m_txQueueStatsTimer.stop();
     if (m_serial.isOpen()) m_serial.close();
-    if (m_timedSendTimer.isActive()) m_timedSendTimer.stop();
+    if (m_txQueueStatsLabel) m_txQueueStatsLabel->clear();
     if (m_timedSendToggleBtn) m_timedSendToggleBtn->setText("开始");
     logSystem("Closed.");
     emit statusMessage("已关闭。",3000);
@@ -552,11 +671,20 @@ void SerialTerminalWidget::onReadyRead() {
 
     const QByteArray data = m_serial.readAll();
     if (data.isEmpty()) return;
+    const qint64 tsNs = TimestampClock::nowNs();   // arrival stamp, before any rendering
 
-    appendMessage(data, /*isRx=*/true);
+    m_history.appendLive(data, tsNs);
+
+    // one pass over the chunk for all rules; automaton state carries across chunks
+    m_triggerEvents.resize(0);
+    m_triggers.feed(data.constData(), int(data.size()), m_rxStreamOffset, tsNs, &m_triggerEvents);
+
+    appendMessage(data, /*isRx=*/true, tsNs);
+    if (!m_triggerEvents.isEmpty()) handleTriggerEvents(data, m_rxStreamOffset, m_lastMessageBodyPos);
+    m_rxStreamOffset += quint64(data.size());
 
     // NEW: forward lines to PlotWidget
-    emitLinesFromRxBytes(data);
+    emitLinesFromRxBytes(data, tsNs);
     //qDebug() << "RAW BYTES" << data;
 }
 
@@ -576,27 +704,23 @@ void SerialTerminalWidget::onSendOnce() {
         return;
     }
 
-    const qint64 written = m_serial.write(bytes);
-    if (written < 0) {
+    if (!m_txQueue.enqueue(bytes, int(TxSource::Interactive))) {
+        // bounded: refuse rather than buffer without limit behind a slow/held link
         ++m_failCount;
-        if (m_failCountLabel) m_failCountLabel->setText(QString::number(m_failCount));
-        logSystem(QString("Send failed: %1").arg(m_serial.errorString()));
-        emit statusMessage(QString("发送失败: %1").arg(m_serial.errorString()),3000);
+        updateSendCountLabels();
+        logSystem(QString("Send failed: TX queue full (%1 bytes pending).").arg(m_txQueue.stats().queuedBytes));
+        emit statusMessage("发送失败: 发送队列已满",3000);
         return;
     }
 
-    // show in terminal (TX is right aligned)
-    appendMessage(bytes, /*isRx=*/false);
-
+    // echo and the send counter follow when the queue reports the frame written (onTxWritten)
     m_sendEdit->clear();        // 发送成功后清空
     m_sendEdit->setFocus();     // 可选：继续聚焦方便连发
-
-    ++m_sendCount;
-    if (m_sendCountLabel) m_sendCountLabel->setText(QString::number(m_sendCount));
 }
 
 void SerialTerminalWidget::onClearTerminal() {
     if (m_terminalEdit) m_terminalEdit->clear();
+    m_history.clearLive();
     logSystem("Cleared.");
     emit statusMessage("已清空。",3000);
 }
@@ -609,56 +733,235 @@ void SerialTerminalWidget::onTimedSendToggle() {
     }
     if (!m_timedSendCheck || !m_sendIntervalMsSpin || !m_timedSendToggleBtn) return;
 
-    if (!m_timedSendCheck->isChecked()) {
-        // checkbox off => stop
-        if (m_timedSendTimer.isActive()) m_timedSendTimer.stop();
+    if (!m_timedSendCheck->isChecked() || m_txScheduler.isRunning()) {
+        // checkbox off or running => stop
+        stopTimedSend();
         m_timedSendToggleBtn->setText("开始");
         logSystem("Timed send stopped.");
         emit statusMessage("定时发送：已停止。",3000);
         return;
     }
 
-    if (m_timedSendTimer.isActive()) {
-        m_timedSendTimer.stop();
-        m_timedSendToggleBtn->setText("开始");
-        logSystem("Timed send stopped.");
-        emit statusMessage("定时发送：已停止。",3000);
+    TxScheduler::Config cfg;
+    if (m_txSeqDialog && m_txSeqDialog->useSequence()) {
+        QString err;
+        if (!m_txSeqDialog->steps(&cfg.steps, &err)) {
+            logSystem(QString("Timed send: %1").arg(err));
+            emit statusMessage(QString("定时发送：%1").arg(err),3000);
+            return;
+        }
+        cfg.periodNs = m_txSeqDialog->periodNs();
+        cfg.repeat = m_txSeqDialog->repeatCount();
+    } else {
+        // simple mode: the input line, resent every interval (captured at start)
+        TxScheduler::Step step;
+        step.payload = buildTxBytesFromInput(nullptr);
+        cfg.steps.push_back(step);
+        cfg.periodNs = qint64(m_sendIntervalMsSpin->value()) * 1000000LL;
+    }
+    m_txEchoToTerminal = !m_txSeqDialog || m_txSeqDialog->echoEnabled();
+
+    QString err;
+    if (!m_txScheduler.start(cfg, &err)) {
+        logSystem(QString("Timed send failed: %1").arg(err));
+        emit statusMessage(QString("定时发送失败: %1").arg(err),3000);
         return;
     }
+    m_txStatsTimer.start(100);
 
-    const int interval = m_sendIntervalMsSpin->value();
-    m_timedSendTimer.start(interval);
+    const double periodMs = double(cfg.periodNs) / 1e6;
     m_timedSendToggleBtn->setText("停止");
-    logSystem(QString("Timed send started: %1 ms").arg(interval));
-    emit statusMessage(QString("定时发送已开始: %1 ms").arg(interval),3000);
+    logSystem(QString("Timed send started: %1 step(s), period %2 ms").arg(cfg.steps.size()).arg(periodMs, 0, 'g', 6));
+    emit statusMessage(QString("定时发送已开始: %1 ms").arg(periodMs, 0, 'g', 6),3000);
 }
 
-void SerialTerminalWidget::onTimedSendTick() {
-    if (!m_serial.isOpen()) {
-        ++m_failCount;
-        if (m_failCountLabel) m_failCountLabel->setText(QString::number(m_failCount));
+void SerialTerminalWidget::onOpenTxSequence() {
+    if (!m_txSeqDialog) m_txSeqDialog = new TxSequenceDialog(this);
+    m_txSeqDialog->setStats(m_txScheduler.stats());
+    m_txSeqDialog->show();
+    m_txSeqDialog->raise();
+    m_txSeqDialog->activateWindow();
+}
+
+void SerialTerminalWidget::updateSendCountLabels() {
+    const TxScheduler::Stats st = m_txScheduler.isRunning() ? m_txScheduler.stats() : TxScheduler::Stats();
+    if (m_sendCountLabel) m_sendCountLabel->setText(QString::number(m_sendCount));
+    if (m_failCountLabel) m_failCountLabel->setText(QString::number(m_failCount + st.failed));
+}
+
+void SerialTerminalWidget::onTxStatsTick() {
+    flushTxEcho();
+    updateSendCountLabels();
+    if (m_txSeqDialog && m_txSeqDialog->isVisible()) m_txSeqDialog->setStats(m_txScheduler.stats());
+}
+
+void SerialTerminalWidget::onTxFramesReady() {
+    // the scheduler only keeps time; the TX queue is the one writer of the port
+    const QVector<TxScheduler::Frame> frames = m_txScheduler.takeFrames();
+    if (!m_serial.isOpen()) return;
+    for (const auto &f : frames) {
+        const TxSource src = f.cycleStart ? TxSource::TimedCycleStart : TxSource::Timed;
+        if (!m_txQueue.enqueue(f.bytes, int(src))) ++m_failCount;
+    }
+}
+
+void SerialTerminalWidget::onTxWritten(const QByteArray &bytes, qint64 tsNs, int tag) {
+    ++m_sendCount;
+    if (tag == int(TxSource::Interactive)) {
+        flushTxEcho();                                 // keep the terminal in line order
+        appendMessage(bytes, /*isRx=*/false, tsNs);   // TX is right aligned
+        updateSendCountLabels();
         return;
     }
 
-    QString displayAscii;
-    const QByteArray bytes = buildTxBytesFromInput(&displayAscii);
-    if (bytes.isEmpty()) {
-        ++m_failCount;
-        if (m_failCountLabel) m_failCountLabel->setText(QString::number(m_failCount));
+    // the write-side period: what the link actually got, GUI latency included
+    if (tag == int(TxSource::TimedCycleStart)) m_txScheduler.frameWritten(tsNs);
+
+    // timed: echo is rendered as one batch per stats tick, never per payload
+    if (m_txEchoToTerminal) {
+        if (m_txEchoBatch.isEmpty()) m_txEchoBatchTsNs = tsNs;
+        m_txEchoBatch.append(bytes);
+        if (!m_txStatsTimer.isActive()) flushTxEcho();   // tail of a stopped schedule
+    } else if (m_logger.isRunning()) {
+        m_logger.append(tsNs, SessionLogger::Dir::Tx, bytes, sendMode() == DisplayMode::HEX);
+    }
+    if (!m_txStatsTimer.isActive()) updateSendCountLabels();
+}
+
+void SerialTerminalWidget::flushTxEcho() {
+    if (m_txEchoBatch.isEmpty()) return;
+    appendMessage(m_txEchoBatch, /*isRx=*/false, m_txEchoBatchTsNs);
+    m_txEchoBatch.clear();
+}
+
+void SerialTerminalWidget::onTxQueueStatsTick() {
+    if (!m_txQueueStatsLabel) return;
+    const TxQueue::Stats st = m_txQueue.stats();
+    QString text = QString("TX 排队 %1 B  %2 B/s  %3%")
+                       .arg(st.queuedBytes + st.inFlightBytes)
+                       .arg(qint64(st.drainedBps))
+                       .arg(st.utilization * 100.0, 0, 'f', 0);
+    if (st.ctsHeld) text += "  CTS暂停";
+    m_txQueueStatsLabel->setText(text);
+}
+
+void SerialTerminalWidget::onOpenFileTransfer() {
+    if (!m_fileDialog) {
+        m_fileDialog = new FileTransferDialog(this);
+        connect(m_fileDialog, &FileTransferDialog::startRequested, this, &SerialTerminalWidget::onFileTransferStart);
+        connect(m_fileDialog, &FileTransferDialog::cancelRequested, &m_fileTransfer, &FileTransfer::cancel);
+    }
+    m_fileDialog->show();
+    m_fileDialog->raise();
+    m_fileDialog->activateWindow();
+}
+
+void SerialTerminalWidget::onFileTransferStart() {
+    if (m_fileTransfer.isRunning() || !m_fileDialog) return;
+    if (!m_serial.isOpen() || !m_portCombo) {
+        logSystem("File send: port not open.");
+        emit statusMessage("文件发送：端口未打开",3000);
+        m_fileDialog->setStatusText("请先打开串口（使用当前串口参数发送）。");
         return;
     }
 
-    const qint64 written = m_serial.write(bytes);
-    if (written < 0) {
-        ++m_failCount;
-        if (m_failCountLabel) m_failCountLabel->setText(QString::number(m_failCount));
+    FileTransfer::Config cfg;
+    cfg.port.portName = m_portCombo->currentData().toString();
+    cfg.port.baud = m_serial.baudRate();
+    cfg.port.dataBits = m_serial.dataBits();
+    cfg.port.parity = m_serial.parity();
+    cfg.port.stopBits = m_serial.stopBits();
+    cfg.port.flow = m_serial.flowControl();
+    cfg.port.dtr = m_serial.isDataTerminalReady();
+    cfg.port.rts = m_serial.isRequestToSend();
+    cfg.protocol = m_fileDialog->protocol();
+    cfg.files = m_fileDialog->files();
+    cfg.rawChunk = m_fileDialog->rawChunk();
+    cfg.rawPaced = m_fileDialog->rawPaced();
+    cfg.maxRetries = m_fileDialog->maxRetries();
+
+    // hand the device over to the worker; remember how to give it back
+    m_reopenAfterTransfer = m_serial.isOpen();
+    m_transferDtr = cfg.port.dtr;
+    m_transferRts = cfg.port.rts;
+    stopTimedSend();
+    m_txQueue.clear();
+    m_txQueueStatsTimer.stop();
+    m_serial.close();
+
+    QString err;
+    if (!m_fileTransfer.start(cfg, &err)) {
+        m_fileDialog->setStatusText(err);
+        onFileTransferFinished(false, err);
         return;
     }
+    setTransferUi(true);
+    m_fileDialog->setRunning(true);
+    m_fileDialog->setStatusText("发送中…");
+    m_fileProgressTimer.start(200);
+    logSystem(QString("File send started: %1 file(s)").arg(cfg.files.size()));
+}
 
-    appendMessage(bytes, /*isRx=*/false);
+void SerialTerminalWidget::onFileTransferProgressTick() {
+    if (m_fileDialog) m_fileDialog->setProgress(m_fileTransfer.progress());
+}
 
-    ++m_sendCount;
-    if (m_sendCountLabel) m_sendCountLabel->setText(QString::number(m_sendCount));
+void SerialTerminalWidget::onFileTransferFinished(bool ok, const QString &msg) {
+    m_fileTransfer.wait();
+    m_fileProgressTimer.stop();
+    if (m_fileDialog) {
+        m_fileDialog->setProgress(m_fileTransfer.progress());
+        m_fileDialog->setRunning(false);
+        m_fileDialog->setStatusText(ok ? QString("完成：%1").arg(msg) : QString("失败：%1").arg(msg));
+    }
+    logSystem(ok ? QString("File send done: %1").arg(msg) : QString("File send failed: %1").arg(msg));
+    emit statusMessage(ok ? "文件发送完成" : QString("文件发送失败: %1").arg(msg),3000);
+
+    // take the device back with the unchanged settings, only if the terminal had it
+    setTransferUi(false);
+    if (!m_reopenAfterTransfer) return;
+    m_reopenAfterTransfer = false;
+    if (!m_serial.open(QIODevice::ReadWrite)) {
+        logSystem(QString("Reopen failed: %1").arg(m_serial.errorString()));
+        emit statusMessage(QString("重新打开失败: %1").arg(m_serial.errorString()), 3000);
+        setConnectedUi(false);
+        return;
+    }
+    m_serial.setDataTerminalReady(m_transferDtr);
+    if (m_serial.flowControl() != QSerialPort::HardwareControl) m_serial.setRequestToSend(m_transferRts);
+    m_txQueue.clear();
+    m_txQueueStatsTimer.start(500);
+}
+
+void SerialTerminalWidget::setTransferUi(bool busy) {
+    if (!isUiComplete()) return;
+    m_closeBtn->setEnabled(!busy);
+    m_sendBtn->setEnabled(!busy);
+    m_sendEdit->setEnabled(!busy);
+    m_timedSendCheck->setEnabled(!busy);
+    m_timedSendToggleBtn->setEnabled(!busy);
+}
+
+void SerialTerminalWidget::stopTimedSend() {
+    if (!m_txScheduler.isRunning()) return;
+
+    m_txScheduler.stop();
+    onTxFramesReady();   // payloads released before the stop still go out
+    onTxStatsTick();     // flush the last echo batch
+    m_txStatsTimer.stop();
+
+    const TxScheduler::Stats st = m_txScheduler.stats();
+    m_failCount += st.failed;
+    if (m_txSeqDialog) m_txSeqDialog->setStats(st);
+    updateSendCountLabels();
+}
+
+void SerialTerminalWidget::onTxSchedulerFinished() {
+    if (!m_txScheduler.isRunning()) return;
+    stopTimedSend();
+    if (m_timedSendToggleBtn) m_timedSendToggleBtn->setText("开始");
+    logSystem("Timed send finished.");
+    emit statusMessage("定时发送：已完成。",3000);
 }
 
 void SerialTerminalWidget::closeIfOpen() {
@@ -667,7 +970,7 @@ void SerialTerminalWidget::closeIfOpen() {
     }
 }
 
-void SerialTerminalWidget::emitLinesFromRxBytes(const QByteArray &data) {
+void SerialTerminalWidget::emitLinesFromRxBytes(const QByteArray &data, qint64 tsNs) {
     // normalize: \r\n -> \n, \r -> \n
     QByteArray buf = data;
     buf.replace("\r\n", "\n");
@@ -685,7 +988,7 @@ void SerialTerminalWidget::emitLinesFromRxBytes(const QByteArray &data) {
         lineBytes = lineBytes.trimmed();
         if (lineBytes.isEmpty()) continue;
 
-        emit rxLineReceived(QString::fromLatin1(lineBytes));
+        emit rxLineReceived(QString::fromLatin1(lineBytes), tsNs);
     }
 
     // 防止 MCU 一直不发 '\n' 导致 buffer 无限增长
@@ -693,3 +996,231 @@ void SerialTerminalWidget::emitLinesFromRxBytes(const QByteArray &data) {
         m_rxLineBuf = m_rxLineBuf.right(200'000);
     }
 }
+
+void SerialTerminalWidget::setLogConfigUiEnabled(bool enabled) {
+    if (m_logDirBtn) m_logDirBtn->setEnabled(enabled);
+    if (m_logRotateMbSpin) m_logRotateMbSpin->setEnabled(enabled);
+    if (m_logRotateTimeCombo) m_logRotateTimeCombo->setEnabled(enabled);
+    if (m_logMaxTotalGbSpin) m_logMaxTotalGbSpin->setEnabled(enabled);
+    if (m_logCompressCheck) m_logCompressCheck->setEnabled(enabled);
+}
+
+void SerialTerminalWidget::onPickLogDir() {
+    const QString dir = QFileDialog::getExistingDirectory(this, "选择日志目录", m_logDir);
+    if (dir.isEmpty()) return;
+
+    m_logDir = dir;
+    if (m_logDirLabel) {
+        m_logDirLabel->setText(QDir::toNativeSeparators(m_logDir));
+        m_logDirLabel->setToolTip(m_logDirLabel->text());
+    }
+}
+
+void SerialTerminalWidget::onLogToggled(bool on) {
+    if (!on) {
+        if (!m_logger.isRunning()) return;
+        m_logger.stop();
+        m_logStatsTimer.stop();
+        onLogStatsTick();
+        setLogConfigUiEnabled(true);
+        logSystem("Logging stopped.");
+        emit statusMessage("日志记录已停止。", 3000);
+        return;
+    }
+
+    SessionLogger::Config cfg;
+    cfg.dir = m_logDir;
+    if (m_logRotateMbSpin) cfg.rotateBytes = qint64(m_logRotateMbSpin->value()) * 1024 * 1024;
+    if (m_logRotateTimeCombo) cfg.rotateSeconds = m_logRotateTimeCombo->currentData().toInt();
+    if (m_logMaxTotalGbSpin) cfg.maxTotalBytes = qint64(m_logMaxTotalGbSpin->value()) * 1024 * 1024 * 1024;
+    if (m_logCompressCheck) cfg.compress = m_logCompressCheck->isChecked();
+
+    QString err;
+    if (!m_logger.start(cfg, &err)) {
+        logSystem(QString("Log start failed: %1").arg(err));
+        emit statusMessage(QString("日志启动失败: %1").arg(err), 5000);
+        if (m_logToFileCheck) {
+            const QSignalBlocker block(m_logToFileCheck);
+            m_logToFileCheck->setChecked(false);
+        }
+        return;
+    }
+
+    setLogConfigUiEnabled(false);
+    m_logStatsTimer.start(1000);
+    logSystem(QString("Logging to %1").arg(QDir::toNativeSeparators(m_logger.directory())));
+    emit statusMessage("日志记录已开始。", 3000);
+}
+
+void SerialTerminalWidget::onLogStatsTick() {
+    if (!m_logStatsLabel) return;
+    const double mb = double(m_logger.writtenBytes()) / (1024.0 * 1024.0);
+    const quint64 dropped = m_logger.droppedBytes();
+    m_logStatsLabel->setText(dropped
+                                 ? QString("已写 %1 MB，丢弃 %2 B").arg(mb, 0, 'f', 1).arg(dropped)
+                                 : QString("已写 %1 MB").arg(mb, 0, 'f', 1));
+}
+
+void SerialTerminalWidget::onOpenHistorySearch() {
+    if (!m_searchDialog) {
+        m_searchDialog = new HistorySearchDialog(&m_history, this);
+        connect(m_searchDialog, &HistorySearchDialog::jumpRequested,
+                this, &SerialTerminalWidget::onJumpToMatch);
+    }
+    m_searchDialog->show();
+    m_searchDialog->raise();
+    m_searchDialog->activateWindow();
+    m_searchDialog->focusQuery();
+}
+
+void SerialTerminalWidget::onJumpToMatch(qint64 tsNs, const QString &lineText, const QString &matchText) {
+    if (!m_terminalEdit) return;
+
+    // the divider of the chunk carries its arrival time: "[HH:mm:ss.zzzuuu]---"
+    QString key;
+    if (tsNs >= 0) {
+        key = m_tsClock.formatHmsUs(tsNs);
+    } else {
+        // log file lines start with the same timestamp text
+        static const QRegularExpression reTs(R"(^(\d{2}:\d{2}:\d{2}\.\d{6}))");
+        const auto m = reTs.match(lineText);
+        if (m.hasMatch()) key = m.captured(1);
+    }
+
+    QTextDocument *doc = m_terminalEdit->document();
+    QTextCursor anchor;
+    if (!key.isEmpty()) anchor = doc->find(QString("[%1]").arg(key));
+
+    QTextCursor hit;
+    if (!matchText.isEmpty()) {
+        hit = anchor.isNull() ? doc->find(matchText) : doc->find(matchText, anchor);
+    }
+    if (hit.isNull()) hit = anchor;
+
+    if (hit.isNull()) {
+        emit statusMessage("该结果已不在终端显示范围内。", 3000);
+        return;
+    }
+    m_terminalEdit->setTextCursor(hit);
+    m_terminalEdit->ensureCursorVisible();
+}
+
+void SerialTerminalWidget::onEditTriggers() {
+    TriggerRulesDialog dlg(m_triggers.rules(), this);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    // compiled by the dialog (off the GUI thread); installed as is
+    m_triggers = dlg.takeEngine();
+    const QVector<TriggerEngine::Rule> &rules = m_triggers.rules();
+
+    m_triggerCounts = QVector<quint64>(rules.size(), 0);
+    m_triggerTotal = 0;
+    updateTriggerStats(-1, 0);
+
+    int enabled = 0;
+    for (const auto &r : rules) if (r.enabled) ++enabled;
+    logSystem(QString("Triggers: %1 rule(s) active, %2 states.").arg(enabled).arg(m_triggers.stateCount()));
+    emit statusMessage(QString("触发规则已更新：%1 条").arg(enabled), 3000);
+}
+
+void SerialTerminalWidget::onPauseViewToggled(bool paused) {
+    if (m_viewPaused == paused) return;
+    m_viewPaused = paused;
+    if (m_pauseViewBtn) m_pauseViewBtn->setText(paused ? "继续显示" : "暂停显示");
+    logSystem(paused ? "View paused." : "View resumed.");
+}
+
+static bool isPrintableLatin1(const QByteArray &bytes) {
+    for (char ch : bytes) {
+        const unsigned char b = static_cast<unsigned char>(ch);
+        if (b < 0x20 || b == 0x7F) return false;
+    }
+    return true;
+}
+
+void SerialTerminalWidget::handleTriggerEvents(const QByteArray &chunk, quint64 chunkOffset, int bodyStart) {
+    const auto &rules = m_triggers.rules();
+    if (m_triggerCounts.size() != rules.size()) m_triggerCounts = QVector<quint64>(rules.size(), 0);
+
+    // highlight only where the rendered text equals the bytes (ASCII view, printable match)
+    QTextDocument *doc = m_terminalEdit ? m_terminalEdit->document() : nullptr;
+    const bool canHighlight = doc && bodyStart >= 0 && !m_viewPaused && recvMode() == DisplayMode::ASCII;
+    QTextCursor chunkStart;
+    if (canHighlight) {
+        // past the [time]--- header appendMessage wrote: matches land in the received bytes only
+        chunkStart = QTextCursor(doc);
+        chunkStart.setPosition(qBound(0, bodyStart, doc->characterCount() - 1));
+    }
+    QTextCursor from = chunkStart;
+    qint64 lastStart = -1;
+
+    QTextCharFormat hitFmt;
+    hitFmt.setBackground(QColor(255, 225, 110));
+
+    int lastCounted = -1;
+    qint64 lastTsNs = 0;
+    int pauseRule = -1;
+    int captureRule = -1;
+
+    for (const auto &ev : m_triggerEvents) {
+        const auto &rule = rules[ev.rule];
+
+        if (rule.actions & TriggerEngine::Count) {
+            ++m_triggerCounts[ev.rule];
+            ++m_triggerTotal;
+            lastCounted = ev.rule;
+            lastTsNs = ev.tsNs;
+        }
+        if ((rule.actions & TriggerEngine::PauseView) && pauseRule < 0) pauseRule = ev.rule;
+        if ((rule.actions & TriggerEngine::StartCapture) && captureRule < 0) captureRule = ev.rule;
+
+        if (!canHighlight || !(rule.actions & TriggerEngine::Highlight) || ev.length <= 0) continue;
+        const qint64 start = qint64(ev.endOffset) - ev.length - qint64(chunkOffset);
+        if (start < 0) continue;   // began in an earlier chunk
+        const QByteArray hit = chunk.mid(int(start), ev.length);
+        if (!isPrintableLatin1(hit)) continue;
+
+        if (start < lastStart) from = chunkStart;   // overlapping rules: rescan this chunk
+        QTextCursor c = doc->find(QString::fromLatin1(hit), from, QTextDocument::FindCaseSensitively);
+        if (c.isNull()) continue;
+        c.mergeCharFormat(hitFmt);
+        from = c;
+        lastStart = start;
+    }
+
+    if (lastCounted >= 0) updateTriggerStats(lastCounted, lastTsNs);
+
+    if (captureRule >= 0 && m_logToFileCheck && !m_logToFileCheck->isChecked()) {
+        logSystem(QString("Trigger '%1': starting capture.").arg(rules[captureRule].name));
+        m_logToFileCheck->setChecked(true);   // -> onLogToggled
+    }
+
+    if (pauseRule >= 0 && !m_viewPaused) {
+        logSystem(QString("Trigger '%1' fired.").arg(rules[pauseRule].name));
+        if (m_pauseViewBtn) m_pauseViewBtn->setChecked(true);   // -> onPauseViewToggled
+        else onPauseViewToggled(true);
+        emit statusMessage(QString("触发「%1」：显示已暂停").arg(rules[pauseRule].name), 3000);
+    }
+}
+
+void SerialTerminalWidget::updateTriggerStats(int lastRule, qint64 lastTsNs) {
+    if (!m_triggerStatsLabel) return;
+
+    const auto &rules = m_triggers.rules();
+    if (lastRule < 0 || lastRule >= rules.size()) {
+        m_triggerStatsLabel->setText(m_triggers.isEmpty() ? QString("未设置规则")
+                                                          : QString("命中 %1").arg(m_triggerTotal));
+    } else {
+        m_triggerStatsLabel->setText(QString("命中 %1 · %2 @%3")
+                                         .arg(m_triggerTotal)
+                                         .arg(rules[lastRule].name, m_tsClock.formatHmsZ(lastTsNs)));
+    }
+
+    QStringList lines;
+    for (int i = 0; i < rules.size() && i < m_triggerCounts.size(); ++i) {
+        if (rules[i].actions & TriggerEngine::Count) {
+            lines << QString("%1: %2").arg(rules[i].name).arg(m_triggerCounts[i]);
+        }
+    }
+    m_triggerStatsLabel->setToolTip(lines.join('\n'));
+}
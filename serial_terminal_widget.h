@@ -3,7 +3,15 @@
 #include <QWidget>
 #include <QSerialPort>
 #include <QTimer>
-#include <QElapsedTimer>
+
+#include "timestamp_clock.h"
+#include "hex_dump.h"
+#include "session_logger.h"
+#include "history_search.h"
+#include "trigger_engine.h"
+#include "tx_scheduler.h"
+#include "tx_queue.h"
+#include "file_transfer.h"
 
 class QComboBox;
 class QPushButton;
@@ -13,6 +21,9 @@ class QRadioButton;
 class QCheckBox;
 class QSpinBox;
 class QLabel;
+class HistorySearchDialog;
+class TxSequenceDialog;
+class FileTransferDialog;
 
 class SerialTerminalWidget final : public QWidget {
     Q_OBJECT
@@ -24,6 +35,7 @@ public:
 
 private slots:
     void onRefreshPorts();
+    void onPortsChanged(const QStringList &added, const QStringList &removed);
     void onOpenPort();
     void onClosePort();
 
@@ -32,18 +44,45 @@ private slots:
     void onClearTerminal();
 
     void onTimedSendToggle();
-    void onTimedSendTick();
+    void onOpenTxSequence();
+    void onTxStatsTick();
+    void onTxFramesReady();
+    void onTxWritten(const QByteArray &bytes, qint64 tsNs, int tag);
+    void onTxSchedulerFinished();
+    void onTxQueueStatsTick();
+
+    void onOpenFileTransfer();
+    void onFileTransferStart();
+    void onFileTransferFinished(bool ok, const QString &msg);
+    void onFileTransferProgressTick();
+
+    void onOpenHistorySearch();
+    void onJumpToMatch(qint64 tsNs, const QString &lineText, const QString &matchText);
+
+    void onEditTriggers();
+    void onPauseViewToggled(bool paused);
+
+    void onLogToggled(bool on);
+    void onPickLogDir();
+    void onLogStatsTick();
 
 private:
     enum class DisplayMode { ASCII, HEX };
+    enum class TxSource : int { Interactive, Timed, TimedCycleStart };   // TxQueue tag
 
     void bindUi(QWidget *root);
     bool isUiComplete() const;
 
     void setConnectedUi(bool connected);
+    void stopTimedSend();
+    void updateSendCountLabels();
+    void flushTxEcho();
+    void setTransferUi(bool busy);
     void logSystem(const QString &msg);
-    void appendDividerLine();
-    void appendMessage(const QByteArray &bytes, bool isRx);
+    void appendDividerLine(qint64 tsNs);
+    void appendMessage(const QByteArray &bytes, bool isRx, qint64 tsNs);
+    void handleTriggerEvents(const QByteArray &chunk, quint64 chunkOffset, int bodyStart);
+    void updateTriggerStats(int lastRule, qint64 lastTsNs);
 
     // rendering helpers
     DisplayMode recvMode() const;
@@ -56,16 +95,18 @@ private:
                                const QColor &normalColor, const QColor &escapeColor);
 
     QVector<QPair<QString,bool>> renderAsciiSegments(const QByteArray &bytes, bool escapesEnabled) const;
-    QString renderHexString(const QByteArray &bytes) const;
+    QString renderHexString(const QByteArray &bytes) const;   // compact "AA BB" (TX)
+    QString renderHexDump(const QByteArray &bytes);           // offset | hex | ascii (RX)
 
     // auto wrap
-    void maybeAutoWrapBeforeNewMessage();
+    void maybeAutoWrapBeforeNewMessage(qint64 tsNs);
 
-    // port list filter (macOS)
-    static bool acceptPortPath(const QString &sysPath);
+    // port list comes from PortRegistry; held back while the port is open
+    void populatePorts();
+    bool m_portsDirty = false;
 
     QByteArray m_rxLineBuf;              // NEW: buffer for assembling lines
-    void emitLinesFromRxBytes(const QByteArray &data); // NEW
+    void emitLinesFromRxBytes(const QByteArray &data, qint64 tsNs); // NEW
     // UI pointers (found by objectName)
     QComboBox   *m_portCombo = nullptr;
     QPushButton *m_refreshPortsBtn = nullptr;
@@ -81,9 +122,12 @@ private:
 
     QTextEdit   *m_terminalEdit = nullptr;
     QPushButton *m_clearBtn = nullptr;
+    QPushButton *m_searchHistoryBtn = nullptr;      // optional
+    QPushButton *m_fileTransferBtn = nullptr;       // optional
 
     QComboBox   *m_recvModeCombo = nullptr;
     QRadioButton *m_showEscapesRadio = nullptr;
+    QComboBox   *m_hexBytesPerRowCombo = nullptr;   // optional
 
     QCheckBox   *m_autoWrapCheck = nullptr;
     QSpinBox    *m_autoWrapMsSpin = nullptr;
@@ -95,22 +139,81 @@ private:
     QCheckBox   *m_timedSendCheck = nullptr;
     QSpinBox    *m_sendIntervalMsSpin = nullptr;
     QPushButton *m_timedSendToggleBtn = nullptr;
+    QPushButton *m_txSequenceBtn = nullptr;          // optional
     QLabel      *m_sendCountLabel = nullptr;
     QLabel      *m_failCountLabel = nullptr;
+    QLabel      *m_txQueueStatsLabel = nullptr;      // optional
+
+    // session log (optional group)
+    QCheckBox   *m_logToFileCheck = nullptr;
+    QPushButton *m_logDirBtn = nullptr;
+    QLabel      *m_logDirLabel = nullptr;
+    QSpinBox    *m_logRotateMbSpin = nullptr;
+    QComboBox   *m_logRotateTimeCombo = nullptr;
+    QSpinBox    *m_logMaxTotalGbSpin = nullptr;
+    QCheckBox   *m_logCompressCheck = nullptr;
+    QLabel      *m_logStatsLabel = nullptr;
+
+    // triggers (optional group)
+    QPushButton *m_triggerRulesBtn = nullptr;
+    QPushButton *m_pauseViewBtn = nullptr;
+    QLabel      *m_triggerStatsLabel = nullptr;
 
     // serial
     QSerialPort m_serial;
 
-    // timed send
-    QTimer m_timedSendTimer;
-    quint64 m_sendCount = 0;
+    // interactive sends: bounded queue fed by bytesWritten, flow-control aware
+    TxQueue m_txQueue{&m_serial};
+    QTimer m_txQueueStatsTimer;
+
+    // timed send: precision scheduler thread releases payloads, the GUI writes them through m_txQueue
+    TxScheduler m_txScheduler;
+    QTimer m_txStatsTimer;
+    TxSequenceDialog *m_txSeqDialog = nullptr;
+    bool m_txEchoToTerminal = true;
+    QByteArray m_txEchoBatch;    // timed frames written since the last stats tick
+    qint64 m_txEchoBatchTsNs = 0;
+    quint64 m_sendCount = 0;     // frames completely written to the driver, interactive and timed
     quint64 m_failCount = 0;
 
+    // file send: the worker owns the device while it runs; the terminal reopens it afterwards
+    FileTransfer m_fileTransfer;
+    FileTransferDialog *m_fileDialog = nullptr;
+    bool m_reopenAfterTransfer = false;   // the terminal had the port open when the transfer took it
+    bool m_transferDtr = false;
+    bool m_transferRts = false;
+    QTimer m_fileProgressTimer;
+
+    // HEX dump: running RX stream offset (bytes received since open)
+    HexDumpFormatter m_hexDump;
+    quint64 m_rxStreamOffset = 0;
+
+    // raw RX history + background index (search)
+    HistoryIndex m_history;
+    HistorySearchDialog *m_searchDialog = nullptr;
+
+    // stream triggers: one automaton over every RX byte
+    TriggerEngine m_triggers;
+    QVector<TriggerEngine::Event> m_triggerEvents;   // scratch, reused per chunk
+    QVector<quint64> m_triggerCounts;               // per rule
+    quint64 m_triggerTotal = 0;
+    bool m_viewPaused = false;                      // RX still logged/indexed, just not rendered
+
+    // session log
+    SessionLogger m_logger;
+    QString m_logDir;
+    QTimer m_logStatsTimer;
+    void setLogConfigUiEnabled(bool enabled);
+
     // auto wrap timing
-    qint64 m_lastMessageMs = -1; // monotonic ms
-    QElapsedTimer m_mono;
+    qint64 m_lastMessageNs = -1; // monotonic ns
+    int m_lastMessageBodyPos = -1;   // document position after the last message's divider line
+
+    // timestamps: chunks are stamped at read time, formatted with cached prefix
+    TimestampClock m_tsClock;
 
 signals:
     void statusMessage(const QString &msg, int timeoutMs = 0);
-    void rxLineReceived(const QString &line);
+    // tsNs: CLOCK_MONOTONIC ns of the chunk that completed the line
+    void rxLineReceived(const QString &line, qint64 tsNs);
 };
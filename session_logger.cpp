@@ -0,0 +1,329 @@
+#include "session_logger.h"
+#include "hex_dump.h"
+#include "byte_runs.h"
+
+#include <QThread>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutexLocker>
+
+#include <cstring>
+
+#include <zlib.h>
+
+namespace {
+constexpr int kMaxPendingBytes = 64 * 1024 * 1024;   // GUI side never waits; beyond this we drop
+constexpr int kWriteChunk = 1024 * 1024;             // one write() per ~1 MiB of formatted text
+constexpr qint64 kFlushIntervalNs = 1000000000LL;    // flush partial buffers at least once a second
+
+struct RecordHeader {
+    qint64 tsNs;
+    qint32 len;
+    char dir;
+    char hex;
+    char pad[2];
+};
+}
+
+SessionLogger::SessionLogger(QObject *parent)
+    : QObject(parent) {
+    // one compressor at a time: keeps disk I/O polite and makes the size limit sweep race-free
+    m_compressPool.setMaxThreadCount(1);
+}
+
+SessionLogger::~SessionLogger() {
+    stop();
+}
+
+bool SessionLogger::start(const Config &cfg, QString *err) {
+    stop();
+
+    m_cfg = cfg;
+    if (m_cfg.dir.isEmpty()) {
+        if (err) *err = "log directory not set";
+        return false;
+    }
+    if (!QDir().mkpath(m_cfg.dir)) {
+        if (err) *err = QString("cannot create %1").arg(m_cfg.dir);
+        return false;
+    }
+
+    {
+        QMutexLocker lk(&m_mutex);
+        m_pending.clear();
+        m_stopRequested = false;
+    }
+    m_segmentSeq = 0;
+    m_written = 0;
+    m_dropped = 0;
+    m_failed = false;
+
+    // the file lives on the writer thread: it opens the first segment itself and reports
+    // a failure through error(), after which append() is a no-op
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("SessionLogger");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void SessionLogger::stop() {
+    if (!m_thread) return;
+
+    {
+        QMutexLocker lk(&m_mutex);
+        m_stopRequested = true;
+        m_cond.wakeOne();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    m_compressPool.waitForDone();
+}
+
+QString SessionLogger::currentSegmentPath() const {
+    QMutexLocker lk(&m_pathMutex);
+    return m_segmentPath;
+}
+
+void SessionLogger::append(qint64 tsNs, Dir dir, const QByteArray &bytes, bool hex) {
+    if (!m_thread || bytes.isEmpty()) return;
+
+    RecordHeader h{};
+    h.tsNs = tsNs;
+    h.len = qint32(bytes.size());
+    h.dir = char(dir);
+    h.hex = hex ? 1 : 0;
+
+    QMutexLocker lk(&m_mutex);
+    if (m_failed.load()) return;
+    if (m_pending.size() + qint64(sizeof(h)) + bytes.size() > kMaxPendingBytes) {
+        m_dropped += quint64(bytes.size());
+        return;
+    }
+    const bool wasEmpty = m_pending.isEmpty();
+    m_pending.append(reinterpret_cast<const char *>(&h), int(sizeof(h)));
+    m_pending.append(bytes);
+    if (wasEmpty) m_cond.wakeOne();
+}
+
+void SessionLogger::run() {
+    QByteArray records;
+    QByteArray out;
+    out.reserve(2 * kWriteChunk);
+    qint64 lastFlushNs = TimestampClock::nowNs();
+
+    // no segment to write to: refuse further records and let the owner turn logging off
+    auto fail = [this](const QString &err) {
+        {
+            QMutexLocker lk(&m_mutex);
+            m_failed = true;
+            m_pending.clear();
+        }
+        emit error(err);
+    };
+
+    {
+        QString err;
+        if (!openSegment(&err)) {
+            fail(err);
+            return;
+        }
+    }
+
+    auto writeOut = [&]() {
+        if (out.isEmpty() || !m_file.isOpen()) return;
+        const qint64 n = m_file.write(out);
+        if (n < 0) {
+            emit error(QString("write failed: %1").arg(m_file.errorString()));
+        } else {
+            m_segmentBytes += n;
+            m_written += quint64(n);
+        }
+        out.resize(0);
+    };
+
+    for (;;) {
+        bool stopping = false;
+        {
+            QMutexLocker lk(&m_mutex);
+            if (m_pending.isEmpty() && !m_stopRequested) m_cond.wait(&m_mutex, 250);
+            records.swap(m_pending);
+            m_pending.resize(0);
+            stopping = m_stopRequested;
+        }
+
+        formatRecords(records, &out);
+        records.resize(0);
+
+        const qint64 now = TimestampClock::nowNs();
+        if (out.size() >= kWriteChunk || stopping || (now - lastFlushNs) >= kFlushIntervalNs) {
+            writeOut();
+            lastFlushNs = now;
+        }
+
+        // rotation (only ever between whole lines: `out` was just flushed or holds full lines)
+        const bool bySize = m_cfg.rotateBytes > 0 && m_segmentBytes >= m_cfg.rotateBytes;
+        const bool byTime = m_cfg.rotateSeconds > 0 && m_segmentBytes > 0 &&
+                            (now - m_segmentOpenedNs) >= qint64(m_cfg.rotateSeconds) * 1000000000LL;
+        if (!stopping && (bySize || byTime)) {
+            writeOut();
+            closeSegment();
+            QString err;
+            if (!openSegment(&err)) {
+                fail(err);
+                return;
+            }
+        }
+
+        if (stopping) break;
+    }
+
+    writeOut();
+    closeSegment();
+}
+
+bool SessionLogger::openSegment(QString *err) {
+    const QString name = QString("%1_%2_%3.log")
+                             .arg(m_cfg.baseName,
+                                  QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+                             .arg(++m_segmentSeq, 3, 10, QLatin1Char('0'));
+    const QString path = QDir(m_cfg.dir).filePath(name);
+
+    m_file.setFileName(path);
+    // we batch ~1 MiB ourselves; skip QFile's own buffer
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        if (err) *err = QString("cannot open %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    {
+        QMutexLocker lk(&m_pathMutex);
+        m_segmentPath = path;
+    }
+    m_segmentBytes = 0;
+    m_segmentOpenedNs = TimestampClock::nowNs();
+    return true;
+}
+
+void SessionLogger::closeSegment() {
+    if (!m_file.isOpen()) return;
+    m_file.close();
+
+    QString path;
+    {
+        QMutexLocker lk(&m_pathMutex);
+        path = m_segmentPath;
+        m_segmentPath.clear();
+    }
+    emit segmentClosed(path);
+
+    if (m_cfg.compress) {
+        m_compressPool.start([this, path]() {
+            if (gzipFile(path, path + ".gz")) QFile::remove(path);
+            enforceTotalLimit();
+        });
+    } else {
+        m_compressPool.start([this]() { enforceTotalLimit(); });
+    }
+}
+
+static void appendEscaped(const char *p, int len, QVector<ByteRun> *runs, QByteArray *out) {
+    static const char kDigits[] = "0123456789ABCDEF";
+    runs->resize(0);
+    classifyByteRuns(p, len, runs);
+    for (const ByteRun &r : *runs) {
+        if (!r.control) {
+            out->append(p + r.offset, r.length);
+            continue;
+        }
+        for (int i = 0; i < r.length; ++i) {
+            const unsigned char b = static_cast<unsigned char>(p[r.offset + i]);
+            if (b == '\t') { out->append('\t'); continue; }
+            if (b == '\r') { out->append("\\r", 2); continue; }
+            const char esc[4] = {'\\', 'x', kDigits[b >> 4], kDigits[b & 0x0F]};
+            out->append(esc, 4);
+        }
+    }
+}
+
+void SessionLogger::formatRecords(const QByteArray &records, QByteArray *out) {
+    QVector<ByteRun> runs;
+    const char *base = records.constData();
+    int pos = 0;
+
+    while (pos + int(sizeof(RecordHeader)) <= records.size()) {
+        RecordHeader h;
+        std::memcpy(&h, base + pos, sizeof(h));
+        pos += int(sizeof(h));
+        if (h.len < 0 || pos + h.len > records.size()) break;
+        const char *p = base + pos;
+        pos += h.len;
+
+        const char *tag = (h.dir == char(Dir::Rx)) ? " RX " : (h.dir == char(Dir::Tx)) ? " TX " : " -- ";
+
+        if (h.hex) {
+            m_clock.appendHmsUs(h.tsNs, out);
+            out->append(tag, 4);
+            HexDumpFormatter::encodeSpaced(p, h.len, out);
+            out->append('\n');
+            continue;
+        }
+
+        // ASCII: one log line per '\n'-terminated piece, trailing '\r' dropped
+        int start = 0;
+        while (start < h.len) {
+            const void *nl = std::memchr(p + start, '\n', size_t(h.len - start));
+            const int end = nl ? int(static_cast<const char *>(nl) - p) : h.len;
+            int lineLen = end - start;
+            if (lineLen > 0 && p[start + lineLen - 1] == '\r') --lineLen;
+
+            m_clock.appendHmsUs(h.tsNs, out);
+            out->append(tag, 4);
+            appendEscaped(p + start, lineLen, &runs, out);
+            out->append('\n');
+
+            start = end + 1;
+        }
+    }
+}
+
+void SessionLogger::enforceTotalLimit() {
+    if (m_cfg.maxTotalBytes <= 0) return;
+
+    QDir dir(m_cfg.dir);
+    const QStringList filters{m_cfg.baseName + "_*.log", m_cfg.baseName + "_*.log.gz"};
+    // names embed the open time, so name order == age order
+    const QFileInfoList files = dir.entryInfoList(filters, QDir::Files, QDir::Name);
+
+    qint64 total = 0;
+    for (const QFileInfo &fi : files) total += fi.size();
+
+    const QString current = currentSegmentPath();
+    for (const QFileInfo &fi : files) {
+        if (total <= m_cfg.maxTotalBytes) break;
+        if (fi.absoluteFilePath() == QFileInfo(current).absoluteFilePath()) continue;
+        if (QFile::remove(fi.absoluteFilePath())) total -= fi.size();
+    }
+}
+
+bool SessionLogger::gzipFile(const QString &src, const QString &dst) {
+    QFile in(src);
+    if (!in.open(QIODevice::ReadOnly)) return false;
+
+    gzFile gz = gzopen(QFile::encodeName(dst).constData(), "wb6");
+    if (!gz) return false;
+
+    QByteArray buf(256 * 1024, Qt::Uninitialized);
+    bool ok = true;
+    for (;;) {
+        const qint64 n = in.read(buf.data(), buf.size());
+        if (n < 0) { ok = false; break; }
+        if (n == 0) break;
+        if (gzwrite(gz, buf.constData(), unsigned(n)) != int(n)) { ok = false; break; }
+    }
+    if (gzclose(gz) != Z_OK) ok = false;
+    if (!ok) QFile::remove(dst);
+    return ok;
+}
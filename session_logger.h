@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QFile>
+
+#include <atomic>
+
+#include "timestamp_clock.h"
+
+class QThread;
+
+// 终端会话日志：GUI 线程只把记录追加到内存队列（不阻塞），
+// 后台线程负责格式化（时间戳 / 方向 / ASCII 或 HEX）、大块写盘、按大小或时间分段；
+// 关闭的分段可在线程池里 gzip 压缩，超过总量上限时删除最旧的分段。
+class SessionLogger final : public QObject {
+    Q_OBJECT
+public:
+    struct Config {
+        QString dir;
+        QString baseName = "session";
+        qint64 rotateBytes = 64LL * 1024 * 1024;        // 0 = no size rotation
+        int rotateSeconds = 0;                           // 0 = no time rotation
+        bool compress = true;                            // gzip closed segments
+        qint64 maxTotalBytes = 4LL * 1024 * 1024 * 1024; // 0 = unlimited
+    };
+
+    enum class Dir : char { Rx = 'R', Tx = 'T', System = 'S' };
+
+    explicit SessionLogger(QObject *parent = nullptr);
+    ~SessionLogger() override;
+
+    // err covers the directory only; segment files are opened by the writer thread
+    // and their failures arrive through error()
+    bool start(const Config &cfg, QString *err = nullptr);
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+    // the writer could not open a segment; set before error() is emitted
+    bool hasFailed() const { return m_failed.load(); }
+
+    QString currentSegmentPath() const;
+    QString directory() const { return m_cfg.dir; }
+
+    // GUI thread, cheap: copies bytes into the pending queue.
+    // If the writer falls too far behind, records are dropped (counted) rather than blocking.
+    void append(qint64 tsNs, Dir dir, const QByteArray &bytes, bool hex);
+
+    quint64 writtenBytes() const { return m_written.load(); }
+    quint64 droppedBytes() const { return m_dropped.load(); }
+
+signals:
+    void segmentClosed(const QString &path);
+    void error(const QString &msg);
+
+private:
+    void run();                                   // writer thread
+    bool openSegment(QString *err);
+    void closeSegment();
+    void formatRecords(const QByteArray &records, QByteArray *out);
+    void enforceTotalLimit();
+    static bool gzipFile(const QString &src, const QString &dst);
+
+    Config m_cfg;
+    QThread *m_thread = nullptr;
+    QThreadPool m_compressPool;
+
+    // pending queue (GUI -> writer)
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+    QByteArray m_pending;
+    bool m_stopRequested = false;
+
+    // writer-thread state (opened, written and closed on the writer thread only)
+    QFile m_file;
+    QString m_segmentPath;
+    qint64 m_segmentBytes = 0;
+    qint64 m_segmentOpenedNs = 0;
+    int m_segmentSeq = 0;
+    TimestampClock m_clock;
+
+    mutable QMutex m_pathMutex;     // guards m_segmentPath for currentSegmentPath()
+
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<bool> m_failed{false};
+};
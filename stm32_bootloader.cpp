@@ -0,0 +1,405 @@
+#include "stm32_bootloader.h"
+
+#include <QSerialPort>
+#include <QElapsedTimer>
+#include <QThread>
+
+namespace {
+constexpr quint8 kAck = 0x79;
+constexpr quint8 kNack = 0x1F;
+constexpr quint8 kSyncByte = 0x7F;
+
+constexpr quint8 CMD_GET = 0x00;
+constexpr quint8 CMD_GET_VERSION = 0x01;
+constexpr quint8 CMD_GET_ID = 0x02;
+constexpr quint8 CMD_READ = 0x11;
+constexpr quint8 CMD_GO = 0x21;
+constexpr quint8 CMD_WRITE = 0x31;
+constexpr quint8 CMD_ERASE = 0x43;
+constexpr quint8 CMD_EXT_ERASE = 0x44;
+
+constexpr int kAckTimeoutMs = 1000;
+constexpr int kPollSliceMs = 50;
+constexpr int kEraseBatch = 64;                  // pages per erase command
+constexpr quint32 kSectorBank = 1024 * 1024;     // F2/F4/F7 sector pattern repeats per MB bank
+
+struct DeviceEntry {
+    quint16 pid;
+    const char *name;
+    quint32 flashKb;      // largest part of the line
+    quint32 pageSize;     // 0 = 16/64/128K sectors
+    quint32 uidAddress;   // 96-bit unique ID
+};
+
+// subset of the AN2606 table: the parts we actually meet on the bench
+const DeviceEntry kDevices[] = {
+    {0x412, "STM32F10xxx Low-density",         32,  1024, 0x1FFFF7E8},
+    {0x410, "STM32F10xxx Medium-density",      128, 1024, 0x1FFFF7E8},
+    {0x414, "STM32F10xxx High-density",        512, 2048, 0x1FFFF7E8},
+    {0x420, "STM32F10xxx Medium-density VL",   128, 1024, 0x1FFFF7E8},
+    {0x428, "STM32F10xxx High-density VL",     512, 2048, 0x1FFFF7E8},
+    {0x418, "STM32F105/107",                   256, 2048, 0x1FFFF7E8},
+    {0x430, "STM32F10xxx XL-density",          1024, 2048, 0x1FFFF7E8},
+    {0x444, "STM32F03xx4/6",                   32,  1024, 0x1FFFF7AC},
+    {0x445, "STM32F04xxx/F070x6",              32,  1024, 0x1FFFF7AC},
+    {0x440, "STM32F05xxx/F030x8",              64,  1024, 0x1FFFF7AC},
+    {0x448, "STM32F07xxx",                     128, 2048, 0x1FFFF7AC},
+    {0x442, "STM32F09xxx/F030xC",              256, 2048, 0x1FFFF7AC},
+    {0x438, "STM32F303x4/6/8, F334xx",         64,  2048, 0x1FFFF7AC},
+    {0x422, "STM32F302xB/C, F303xB/C",         256, 2048, 0x1FFFF7AC},
+    {0x411, "STM32F2xxxx",                     1024, 0, 0x1FFF7A10},
+    {0x413, "STM32F40xxx/41xxx",               1024, 0, 0x1FFF7A10},
+    {0x419, "STM32F42xxx/43xxx",               2048, 0, 0x1FFF7A10},
+    {0x423, "STM32F401xB/C",                   256, 0, 0x1FFF7A10},
+    {0x433, "STM32F401xD/E",                   512, 0, 0x1FFF7A10},
+    {0x431, "STM32F411xx",                     512, 0, 0x1FFF7A10},
+    {0x441, "STM32F412xx",                     1024, 0, 0x1FFF7A10},
+    {0x421, "STM32F446xx",                     512, 0, 0x1FFF7A10},
+    {0x458, "STM32F410xx",                     128, 0, 0x1FFF7A10},
+    {0x435, "STM32L43xxx/L44xxx",              256, 2048, 0x1FFF7590},
+    {0x415, "STM32L47xxx/L48xxx",              1024, 2048, 0x1FFF7590},
+    {0x466, "STM32G03xxx/G04xxx",              64,  2048, 0x1FFF7590},
+    {0x460, "STM32G07xxx/G08xxx",              128, 2048, 0x1FFF7590},
+    {0x468, "STM32G431xx/G441xx",              128, 2048, 0x1FFF7590},
+    {0x469, "STM32G47xxx/G48xxx",              512, 2048, 0x1FFF7590},
+};
+
+quint8 xorOf(const QByteArray &bytes) {
+    quint8 x = 0;
+    for (char c : bytes) x ^= quint8(c);
+    return x;
+}
+
+QByteArray be32(quint32 v) {
+    QByteArray b(4, '\0');
+    b[0] = char(v >> 24);
+    b[1] = char(v >> 16);
+    b[2] = char(v >> 8);
+    b[3] = char(v);
+    return b;
+}
+}
+
+Stm32Bootloader::Stm32Bootloader(QSerialPort *port, const std::atomic<bool> *cancel)
+    : m_port(port), m_cancel(cancel) {
+}
+
+/* --------------------------- entry sequence --------------------------- */
+
+bool Stm32Bootloader::applyGpioSequence(QSerialPort *port, const QString &seq, QString *err) {
+    QString token;
+    auto flush = [&]() -> bool {
+        const QString t = token.trimmed().toLower();
+        token.clear();
+        if (t.isEmpty()) return true;
+        const bool on = !t.startsWith('-');
+        const QString name = on ? t : t.mid(1);
+        bool ok = false;
+        if (name == "dtr") ok = port->setDataTerminalReady(on);
+        else if (name == "rts") ok = port->setRequestToSend(on);
+        else if (name == "brk") ok = port->setBreakEnabled(on);
+        else {
+            if (err) *err = QString("unknown GPIO signal '%1'").arg(name);
+            return false;
+        }
+        if (!ok && err) *err = QString("cannot set %1: %2").arg(name, port->errorString());
+        return ok;
+    };
+
+    for (const QChar ch : seq) {
+        if (ch == QLatin1Char(',')) {
+            if (!flush()) return false;
+            QThread::msleep(100);
+        } else if (ch == QLatin1Char('&')) {
+            if (!flush()) return false;
+        } else {
+            token.append(ch);
+        }
+    }
+    if (!flush()) return false;
+    QThread::msleep(100);   // let the bootloader come up before sync
+    return true;
+}
+
+/* --------------------------- raw I/O --------------------------- */
+
+bool Stm32Bootloader::writeBytes(const QByteArray &bytes) {
+    if (m_port->write(bytes) != bytes.size()) return false;
+    QElapsedTimer t;
+    t.start();
+    while (m_port->bytesToWrite() > 0) {
+        if (cancelled() || t.elapsed() > 2000) return false;
+        m_port->waitForBytesWritten(kPollSliceMs);
+    }
+    return true;
+}
+
+bool Stm32Bootloader::readExact(int n, QByteArray *out, int timeoutMs) {
+    out->clear();
+    QElapsedTimer t;
+    t.start();
+    while (out->size() < n) {
+        if (m_port->bytesAvailable() > 0) {
+            out->append(m_port->read(n - out->size()));
+            continue;
+        }
+        if (cancelled()) return false;
+        const qint64 left = timeoutMs - t.elapsed();
+        if (left <= 0) return false;
+        m_port->waitForReadyRead(int(qMin<qint64>(left, kPollSliceMs)));
+    }
+    return true;
+}
+
+bool Stm32Bootloader::waitAck(int timeoutMs, QString *err) {
+    QByteArray b;
+    if (!readExact(1, &b, timeoutMs)) {
+        if (err) *err = cancelled() ? QString("cancelled") : QString("timeout waiting for ACK");
+        return false;
+    }
+    if (quint8(b[0]) == kAck) return true;
+    if (err) *err = quint8(b[0]) == kNack ? QString("NACK") : QString("unexpected byte 0x%1").arg(quint8(b[0]), 2, 16, QLatin1Char('0'));
+    return false;
+}
+
+bool Stm32Bootloader::sendCommand(quint8 op, QString *err) {
+    QByteArray cmd;
+    cmd.append(char(op));
+    cmd.append(char(op ^ 0xFF));
+    if (!writeBytes(cmd)) {
+        if (err) *err = QString("write failed: %1").arg(m_port->errorString());
+        return false;
+    }
+    if (!waitAck(kAckTimeoutMs, err)) {
+        if (err) *err = QString("command 0x%1: %2").arg(op, 2, 16, QLatin1Char('0')).arg(*err);
+        return false;
+    }
+    return true;
+}
+
+bool Stm32Bootloader::sendWithChecksum(const QByteArray &bytes, int ackTimeoutMs, QString *err) {
+    QByteArray b = bytes;
+    b.append(char(xorOf(bytes)));
+    if (!writeBytes(b)) {
+        if (err) *err = QString("write failed: %1").arg(m_port->errorString());
+        return false;
+    }
+    return waitAck(ackTimeoutMs, err);
+}
+
+/* --------------------------- commands --------------------------- */
+
+bool Stm32Bootloader::sync(QString *err) {
+    for (int attempt = 0; attempt < 8 && !cancelled(); ++attempt) {
+        m_port->clear(QSerialPort::Input);
+        if (!writeBytes(QByteArray(1, char(kSyncByte)))) break;
+        QByteArray b;
+        // NACK means the bootloader was already synchronised (autobaud done earlier)
+        if (readExact(1, &b, 500) && (quint8(b[0]) == kAck || quint8(b[0]) == kNack)) return true;
+    }
+    if (err) *err = cancelled() ? QString("cancelled") : QString("no response to 0x7F (not in bootloader?)");
+    return false;
+}
+
+bool Stm32Bootloader::get(ChipInfo *info, QString *err) {
+    if (!sendCommand(CMD_GET, err)) return false;
+    QByteArray n, body;
+    if (!readExact(1, &n, kAckTimeoutMs) || !readExact(quint8(n[0]) + 1, &body, kAckTimeoutMs)) {
+        if (err) *err = "Get: short reply";
+        return false;
+    }
+    info->bootloaderVersion = quint8(body[0]);
+    info->commands = body.mid(1);
+    return waitAck(kAckTimeoutMs, err);
+}
+
+bool Stm32Bootloader::getVersion(ChipInfo *info, QString *err) {
+    if (!sendCommand(CMD_GET_VERSION, err)) return false;
+    QByteArray body;
+    if (!readExact(3, &body, kAckTimeoutMs)) {
+        if (err) *err = "Get Version: short reply";
+        return false;
+    }
+    info->bootloaderVersion = quint8(body[0]);
+    info->option1 = quint8(body[1]);
+    info->option2 = quint8(body[2]);
+    return waitAck(kAckTimeoutMs, err);
+}
+
+bool Stm32Bootloader::getId(ChipInfo *info, QString *err) {
+    if (!sendCommand(CMD_GET_ID, err)) return false;
+    QByteArray n, body;
+    if (!readExact(1, &n, kAckTimeoutMs) || !readExact(quint8(n[0]) + 1, &body, kAckTimeoutMs) || body.size() < 2) {
+        if (err) *err = "Get ID: short reply";
+        return false;
+    }
+    info->pid = quint16((quint8(body[0]) << 8) | quint8(body[1]));
+    lookupDevice(info);
+    return waitAck(kAckTimeoutMs, err);
+}
+
+bool Stm32Bootloader::readMemory(quint32 addr, int len, QByteArray *out, QString *err) {
+    if (len <= 0 || len > kMaxRead) {
+        if (err) *err = "Read Memory: bad length";
+        return false;
+    }
+    if (!sendCommand(CMD_READ, err)) return false;
+    if (!sendWithChecksum(be32(addr), kAckTimeoutMs, err)) {
+        if (err) *err = QString("Read Memory 0x%1: %2").arg(addr, 8, 16, QLatin1Char('0')).arg(*err);
+        return false;
+    }
+    QByteArray count;
+    count.append(char(len - 1));
+    count.append(char((len - 1) ^ 0xFF));
+    if (!writeBytes(count) || !waitAck(kAckTimeoutMs, err)) return false;
+    if (!readExact(len, out, kAckTimeoutMs + len)) {
+        if (err) *err = QString("Read Memory 0x%1: short read").arg(addr, 8, 16, QLatin1Char('0'));
+        return false;
+    }
+    return true;
+}
+
+bool Stm32Bootloader::writeMemory(quint32 addr, const QByteArray &data, QString *err) {
+    if (data.isEmpty() || data.size() > kMaxWrite) {
+        if (err) *err = "Write Memory: bad length";
+        return false;
+    }
+    QByteArray payload = data;
+    while (payload.size() % 4) payload.append(char(0xFF));   // bootloader writes whole words
+
+    if (!sendCommand(CMD_WRITE, err)) return false;
+    if (!sendWithChecksum(be32(addr), kAckTimeoutMs, err)) {
+        if (err) *err = QString("Write Memory 0x%1: %2").arg(addr, 8, 16, QLatin1Char('0')).arg(*err);
+        return false;
+    }
+    QByteArray block;
+    block.reserve(payload.size() + 2);
+    block.append(char(payload.size() - 1));
+    block.append(payload);
+    if (!sendWithChecksum(block, kAckTimeoutMs * 2, err)) {
+        if (err) *err = QString("Write Memory 0x%1: %2").arg(addr, 8, 16, QLatin1Char('0')).arg(*err);
+        return false;
+    }
+    return true;
+}
+
+bool Stm32Bootloader::erasePages(const ChipInfo &info, const QVector<int> &pages, QString *err) {
+    const bool extended = info.hasCommand(CMD_EXT_ERASE);
+    if (!extended && !info.hasCommand(CMD_ERASE)) {
+        if (err) *err = "bootloader has no erase command";
+        return false;
+    }
+    const int batchMax = extended ? kEraseBatch : qMin(kEraseBatch, 255);
+    if (!extended) {
+        // the legacy command carries one byte per page number
+        for (int p : pages) {
+            if (p > 0xFF) {
+                if (err) *err = QString("page %1 cannot be addressed by the legacy erase command (max 255); use mass erase").arg(p);
+                return false;
+            }
+        }
+    }
+
+    for (int first = 0; first < pages.size(); first += batchMax) {
+        const int n = qMin(batchMax, pages.size() - first);
+        QByteArray req;
+        if (extended) {
+            req.append(char((n - 1) >> 8));
+            req.append(char((n - 1) & 0xFF));
+            for (int i = 0; i < n; ++i) {
+                req.append(char(pages[first + i] >> 8));
+                req.append(char(pages[first + i] & 0xFF));
+            }
+        } else {
+            req.append(char(n - 1));
+            for (int i = 0; i < n; ++i) req.append(char(pages[first + i]));
+        }
+        if (!sendCommand(extended ? CMD_EXT_ERASE : CMD_ERASE, err)) return false;
+        // sectors can take seconds each; pages tens of ms
+        const int timeoutMs = 5000 + n * (info.sectors ? 4000 : 100);
+        if (!sendWithChecksum(req, timeoutMs, err)) {
+            if (err) *err = QString("erase: %1").arg(*err);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Stm32Bootloader::massErase(const ChipInfo &info, QString *err) {
+    const bool extended = info.hasCommand(CMD_EXT_ERASE);
+    if (!sendCommand(extended ? CMD_EXT_ERASE : CMD_ERASE, err)) return false;
+    QByteArray req;
+    if (extended) {
+        req.append(char(0xFF));
+        req.append(char(0xFF));
+        req.append(char(0x00));
+    } else {
+        req.append(char(0xFF));
+        req.append(char(0x00));
+    }
+    if (!writeBytes(req) || !waitAck(60000, err)) {
+        if (err) *err = QString("mass erase: %1").arg(*err);
+        return false;
+    }
+    return true;
+}
+
+bool Stm32Bootloader::go(quint32 addr, QString *err) {
+    if (!sendCommand(CMD_GO, err)) return false;
+    return sendWithChecksum(be32(addr), kAckTimeoutMs, err);
+}
+
+/* --------------------------- layout --------------------------- */
+
+void Stm32Bootloader::lookupDevice(ChipInfo *info) {
+    for (const DeviceEntry &d : kDevices) {
+        if (d.pid != info->pid) continue;
+        info->deviceName = QString::fromLatin1(d.name);
+        info->flashSize = d.flashKb * 1024;
+        info->pageSize = d.pageSize;
+        info->sectors = d.pageSize == 0;
+        info->uidAddress = d.uidAddress;
+        return;
+    }
+    info->deviceName.clear();
+    info->flashSize = 0;
+    info->pageSize = 0;
+    info->sectors = false;
+    info->uidAddress = 0;
+}
+
+bool Stm32Bootloader::pageAt(const ChipInfo &info, quint32 addr, int *index, quint32 *start, quint32 *size) {
+    if (info.flashSize == 0 || addr < info.flashStart || addr - info.flashStart >= info.flashSize) return false;
+    const quint32 offset = addr - info.flashStart;
+
+    if (!info.sectors) {
+        if (info.pageSize == 0) return false;
+        *index = int(offset / info.pageSize);
+        *start = info.flashStart + offset / info.pageSize * info.pageSize;
+        *size = info.pageSize;
+        return true;
+    }
+
+    // 4 x 16K, 1 x 64K, then 128K sectors; the pattern restarts in the second MB bank
+    const quint32 bank = offset / kSectorBank;
+    const quint32 off = offset % kSectorBank;
+    int idx = 0;
+    quint32 secStart = 0, secSize = 0;
+    if (off < 64 * 1024) {
+        idx = int(off / (16 * 1024));
+        secStart = quint32(idx) * 16 * 1024;
+        secSize = 16 * 1024;
+    } else if (off < 128 * 1024) {
+        idx = 4;
+        secStart = 64 * 1024;
+        secSize = 64 * 1024;
+    } else {
+        idx = 5 + int((off - 128 * 1024) / (128 * 1024));
+        secStart = 128 * 1024 + quint32(idx - 5) * 128 * 1024;
+        secSize = 128 * 1024;
+    }
+    *index = int(bank) * 12 + idx;
+    *start = info.flashStart + bank * kSectorBank + secStart;
+    *size = secSize;
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+class QSerialPort;
+
+// STM32 系统存储器 USART 引导程序协议（AN3155），同步阻塞实现，只在工作线程里使用。
+// 端口需为 8E1；每个函数失败时返回 false 并写 *err。
+class Stm32Bootloader final {
+public:
+    // Get / Get Version / Get ID
+    struct ChipInfo {
+        quint8 bootloaderVersion = 0;
+        quint8 option1 = 0;
+        quint8 option2 = 0;
+        QByteArray commands;         // opcodes reported by Get
+        quint16 pid = 0;
+        QString deviceName;          // from the built-in table, empty if unknown
+        quint32 flashStart = 0x08000000;
+        quint32 flashSize = 0;       // bytes, 0 if unknown
+        quint32 pageSize = 0;        // uniform erase page, 0 = sectors or unknown
+        bool sectors = false;        // F2/F4/F7-style 16/64/128K sectors
+        quint32 uidAddress = 0;      // 0 if unknown
+        QByteArray uid;              // 12 bytes when it could be read
+
+        bool hasCommand(quint8 op) const { return commands.contains(char(op)); }
+    };
+
+    static constexpr int kMaxWrite = 256;
+    static constexpr int kMaxRead = 256;
+
+    Stm32Bootloader(QSerialPort *port, const std::atomic<bool> *cancel = nullptr);
+
+    // "dtr,-rts,rts,-dtr": name = assert, -name = deassert, ',' = 100 ms, '&' = no delay
+    // (same syntax as the stm32flash -i entry sequence)
+    static bool applyGpioSequence(QSerialPort *port, const QString &seq, QString *err);
+
+    bool sync(QString *err);
+    bool get(ChipInfo *info, QString *err);
+    bool getVersion(ChipInfo *info, QString *err);
+    bool getId(ChipInfo *info, QString *err);
+
+    bool readMemory(quint32 addr, int len, QByteArray *out, QString *err);
+    bool writeMemory(quint32 addr, const QByteArray &data, QString *err);   // len <= 256, padded to 4
+    // page/sector indices; uses Extended Erase (0x44) or legacy Erase (0x43) depending on Get
+    bool erasePages(const ChipInfo &info, const QVector<int> &pages, QString *err);
+    bool massErase(const ChipInfo &info, QString *err);
+    bool go(quint32 addr, QString *err);
+
+    // erase unit containing addr and its bounds; false if the layout is unknown
+    static bool pageAt(const ChipInfo &info, quint32 addr, int *index, quint32 *start, quint32 *size);
+    static void lookupDevice(ChipInfo *info);
+
+private:
+    bool sendCommand(quint8 op, QString *err);
+    bool sendWithChecksum(const QByteArray &bytes, int ackTimeoutMs, QString *err);
+    bool waitAck(int timeoutMs, QString *err);
+    bool readExact(int n, QByteArray *out, int timeoutMs);
+    bool writeBytes(const QByteArray &bytes);
+    bool cancelled() const { return m_cancel && m_cancel->load(); }
+
+    QSerialPort *m_port = nullptr;
+    const std::atomic<bool> *m_cancel = nullptr;
+};
@@ -0,0 +1,169 @@
+#include "stm32flash_parser.h"
+#include "timestamp_clock.h"
+
+#include <cctype>
+
+namespace {
+bool containsNoCase(const QByteArray &haystack, const char *needle) {
+    return haystack.toLower().contains(needle);
+}
+}
+
+void Stm32flashParser::reset(qint64 imageBytes, quint32 baseAddress) {
+    m_pendingOut.clear();
+    m_pendingErr.clear();
+    m_chip = ChipFields();
+    m_progress = Progress();
+    m_progress.bytesTotal = imageBytes;
+    m_imageBytes = imageBytes;
+    m_baseAddress = baseAddress;
+    m_phaseStartNs = 0;
+}
+
+void Stm32flashParser::feed(const QByteArray &data, bool fromStderr, QVector<Event> *out) {
+    QByteArray &pending = fromStderr ? m_pendingErr : m_pendingOut;
+    pending.append(data);
+
+    // progress is redrawn with '\r', everything else ends in '\n'
+    int begin = 0;
+    for (int i = 0; i < pending.size(); ++i) {
+        const char c = pending.at(i);
+        if (c != '\r' && c != '\n') continue;
+        if (i > begin) parseLine(pending.mid(begin, i - begin), fromStderr, out);
+        begin = i + 1;
+    }
+    pending.remove(0, begin);
+}
+
+void Stm32flashParser::finish(QVector<Event> *out) {
+    if (!m_pendingOut.isEmpty()) parseLine(m_pendingOut, false, out);
+    if (!m_pendingErr.isEmpty()) parseLine(m_pendingErr, true, out);
+    m_pendingOut.clear();
+    m_pendingErr.clear();
+}
+
+void Stm32flashParser::parseLine(const QByteArray &raw, bool fromStderr, QVector<Event> *out) {
+    const QByteArray line = raw.trimmed();
+    if (line.isEmpty()) return;
+
+    Event ev;
+    ev.text = QString::fromLocal8Bit(line);
+    ev.fromStderr = fromStderr;
+
+    if (parseProgress(line)) {
+        ev.kind = Event::Kind::Progress;
+        out->push_back(ev);
+        // the last block prints "... (100.00%) Done." on the same line
+        if (line.endsWith("Done.")) {
+            m_progress.phase = Phase::Done;
+            Event done;
+            done.kind = Event::Kind::Done;
+            done.text = "Done.";
+            done.fromStderr = fromStderr;
+            out->push_back(done);
+        }
+        return;
+    }
+
+    if (line.startsWith("Erasing")) {
+        m_progress.phase = Phase::Erasing;
+        m_phaseStartNs = TimestampClock::nowNs();
+        ev.kind = Event::Kind::Erasing;
+    } else if (line.startsWith("Write to memory")) {
+        m_progress.phase = Phase::Writing;
+        m_phaseStartNs = TimestampClock::nowNs();
+    } else if (line.startsWith("Starting execution")) {
+        m_progress.phase = Phase::Starting;
+        if (line.endsWith("done.")) {
+            m_progress.phase = Phase::Done;
+            ev.kind = Event::Kind::Done;
+        }
+    } else if (line == "Done.") {
+        m_progress.phase = Phase::Done;
+        ev.kind = Event::Kind::Done;
+    } else if (containsNoCase(line, "fail") || containsNoCase(line, "error") || containsNoCase(line, "unable")) {
+        m_progress.phase = Phase::Failed;
+        ev.kind = Event::Kind::Error;
+    } else if (parseChipField(line)) {
+        ev.kind = Event::Kind::ChipField;
+    }
+    out->push_back(ev);
+}
+
+// "Wrote address 0x08000100 (1.56%)", "Wrote and verified address ...", "Read address ..."
+bool Stm32flashParser::parseProgress(const QByteArray &line) {
+    const bool wrote = line.startsWith("Wrote ");
+    if (!wrote && !line.startsWith("Read address")) return false;
+
+    const int at = line.indexOf("address 0x");
+    if (at < 0) return false;
+    int i = at + 10;
+    quint32 addr = 0;
+    int digits = 0;
+    for (; i < line.size() && isxdigit(uchar(line.at(i))); ++i, ++digits) {
+        const char c = char(tolower(uchar(line.at(i))));
+        addr = (addr << 4) | quint32(c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    if (digits == 0) return false;
+
+    const int open = line.indexOf('(', i);
+    const int pct = line.indexOf('%', open);
+    if (open < 0 || pct < 0) return false;
+    bool ok = false;
+    const double percent = line.mid(open + 1, pct - open - 1).toDouble(&ok);
+    if (!ok) return false;
+
+    const Phase phase = wrote ? Phase::Writing : Phase::Reading;
+    const qint64 now = TimestampClock::nowNs();
+    if (m_progress.phase != phase || m_phaseStartNs == 0) {
+        m_progress.phase = phase;
+        m_phaseStartNs = now;
+    }
+    m_progress.verifying = wrote && line.startsWith("Wrote and verified");
+    m_progress.percent = percent;
+    m_progress.address = addr;
+
+    if (m_imageBytes > 0) {
+        m_progress.bytesTotal = m_imageBytes;
+        m_progress.bytesDone = qint64(double(m_imageBytes) * percent / 100.0 + 0.5);
+    } else {
+        m_progress.bytesDone = addr >= m_baseAddress ? qint64(addr - m_baseAddress) : 0;
+        m_progress.bytesTotal = percent > 0.0 ? qint64(double(m_progress.bytesDone) * 100.0 / percent) : 0;
+    }
+
+    const double secs = double(now - m_phaseStartNs) / 1e9;
+    if (secs > 0.0 && m_progress.bytesDone > 0) {
+        m_progress.bps = double(m_progress.bytesDone) / secs;
+        m_progress.etaSecs = double(qMax<qint64>(0, m_progress.bytesTotal - m_progress.bytesDone)) / m_progress.bps;
+    }
+    return true;
+}
+
+// "Version      : 0x22", "Device ID    : 0x0410 (STM32F10xxx Medium-density)", "- RAM : Up to 20KiB ..."
+bool Stm32flashParser::parseChipField(const QByteArray &line) {
+    const int colon = line.indexOf(':');
+    if (colon <= 0) return false;
+    QByteArray key = line.left(colon).trimmed().toLower();
+    if (key.startsWith('-')) key = key.mid(1).trimmed();
+    const QString value = QString::fromLocal8Bit(line.mid(colon + 1).trimmed());
+    if (value.isEmpty()) return false;
+
+    if (key == "version") m_chip.version = value;
+    else if (key == "option 1") m_chip.option1 = value;
+    else if (key == "option 2") m_chip.option2 = value;
+    else if (key == "ram") m_chip.ram = value;
+    else if (key == "flash") m_chip.flash = value;
+    else if (key == "option ram") m_chip.optionRam = value;
+    else if (key == "system ram") m_chip.systemRam = value;
+    else if (key == "device id" || key == "chip id" || key == "pid") {
+        const int paren = value.indexOf('(');
+        m_chip.deviceId = (paren < 0 ? value : value.left(paren)).trimmed();
+        if (paren >= 0) {
+            const int close = value.indexOf(')', paren);
+            m_chip.deviceName = value.mid(paren + 1, close < 0 ? -1 : close - paren - 1).trimmed();
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// stm32flash 输出的增量解析器：stdout / stderr 各自按行切分（'\r' 与 '\n' 都算行尾，
+// 进度行是用 '\r' 覆盖打印的），每行到达时立即转换成结构化事件；
+// 不保留整段输出，芯片字段与进度随解析累积。
+// 进度行走固定前缀判断，不用正则。
+class Stm32flashParser final {
+public:
+    enum class Phase { Idle, Erasing, Writing, Reading, Starting, Done, Failed };
+
+    struct Event {
+        enum class Kind {
+            Text,        // any other line, shown as is
+            ChipField,   // "Version : 0x22", "- Flash : Up to 128KiB ..."
+            Erasing,
+            Progress,    // "Wrote [and verified ]address 0x... (x.xx%)" / "Read address ..."
+            Done,        // "Done." / "Starting execution ... done."
+            Error,
+        };
+        Kind kind = Kind::Text;
+        QString text;                // the line without terminator
+        bool fromStderr = false;
+    };
+
+    struct ChipFields {
+        QString version;
+        QString option1;
+        QString option2;
+        QString deviceId;
+        QString deviceName;
+        QString ram;
+        QString flash;
+        QString optionRam;
+        QString systemRam;
+
+        bool isEmpty() const { return version.isEmpty() && deviceId.isEmpty() && flash.isEmpty(); }
+    };
+
+    struct Progress {
+        Phase phase = Phase::Idle;
+        bool verifying = false;      // "-v": every block is read back right after the write
+        double percent = 0.0;
+        quint32 address = 0;
+        qint64 bytesDone = 0;
+        qint64 bytesTotal = 0;       // image size if known, else derived from the percentage
+        double bps = 0.0;
+        double etaSecs = -1.0;       // < 0 until there is a rate
+    };
+
+    // imageBytes: size of the .bin being written (0 = unknown); baseAddress: stm32flash -S
+    void reset(qint64 imageBytes, quint32 baseAddress = 0x08000000);
+
+    // appends one Event per complete line; `out` is not cleared
+    void feed(const QByteArray &data, bool fromStderr, QVector<Event> *out);
+    // process exited: flush unterminated tails (stm32flash ends progress lines with a space)
+    void finish(QVector<Event> *out);
+
+    const ChipFields &chip() const { return m_chip; }
+    const Progress &progress() const { return m_progress; }
+
+private:
+    void parseLine(const QByteArray &line, bool fromStderr, QVector<Event> *out);
+    bool parseProgress(const QByteArray &line);
+    bool parseChipField(const QByteArray &line);
+
+    QByteArray m_pendingOut;
+    QByteArray m_pendingErr;
+    ChipFields m_chip;
+    Progress m_progress;
+    qint64 m_imageBytes = 0;
+    quint32 m_baseAddress = 0x08000000;
+    qint64 m_phaseStartNs = 0;
+};
@@ -0,0 +1,97 @@
+#include "timestamp_clock.h"
+
+#include <QDateTime>
+
+#include <time.h>
+
+static qint64 clockNs(clockid_t id) {
+    timespec ts{};
+    clock_gettime(id, &ts);
+    return qint64(ts.tv_sec) * 1000000000LL + qint64(ts.tv_nsec);
+}
+
+namespace {
+struct WallAnchor {
+    qint64 monoNs = 0;
+    qint64 epochNs = 0;
+    WallAnchor() {
+        // 两次读取尽量靠近，锚点误差在 µs 级
+        monoNs = clockNs(CLOCK_MONOTONIC);
+        epochNs = clockNs(CLOCK_REALTIME);
+    }
+};
+}
+
+static const WallAnchor &anchor() {
+    static const WallAnchor a;
+    return a;
+}
+
+qint64 TimestampClock::nowNs() {
+    return clockNs(CLOCK_MONOTONIC);
+}
+
+qint64 TimestampClock::toEpochNs(qint64 monoNs) {
+    const WallAnchor &a = anchor();
+    return a.epochNs + (monoNs - a.monoNs);
+}
+
+const QString &TimestampClock::prefixForSecond(qint64 epochSec) {
+    if (epochSec != m_cachedSec) {
+        m_cachedSec = epochSec;
+        m_cachedPrefix = QDateTime::fromSecsSinceEpoch(epochSec).toString("HH:mm:ss.");
+        m_cachedPrefixLatin1 = m_cachedPrefix.toLatin1();
+    }
+    return m_cachedPrefix;
+}
+
+static void appendDigits(QString &s, int v, int width) {
+    QChar buf[8];
+    for (int i = width - 1; i >= 0; --i) {
+        buf[i] = QChar(int('0' + v % 10));
+        v /= 10;
+    }
+    s.append(buf, width);
+}
+
+QString TimestampClock::formatHmsZ(qint64 monoNs) {
+    const qint64 epochNs = toEpochNs(monoNs);
+    const qint64 sec = epochNs / 1000000000LL;
+    const int subNs = int(epochNs % 1000000000LL);
+
+    QString s;
+    s.reserve(12);
+    s += prefixForSecond(sec);
+    appendDigits(s, subNs / 1000000, 3);
+    return s;
+}
+
+QString TimestampClock::formatHmsUs(qint64 monoNs) {
+    const qint64 epochNs = toEpochNs(monoNs);
+    const qint64 sec = epochNs / 1000000000LL;
+    const int subNs = int(epochNs % 1000000000LL);
+
+    QString s;
+    s.reserve(15);
+    s += prefixForSecond(sec);
+    appendDigits(s, subNs / 1000000, 3);
+    appendDigits(s, (subNs / 1000) % 1000, 3);
+    return s;
+}
+
+void TimestampClock::appendHmsUs(qint64 monoNs, QByteArray *out) {
+    if (!out) return;
+    const qint64 epochNs = toEpochNs(monoNs);
+    const qint64 sec = epochNs / 1000000000LL;
+    int us = int(epochNs % 1000000000LL) / 1000;
+
+    prefixForSecond(sec);
+    out->append(m_cachedPrefixLatin1);
+
+    char buf[6];
+    for (int i = 5; i >= 0; --i) {
+        buf[i] = char('0' + us % 10);
+        us /= 10;
+    }
+    out->append(buf, 6);
+}
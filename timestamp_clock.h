@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QtGlobal>
+
+// 单调时钟时间戳（CLOCK_MONOTONIC, ns）+ 进程级墙钟锚点。
+// 数据在读取时打戳，渲染/导出时再换算成本地时间。
+// 格式化时按秒缓存 "HH:mm:ss." 前缀，毫秒/微秒部分用整数拼接，
+// 避免每行都走 QDateTime::toString()。
+// 注意：格式化缓存不是线程安全的，每个使用方（终端、日志线程…）各持有一个实例。
+class TimestampClock final {
+public:
+    // CLOCK_MONOTONIC now, in nanoseconds
+    static qint64 nowNs();
+
+    // monotonic ns -> wall clock (ns since epoch), via the process-wide anchor
+    static qint64 toEpochNs(qint64 monoNs);
+
+    // "HH:mm:ss.zzz"
+    QString formatHmsZ(qint64 monoNs);
+    // "HH:mm:ss.zzzuuu"
+    QString formatHmsUs(qint64 monoNs);
+    // same, appended as Latin-1 (log writer / exports)
+    void appendHmsUs(qint64 monoNs, QByteArray *out);
+
+private:
+    const QString &prefixForSecond(qint64 epochSec);
+
+    qint64 m_cachedSec = -1;
+    QString m_cachedPrefix;   // "HH:mm:ss."
+    QByteArray m_cachedPrefixLatin1;
+};
@@ -0,0 +1,450 @@
+#include "trigger_engine.h"
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <algorithm>
+#include <bitset>
+#include <vector>
+
+namespace {
+using ByteSet = std::bitset<256>;
+
+struct Atom {
+    ByteSet set;
+    char quant = '1';          // '1', '?', '*', '+'
+};
+
+struct Alt {
+    int rule = 0;
+    bool anchored = false;     // '^': only at stream start or right after '\n'
+    std::vector<Atom> atoms;
+};
+
+void foldCase(ByteSet *s) {
+    for (int c = 'a'; c <= 'z'; ++c) {
+        if ((*s)[c] || (*s)[c - 32]) {
+            s->set(c);
+            s->set(c - 32);
+        }
+    }
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+ByteSet classDigit() {
+    ByteSet s;
+    for (int c = '0'; c <= '9'; ++c) s.set(c);
+    return s;
+}
+
+ByteSet classWord() {
+    ByteSet s = classDigit();
+    for (int c = 'a'; c <= 'z'; ++c) { s.set(c); s.set(c - 32); }
+    s.set('_');
+    return s;
+}
+
+ByteSet classSpace() {
+    ByteSet s;
+    for (char c : {' ', '\t', '\n', '\r', '\f', '\v'}) s.set(static_cast<unsigned char>(c));
+    return s;
+}
+
+// p[i] is the character after '\'; on return i points past the escape
+bool parseEscape(const QByteArray &p, int &i, ByteSet *out, QString *err) {
+    if (i >= p.size()) {
+        *err = "结尾多余的 \\";
+        return false;
+    }
+    const char c = p[i++];
+    switch (c) {
+    case 'd': *out = classDigit(); return true;
+    case 'D': *out = ~classDigit(); return true;
+    case 'w': *out = classWord(); return true;
+    case 'W': *out = ~classWord(); return true;
+    case 's': *out = classSpace(); return true;
+    case 'S': *out = ~classSpace(); return true;
+    case 'n': out->set('\n'); return true;
+    case 'r': out->set('\r'); return true;
+    case 't': out->set('\t'); return true;
+    case '0': out->set(0); return true;
+    case 'x': {
+        const int hi = (i < p.size()) ? hexValue(p[i]) : -1;
+        const int lo = (i + 1 < p.size()) ? hexValue(p[i + 1]) : -1;
+        if (hi < 0 || lo < 0) {
+            *err = "\\x 后需要两位十六进制";
+            return false;
+        }
+        out->set(hi * 16 + lo);
+        i += 2;
+        return true;
+    }
+    default:
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            *err = QString("不支持的转义 \\%1").arg(QLatin1Char(c));
+            return false;
+        }
+        out->set(static_cast<unsigned char>(c));
+        return true;
+    }
+}
+
+bool parseClass(const QByteArray &p, int &i, ByteSet *out, QString *err) {
+    // p[i] is the character after '['
+    bool negate = false;
+    if (i < p.size() && p[i] == '^') { negate = true; ++i; }
+
+    ByteSet s;
+    bool first = true;
+    while (i < p.size() && (p[i] != ']' || first)) {
+        first = false;
+        ByteSet one;
+        if (p[i] == '\\') {
+            ++i;
+            if (!parseEscape(p, i, &one, err)) return false;
+        } else {
+            one.set(static_cast<unsigned char>(p[i++]));
+        }
+
+        // range a-z (only between two single bytes)
+        if (one.count() == 1 && i + 1 < p.size() && p[i] == '-' && p[i + 1] != ']') {
+            int lo = 0;
+            while (!one[lo]) ++lo;
+            ++i;
+            ByteSet end;
+            if (p[i] == '\\') {
+                ++i;
+                if (!parseEscape(p, i, &end, err)) return false;
+            } else {
+                end.set(static_cast<unsigned char>(p[i++]));
+            }
+            if (end.count() != 1) {
+                *err = "字符范围端点无效";
+                return false;
+            }
+            int hi = 0;
+            while (!end[hi]) ++hi;
+            if (hi < lo) {
+                *err = "字符范围顺序颠倒";
+                return false;
+            }
+            for (int c = lo; c <= hi; ++c) one.set(c);
+        }
+        s |= one;
+    }
+    if (i >= p.size()) {
+        *err = "缺少 ]";
+        return false;
+    }
+    ++i;   // ']'
+    *out = negate ? ~s : s;
+    return true;
+}
+
+bool parseRegex(const QString &pattern, bool ci, int rule, std::vector<Alt> *alts, QString *err) {
+    const QByteArray p = pattern.toUtf8();
+
+    Alt cur;
+    cur.rule = rule;
+    int i = 0;
+    bool atAltStart = true;
+
+    auto finishAlt = [&]() {
+        alts->push_back(std::move(cur));
+        cur = Alt();
+        cur.rule = rule;
+    };
+
+    while (i < p.size()) {
+        const char c = p[i];
+
+        if (c == '|') {
+            finishAlt();
+            ++i;
+            atAltStart = true;
+            continue;
+        }
+        if (c == '^') {
+            if (!atAltStart) {
+                *err = "^ 只能出现在开头";
+                return false;
+            }
+            cur.anchored = true;
+            ++i;
+            atAltStart = false;
+            continue;
+        }
+        atAltStart = false;
+
+        if (c == '?' || c == '*' || c == '+') {
+            if (cur.atoms.empty() || cur.atoms.back().quant != '1') {
+                *err = QString("量词 %1 前没有可重复的字符").arg(QLatin1Char(c));
+                return false;
+            }
+            cur.atoms.back().quant = c;
+            ++i;
+            continue;
+        }
+        if (c == '(' || c == ')' || c == '{' || c == '$') {
+            *err = QString("不支持 %1（仅支持简单正则）").arg(QLatin1Char(c));
+            return false;
+        }
+
+        Atom a;
+        ++i;
+        if (c == '.') {
+            a.set.set();
+            a.set.reset('\n');
+        } else if (c == '[') {
+            if (!parseClass(p, i, &a.set, err)) return false;
+        } else if (c == '\\') {
+            if (!parseEscape(p, i, &a.set, err)) return false;
+        } else {
+            a.set.set(static_cast<unsigned char>(c));
+        }
+        if (ci) foldCase(&a.set);
+        cur.atoms.push_back(a);
+    }
+    finishAlt();
+    return true;
+}
+
+bool parseHex(const QString &pattern, int rule, std::vector<Alt> *alts, QString *err) {
+    Alt alt;
+    alt.rule = rule;
+
+    const QStringList tokens = pattern.split(QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts);
+    for (QString tok : tokens) {
+        if (tok.startsWith("0x", Qt::CaseInsensitive)) tok = tok.mid(2);
+        if (tok.isEmpty() || (tok.size() % 2) != 0) {
+            *err = QString("HEX 片段长度无效：%1").arg(tok);
+            return false;
+        }
+        for (int i = 0; i < tok.size(); i += 2) {
+            Atom a;
+            if (tok[i] == QLatin1Char('?') && tok[i + 1] == QLatin1Char('?')) {
+                a.set.set();
+            } else {
+                const int hi = hexValue(tok[i].toLatin1());
+                const int lo = hexValue(tok[i + 1].toLatin1());
+                if (hi < 0 || lo < 0) {
+                    *err = QString("HEX 字符无效：%1").arg(tok.mid(i, 2));
+                    return false;
+                }
+                a.set.set(hi * 16 + lo);
+            }
+            alt.atoms.push_back(a);
+        }
+    }
+    alts->push_back(std::move(alt));
+    return true;
+}
+
+void parseLiteral(const QString &pattern, bool ci, int rule, std::vector<Alt> *alts) {
+    Alt alt;
+    alt.rule = rule;
+    const QByteArray p = pattern.toUtf8();
+    alt.atoms.reserve(size_t(p.size()));
+    for (char c : p) {
+        Atom a;
+        a.set.set(static_cast<unsigned char>(c));
+        if (ci) foldCase(&a.set);
+        alt.atoms.push_back(a);
+    }
+    alts->push_back(std::move(alt));
+}
+}
+
+/* --------------------------- */
+
+bool TriggerEngine::compile(const QVector<Rule> &rules, QString *err) {
+    // 1) parse every enabled rule into alternatives of quantified byte sets
+    std::vector<Alt> alts;
+    for (int r = 0; r < rules.size(); ++r) {
+        const Rule &rule = rules[r];
+        if (!rule.enabled) continue;
+
+        QString e;
+        const size_t before = alts.size();
+        bool ok = true;
+        switch (rule.kind) {
+        case PatternKind::Literal: parseLiteral(rule.pattern, rule.caseInsensitive, r, &alts); break;
+        case PatternKind::Hex:     ok = parseHex(rule.pattern, r, &alts, &e); break;
+        case PatternKind::Regex:   ok = parseRegex(rule.pattern, rule.caseInsensitive, r, &alts, &e); break;
+        }
+        if (ok) {
+            for (size_t k = before; k < alts.size(); ++k) {
+                bool allOptional = true;
+                for (const Atom &a : alts[k].atoms) {
+                    if (a.quant == '1' || a.quant == '+') { allOptional = false; break; }
+                }
+                if (allOptional) { ok = false; e = "模式可以匹配空串"; break; }
+            }
+        }
+        if (!ok) {
+            if (err) *err = QString("规则 %1「%2」：%3").arg(r + 1).arg(rule.name, e);
+            return false;
+        }
+    }
+
+    // 2) positions: alt k owns [base_k, base_k + n_k]; the last one is its accept position
+    struct Pos {
+        const Atom *atom;      // nullptr on accept positions
+        int alt;
+    };
+    std::vector<Pos> pos;
+    std::vector<int> unanchoredStarts, anchoredStarts;
+    std::vector<int> altLength(alts.size(), -1);
+    for (size_t k = 0; k < alts.size(); ++k) {
+        (alts[k].anchored ? anchoredStarts : unanchoredStarts).push_back(int(pos.size()));
+        bool fixed = true;
+        for (const Atom &a : alts[k].atoms) {
+            pos.push_back({&a, int(k)});
+            if (a.quant != '1') fixed = false;
+        }
+        pos.push_back({nullptr, int(k)});
+        if (fixed) altLength[k] = int(alts[k].atoms.size());
+    }
+
+    auto closure = [&](std::vector<int> &set) {
+        std::vector<char> seen(pos.size(), 0);
+        std::vector<int> work;
+        work.swap(set);
+        while (!work.empty()) {
+            const int p = work.back();
+            work.pop_back();
+            if (seen[size_t(p)]) continue;
+            seen[size_t(p)] = 1;
+            set.push_back(p);
+            const Atom *a = pos[size_t(p)].atom;
+            if (a && (a->quant == '?' || a->quant == '*')) work.push_back(p + 1);
+        }
+        std::sort(set.begin(), set.end());
+    };
+
+    // 3) subset construction over the unanchored union
+    auto keyOf = [](const std::vector<int> &set) {
+        return QByteArray(reinterpret_cast<const char *>(set.data()), int(set.size() * sizeof(int)));
+    };
+
+    QHash<QByteArray, int> ids;
+    std::vector<std::vector<int>> states;
+    QVector<qint32> next;
+    QVector<int> hitBegin;
+    QVector<Hit> hits;
+
+    auto addState = [&](std::vector<int> &&set) -> int {
+        const QByteArray key = keyOf(set);
+        const auto it = ids.constFind(key);
+        if (it != ids.constEnd()) return it.value();
+        const int id = int(states.size());
+        ids.insert(key, id);
+        states.push_back(std::move(set));
+        return id;
+    };
+
+    if (!alts.empty()) {
+        std::vector<int> init = unanchoredStarts;
+        init.insert(init.end(), anchoredStarts.begin(), anchoredStarts.end());
+        closure(init);
+        addState(std::move(init));
+    }
+
+    for (size_t s = 0; s < states.size(); ++s) {
+        if (int(states.size()) > kMaxStates) {
+            if (err) *err = QString("规则过于复杂（自动机状态数超过 %1）").arg(kMaxStates);
+            return false;
+        }
+
+        // matches reported on entering this state
+        hitBegin.push_back(hits.size());
+        for (int p : states[s]) {
+            if (pos[size_t(p)].atom) continue;
+            const int k = pos[size_t(p)].alt;
+            const int rule = alts[size_t(k)].rule;
+            const int len = altLength[size_t(k)];
+            auto dup = std::find_if(hits.begin() + hitBegin.back(), hits.end(),
+                                    [rule](const Hit &h) { return h.rule == rule; });
+            if (dup == hits.end()) {
+                hits.push_back({rule, len});
+            } else if (dup->length != len) {
+                dup->length = (dup->length < 0 || len < 0) ? -1 : std::max(dup->length, len);
+            }
+        }
+
+        next.resize(int(states.size()) * 256);
+        for (int b = 0; b < 256; ++b) {
+            std::vector<int> t = unanchoredStarts;
+            if (b == '\n') t.insert(t.end(), anchoredStarts.begin(), anchoredStarts.end());
+            for (int p : states[s]) {
+                const Atom *a = pos[size_t(p)].atom;
+                if (!a || !a->set[size_t(b)]) continue;
+                t.push_back(p + 1);
+                if (a->quant == '*' || a->quant == '+') t.push_back(p);
+            }
+            closure(t);
+            const int id = addState(std::move(t));
+            next.resize(int(states.size()) * 256);
+            next[int(s) * 256 + b] = id;
+        }
+    }
+    hitBegin.push_back(hits.size());
+
+    // flag transitions into reporting states so the scan loop only branches on a sign test
+    for (qint32 &t : next) {
+        if (hitBegin[t] != hitBegin[t + 1]) t |= qint32(0x80000000u);
+    }
+
+    m_rules = rules;
+    m_next = std::move(next);
+    m_hitBegin = std::move(hitBegin);
+    m_hits = std::move(hits);
+    m_stateCount = int(states.size());
+    m_startState = 0;
+    m_state = 0;
+    return true;
+}
+
+void TriggerEngine::clear() {
+    m_rules.clear();
+    m_next.clear();
+    m_hitBegin.clear();
+    m_hits.clear();
+    m_stateCount = 0;
+    m_state = 0;
+}
+
+void TriggerEngine::reset() {
+    m_state = m_startState;
+}
+
+void TriggerEngine::feed(const char *data, int len, quint64 streamOffset, qint64 tsNs, QVector<Event> *out) {
+    if (m_stateCount == 0 || len <= 0) return;
+
+    const qint32 *table = m_next.constData();
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    qint32 s = m_state;
+
+    for (int i = 0; i < len; ++i) {
+        s = table[s * 256 + p[i]];
+        if (Q_LIKELY(s >= 0)) continue;
+
+        s &= 0x7fffffff;
+        for (int h = m_hitBegin[s]; h < m_hitBegin[s + 1]; ++h) {
+            Event ev;
+            ev.rule = m_hits[h].rule;
+            ev.endOffset = streamOffset + quint64(i) + 1;
+            ev.length = m_hits[h].length;
+            ev.tsNs = tsNs;
+            out->push_back(ev);
+        }
+    }
+    m_state = s;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// 多模式流触发引擎。
+//
+// 所有启用的规则（文本 / HEX / 简单正则）一起编译成一个 DFA（非锚定，等价于 Aho-Corasick 的
+// 完全转移表），RX 每个字节只做一次查表，与规则数量无关。自动机状态跨 feed() 保留，
+// 因此跨数据块边界的匹配也能命中。
+//
+// 正则子集：字面字符、.、[...]/[^...]、\d \w \s（及大写取反）、\xHH、\n \r \t、
+// 量词 ? * +、顶层 |、行首 ^。不支持分组、反向引用、$。
+// HEX：空格可选，?? 表示任意字节（例：DE AD ?? EF）。
+class TriggerEngine final {
+public:
+    enum class PatternKind { Literal, Hex, Regex };
+
+    enum Action : quint32 {
+        Highlight    = 1u << 0,
+        Count        = 1u << 1,
+        PauseView    = 1u << 2,
+        StartCapture = 1u << 3,
+    };
+
+    struct Rule {
+        bool enabled = true;
+        QString name;
+        PatternKind kind = PatternKind::Literal;
+        QString pattern;
+        bool caseInsensitive = false;
+        quint32 actions = Highlight | Count;
+    };
+
+    struct Event {
+        int rule = 0;              // index into rules()
+        quint64 endOffset = 0;     // stream offset one past the last matched byte
+        int length = -1;           // matched length, -1 if the pattern has variable length
+        qint64 tsNs = 0;           // arrival stamp of the chunk holding the last byte
+    };
+
+    // builds the automaton; on failure the previous one stays active
+    bool compile(const QVector<Rule> &rules, QString *err);
+    void clear();
+
+    // back to the start state (e.g. port reopened)
+    void reset();
+
+    // appends one Event per (rule, end position); `out` is not cleared
+    void feed(const char *data, int len, quint64 streamOffset, qint64 tsNs, QVector<Event> *out);
+
+    const QVector<Rule> &rules() const { return m_rules; }
+    bool isEmpty() const { return m_stateCount == 0; }
+    int stateCount() const { return m_stateCount; }
+
+    static constexpr int kMaxStates = 8192;
+
+private:
+    struct Hit {
+        int rule;
+        int length;
+    };
+
+    QVector<Rule> m_rules;
+    int m_stateCount = 0;
+    int m_startState = 0;
+    int m_state = 0;
+
+    // m_next[s * 256 + b]; bit 31 set when the target state reports matches
+    QVector<qint32> m_next;
+    // hits of state s are m_hits[m_hitBegin[s] .. m_hitBegin[s + 1])
+    QVector<int> m_hitBegin;
+    QVector<Hit> m_hits;
+};
@@ -0,0 +1,188 @@
+#include "trigger_rules_dialog.h"
+
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QThread>
+
+namespace {
+enum Column {
+    ColEnabled = 0,
+    ColName,
+    ColKind,
+    ColPattern,
+    ColCase,
+    ColHighlight,
+    ColCount,
+    ColPause,
+    ColCapture,
+    ColumnCount
+};
+
+QTableWidgetItem *checkItem(bool on) {
+    auto *it = new QTableWidgetItem();
+    it->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable);
+    it->setCheckState(on ? Qt::Checked : Qt::Unchecked);
+    return it;
+}
+
+bool isChecked(const QTableWidget *t, int row, int col) {
+    const QTableWidgetItem *it = t->item(row, col);
+    return it && it->checkState() == Qt::Checked;
+}
+}
+
+TriggerRulesDialog::TriggerRulesDialog(const QVector<TriggerEngine::Rule> &rules, QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("触发规则");
+    resize(820, 360);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"启用", "名称", "类型", "模式", "忽略大小写", "高亮", "计数", "暂停显示", "开始记录"});
+    m_table->horizontalHeader()->setSectionResizeMode(ColPattern, QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    for (const auto &r : rules) appendRow(r);
+
+    m_addBtn = new QPushButton("添加", this);
+    m_removeBtn = new QPushButton("删除", this);
+
+    m_errorLabel = new QLabel(this);
+    m_errorLabel->setStyleSheet("color: rgb(200,0,0);");
+    m_errorLabel->setWordWrap(true);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    m_buttons = buttons;
+
+    auto *row = new QHBoxLayout();
+    row->addWidget(m_addBtn);
+    row->addWidget(m_removeBtn);
+    row->addWidget(m_errorLabel, 1);
+    row->addWidget(buttons);
+
+    auto *root = new QVBoxLayout(this);
+    root->addWidget(new QLabel("模式类型：文本（原样字节）/ HEX（DE AD ?? EF，?? 为任意字节）/ "
+                               "正则（. [] \\d \\w \\s \\xHH ? * + | ^，不支持分组）", this));
+    root->addWidget(m_table, 1);
+    root->addLayout(row);
+
+    connect(m_addBtn, &QPushButton::clicked, this, &TriggerRulesDialog::onAddRule);
+    connect(m_removeBtn, &QPushButton::clicked, this, &TriggerRulesDialog::onRemoveRule);
+    connect(buttons, &QDialogButtonBox::accepted, this, &TriggerRulesDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &TriggerRulesDialog::reject);
+}
+
+TriggerRulesDialog::~TriggerRulesDialog() {
+    if (!m_compileThread) return;
+    m_compileThread->wait();
+    delete m_compileThread;
+}
+
+void TriggerRulesDialog::appendRow(const TriggerEngine::Rule &r) {
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+
+    m_table->setItem(row, ColEnabled, checkItem(r.enabled));
+    m_table->setItem(row, ColName, new QTableWidgetItem(r.name));
+
+    auto *kind = new QComboBox(m_table);
+    kind->addItem("文本", int(TriggerEngine::PatternKind::Literal));
+    kind->addItem("HEX", int(TriggerEngine::PatternKind::Hex));
+    kind->addItem("正则", int(TriggerEngine::PatternKind::Regex));
+    kind->setCurrentIndex(kind->findData(int(r.kind)));
+    m_table->setCellWidget(row, ColKind, kind);
+
+    m_table->setItem(row, ColPattern, new QTableWidgetItem(r.pattern));
+    m_table->setItem(row, ColCase, checkItem(r.caseInsensitive));
+    m_table->setItem(row, ColHighlight, checkItem(r.actions & TriggerEngine::Highlight));
+    m_table->setItem(row, ColCount, checkItem(r.actions & TriggerEngine::Count));
+    m_table->setItem(row, ColPause, checkItem(r.actions & TriggerEngine::PauseView));
+    m_table->setItem(row, ColCapture, checkItem(r.actions & TriggerEngine::StartCapture));
+}
+
+QVector<TriggerEngine::Rule> TriggerRulesDialog::rules() const {
+    QVector<TriggerEngine::Rule> out;
+    out.reserve(m_table->rowCount());
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        TriggerEngine::Rule r;
+        r.enabled = isChecked(m_table, row, ColEnabled);
+        if (const auto *it = m_table->item(row, ColName)) r.name = it->text().trimmed();
+        if (const auto *it = m_table->item(row, ColPattern)) r.pattern = it->text();
+        if (const auto *kind = qobject_cast<QComboBox*>(m_table->cellWidget(row, ColKind))) {
+            r.kind = TriggerEngine::PatternKind(kind->currentData().toInt());
+        }
+        r.caseInsensitive = isChecked(m_table, row, ColCase);
+
+        r.actions = 0;
+        if (isChecked(m_table, row, ColHighlight)) r.actions |= TriggerEngine::Highlight;
+        if (isChecked(m_table, row, ColCount)) r.actions |= TriggerEngine::Count;
+        if (isChecked(m_table, row, ColPause)) r.actions |= TriggerEngine::PauseView;
+        if (isChecked(m_table, row, ColCapture)) r.actions |= TriggerEngine::StartCapture;
+
+        if (r.pattern.isEmpty()) continue;   // blank rows are dropped
+        if (r.name.isEmpty()) r.name = r.pattern;
+        out.push_back(r);
+    }
+    return out;
+}
+
+void TriggerRulesDialog::accept() {
+    if (m_compileThread) return;
+
+    // compile here, once: a bad pattern is reported while the user can still fix it,
+    // and the caller installs this very engine
+    const QVector<TriggerEngine::Rule> list = rules();
+    setEditable(false);
+    m_errorLabel->setText("编译中…");
+
+    m_compileThread = QThread::create([this, list]() {
+        auto engine = std::make_shared<TriggerEngine>();
+        QString err;
+        const bool ok = engine->compile(list, &err);
+        QMetaObject::invokeMethod(this, [this, engine, ok, err]() { onCompiled(engine, ok, err); },
+                                  Qt::QueuedConnection);
+    });
+    m_compileThread->setObjectName("TriggerCompile");
+    m_compileThread->start();
+}
+
+void TriggerRulesDialog::onCompiled(const std::shared_ptr<TriggerEngine> &engine, bool ok, const QString &err) {
+    m_compileThread->wait();
+    delete m_compileThread;
+    m_compileThread = nullptr;
+    setEditable(true);
+
+    if (!ok) {
+        m_errorLabel->setText(err);
+        return;
+    }
+    m_errorLabel->clear();
+    m_engine = std::move(*engine);
+    QDialog::accept();
+}
+
+void TriggerRulesDialog::setEditable(bool on) {
+    m_table->setEnabled(on);
+    m_addBtn->setEnabled(on);
+    m_removeBtn->setEnabled(on);
+    if (QPushButton *ok = m_buttons->button(QDialogButtonBox::Ok)) ok->setEnabled(on);
+}
+
+void TriggerRulesDialog::onAddRule() {
+    TriggerEngine::Rule r;
+    appendRow(r);
+    m_table->setCurrentCell(m_table->rowCount() - 1, ColPattern);
+    m_table->editItem(m_table->item(m_table->rowCount() - 1, ColPattern));
+}
+
+void TriggerRulesDialog::onRemoveRule() {
+    const int row = m_table->currentRow();
+    if (row >= 0) m_table->removeRow(row);
+}
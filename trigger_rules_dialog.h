@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include <memory>
+
+#include "trigger_engine.h"
+
+class QTableWidget;
+class QLabel;
+class QPushButton;
+class QDialogButtonBox;
+class QThread;
+
+// 触发规则编辑：每行一条规则（名称 / 类型 / 模式 / 动作）。
+// 确定时在后台线程整体编译一次（大规则集构造 DFA 较慢，不卡界面）；成功后由调用方 takeEngine() 取走，不再重复编译。
+class TriggerRulesDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit TriggerRulesDialog(const QVector<TriggerEngine::Rule> &rules, QWidget *parent = nullptr);
+    ~TriggerRulesDialog() override;
+
+    QVector<TriggerEngine::Rule> rules() const;
+    // after Accepted: the engine compiled from rules()
+    TriggerEngine takeEngine() { return std::move(m_engine); }
+
+public slots:
+    void accept() override;
+
+private slots:
+    void onAddRule();
+    void onRemoveRule();
+
+private:
+    void appendRow(const TriggerEngine::Rule &r);
+    void onCompiled(const std::shared_ptr<TriggerEngine> &engine, bool ok, const QString &err);
+    void setEditable(bool on);
+
+    QTableWidget *m_table = nullptr;
+    QLabel *m_errorLabel = nullptr;
+    QPushButton *m_addBtn = nullptr;
+    QPushButton *m_removeBtn = nullptr;
+    QDialogButtonBox *m_buttons = nullptr;
+
+    QThread *m_compileThread = nullptr;
+    TriggerEngine m_engine;
+};
@@ -0,0 +1,155 @@
+#include "tx_queue.h"
+#include "timestamp_clock.h"
+
+#include <QSerialPort>
+#include <QVector>
+
+namespace {
+constexpr int kInFlightMs = 20;            // line time kept in the port's write buffer
+constexpr qint64 kMinInFlight = 64;
+constexpr qint64 kMaxInFlight = 64 * 1024;
+constexpr qint64 kRateWindowNs = 500000000;
+constexpr int kCtsPollMs = 10;
+}
+
+TxQueue::TxQueue(QSerialPort *port, QObject *parent)
+    : QObject(parent), m_port(port) {
+
+    m_ctsPoll.setInterval(kCtsPollMs);
+    connect(&m_ctsPoll, &QTimer::timeout, this, &TxQueue::pump);
+    connect(m_port, &QSerialPort::bytesWritten, this, &TxQueue::onBytesWritten);
+    m_rateWindowStartNs = TimestampClock::nowNs();
+}
+
+bool TxQueue::enqueue(const QByteArray &bytes, int tag) {
+    if (bytes.isEmpty()) return true;
+    if (m_queuedBytes + bytes.size() > m_capacity) {
+        ++m_rejected;
+        return false;
+    }
+    m_queue.enqueue({bytes, tag});
+    m_queuedBytes += bytes.size();
+    pump();
+    return true;
+}
+
+void TxQueue::clear() {
+    m_queue.clear();
+    m_handIndex = 0;
+    m_handOffset = 0;
+    m_writtenOffset = 0;
+    m_queuedBytes = 0;
+    m_ctsPoll.stop();
+    m_ctsHeld = false;
+
+    m_drainedTotal = 0;
+    m_rejected = 0;
+    m_rateWindowStartNs = TimestampClock::nowNs();
+    m_rateWindowBytes = 0;
+    m_drainedBps = 0.0;
+}
+
+TxQueue::Stats TxQueue::stats() {
+    const qint64 now = TimestampClock::nowNs();
+    const qint64 dt = now - m_rateWindowStartNs;
+    if (dt >= kRateWindowNs) {
+        m_drainedBps = double(m_rateWindowBytes) * 1e9 / double(dt);
+        m_rateWindowStartNs = now;
+        m_rateWindowBytes = 0;
+    }
+
+    Stats s;
+    s.queuedBytes = m_queuedBytes;
+    s.inFlightBytes = m_port->isOpen() ? m_port->bytesToWrite() : 0;
+    s.drainedBytes = m_drainedTotal;
+    s.rejected = m_rejected;
+    s.drainedBps = m_drainedBps;
+    const double lineBps = double(m_port->baudRate()) / bitsPerChar();
+    s.utilization = lineBps > 0.0 ? qMin(1.0, m_drainedBps / lineBps) : 0.0;
+    s.ctsHeld = m_ctsHeld;
+    return s;
+}
+
+void TxQueue::onBytesWritten(qint64 n) {
+    m_drainedTotal += quint64(n);
+    m_rateWindowBytes += quint64(n);
+
+    // bytes leave the port buffer in the order they were handed over
+    QVector<Frame> done;
+    while (n > 0 && m_handIndex > 0) {
+        const qint64 left = m_queue.head().bytes.size() - m_writtenOffset;
+        if (n < left) {
+            m_writtenOffset += int(n);
+            break;
+        }
+        n -= left;
+        done.push_back(m_queue.dequeue());
+        --m_handIndex;
+        m_writtenOffset = 0;
+    }
+    if (n > 0 && m_handIndex == 0 && !m_queue.isEmpty())   // head is only partly handed over
+        m_writtenOffset = int(qMin<qint64>(m_writtenOffset + n, m_handOffset));
+
+    const qint64 tsNs = TimestampClock::nowNs();
+    for (const Frame &f : done) emit written(f.bytes, tsNs, f.tag);
+    pump();
+}
+
+void TxQueue::pump() {
+    if (!m_port->isOpen() || m_handIndex >= m_queue.size()) {
+        m_ctsPoll.stop();
+        m_ctsHeld = false;
+        return;
+    }
+
+    if (!ctsAsserted()) {
+        // peer is not ready; bytes already in the port buffer stay there, nothing new is added
+        m_ctsHeld = true;
+        if (!m_ctsPoll.isActive()) m_ctsPoll.start();
+        return;
+    }
+    m_ctsHeld = false;
+    m_ctsPoll.stop();
+
+    qint64 room = inFlightLimit() - m_port->bytesToWrite();
+    while (room > 0 && m_handIndex < m_queue.size()) {
+        const QByteArray &bytes = m_queue.at(m_handIndex).bytes;
+        const qint64 len = qMin<qint64>(room, bytes.size() - m_handOffset);
+        // QSerialPort buffers all it accepts: the result is len or -1
+        const qint64 n = m_port->write(bytes.constData() + m_handOffset, len);
+        if (n < 0) {
+            emit error(m_port->errorString());
+            return;
+        }
+
+        m_handOffset += int(n);
+        m_queuedBytes -= n;
+        room -= n;
+        if (m_handOffset >= bytes.size()) {
+            ++m_handIndex;
+            m_handOffset = 0;
+        }
+    }
+}
+
+qint64 TxQueue::inFlightLimit() const {
+    const double bytesPerSec = double(m_port->baudRate()) / bitsPerChar();
+    const qint64 limit = qint64(bytesPerSec * kInFlightMs / 1000.0);
+    return qBound(kMinInFlight, limit, kMaxInFlight);
+}
+
+double TxQueue::bitsPerChar() const {
+    double bits = 1.0 + double(m_port->dataBits());   // start + data
+    if (m_port->parity() != QSerialPort::NoParity) bits += 1.0;
+    switch (m_port->stopBits()) {
+    case QSerialPort::OneAndHalfStop: bits += 1.5; break;
+    case QSerialPort::TwoStop:        bits += 2.0; break;
+    default:                          bits += 1.0; break;
+    }
+    return bits;
+}
+
+bool TxQueue::ctsAsserted() const {
+    if (m_port->flowControl() != QSerialPort::HardwareControl) return true;
+    return (m_port->pinoutSignals() & QSerialPort::ClearToSendSignal) != 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+
+class QSerialPort;
+
+// 交互发送队列：有界缓冲，只往 QSerialPort 写缓冲里放约 kInFlightMs 线路时间的数据，
+// 其余按 bytesWritten 逐步推进；硬件流控下 CTS 无效时暂停喂数据。
+// 串口的唯一写入路径：一帧全部写进驱动后才发 written（回显、发送计数以此为准）。
+// 统计排队字节、实际吞吐与相对波特率的线路利用率。
+class TxQueue final : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        qint64 queuedBytes = 0;      // waiting in this queue
+        qint64 inFlightBytes = 0;    // handed to QSerialPort, not yet written to the driver
+        quint64 drainedBytes = 0;    // written to the driver since open
+        quint64 rejected = 0;        // enqueue() calls refused because the queue was full
+        double drainedBps = 0.0;     // bytes/s over the last window
+        double utilization = 0.0;    // drainedBps vs. configured line rate, 0..1
+        bool ctsHeld = false;        // hardware flow control is holding the queue
+    };
+
+    explicit TxQueue(QSerialPort *port, QObject *parent = nullptr);
+
+    void setCapacity(qint64 bytes) { m_capacity = bytes; }
+    qint64 capacity() const { return m_capacity; }
+
+    // false = would exceed capacity; nothing is queued in that case
+    // tag is handed back unchanged in written()
+    bool enqueue(const QByteArray &bytes, int tag = 0);
+    void clear();                    // drop pending data and reset stats (port open/close)
+
+    Stats stats();
+
+signals:
+    void written(const QByteArray &bytes, qint64 tsNs, int tag);   // the whole frame reached the driver
+    void error(const QString &msg);
+
+private slots:
+    void onBytesWritten(qint64 n);
+    void pump();
+
+private:
+    qint64 inFlightLimit() const;
+    double bitsPerChar() const;
+    bool ctsAsserted() const;
+
+    struct Frame {
+        QByteArray bytes;
+        int tag = 0;
+    };
+
+    QSerialPort *m_port = nullptr;
+    QQueue<Frame> m_queue;           // frames not yet completely written to the driver
+    int m_handIndex = 0;             // first frame not completely handed to the port
+    int m_handOffset = 0;            // bytes of m_queue[m_handIndex] already handed to the port
+    int m_writtenOffset = 0;         // bytes of m_queue.head() reported by bytesWritten
+    qint64 m_queuedBytes = 0;        // not yet handed to the port
+    qint64 m_capacity = 4LL * 1024 * 1024;
+    QTimer m_ctsPoll;                // QSerialPort has no CTS-change signal
+
+    quint64 m_drainedTotal = 0;
+    quint64 m_rejected = 0;
+    qint64 m_rateWindowStartNs = 0;
+    quint64 m_rateWindowBytes = 0;
+    double m_drainedBps = 0.0;
+    bool m_ctsHeld = false;
+};
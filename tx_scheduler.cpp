@@ -0,0 +1,255 @@
+#include "tx_scheduler.h"
+#include "timestamp_clock.h"
+
+#include <QThread>
+#include <QMutexLocker>
+
+#include <cerrno>
+#include <cmath>
+
+#if defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+#if defined(Q_OS_MAC)
+#include <mach/mach_time.h>
+#endif
+
+namespace {
+constexpr qint64 kSpinNs = 100000;                 // spin the last 100 µs instead of trusting the sleep
+constexpr qint64 kMaxSliceNs = 50000000;           // sleep in <= 50 ms slices so stop() stays responsive
+constexpr int kMaxOutboxBytes = 256 * 1024;        // released but not yet taken by the GUI
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// absolute-deadline sleep on the monotonic clock
+void sleepAbsolute(qint64 targetNs) {
+#if defined(Q_OS_MAC)
+    static const mach_timebase_info_data_t tb = []() {
+        mach_timebase_info_data_t t{};
+        mach_timebase_info(&t);
+        return t;
+    }();
+    const qint64 rel = targetNs - TimestampClock::nowNs();
+    if (rel <= 0) return;
+    const uint64_t ticks = uint64_t(rel) * tb.denom / tb.numer;
+    mach_wait_until(mach_absolute_time() + ticks);
+#elif defined(Q_OS_UNIX)
+    timespec ts{};
+    ts.tv_sec = time_t(targetNs / 1000000000LL);
+    ts.tv_nsec = long(targetNs % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    const qint64 rel = targetNs - TimestampClock::nowNs();
+    if (rel > 0) QThread::usleep(quint64(rel / 1000));
+#endif
+}
+
+// false if stop was requested while waiting
+bool waitUntil(qint64 deadlineNs, const std::atomic<bool> &stop) {
+    qint64 now = TimestampClock::nowNs();
+    while (deadlineNs - now > kSpinNs) {
+        sleepAbsolute(qMin(deadlineNs - kSpinNs, now + kMaxSliceNs));
+        if (stop.load(std::memory_order_relaxed)) return false;
+        now = TimestampClock::nowNs();
+    }
+    while (TimestampClock::nowNs() < deadlineNs) cpuRelax();
+    return !stop.load(std::memory_order_relaxed);
+}
+}
+
+const qint64 TxScheduler::kHistBoundsNs[kHistBuckets - 1] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+    1000000, 2000000, 5000000, 10000000,
+};
+
+TxScheduler::TxScheduler(QObject *parent)
+    : QObject(parent) {
+}
+
+TxScheduler::~TxScheduler() {
+    stop();
+}
+
+bool TxScheduler::start(const Config &cfg, QString *err) {
+    stop();
+
+    bool anyPayload = false;
+    qint64 cycleNs = 0;
+    for (const Step &s : cfg.steps) {
+        if (!s.payload.isEmpty()) anyPayload = true;
+        cycleNs += qMax<qint64>(0, s.delayAfterNs);
+    }
+    if (!anyPayload) {
+        if (err) *err = "sequence has no payload";
+        return false;
+    }
+    if (cfg.periodNs <= 0 && cycleNs <= 0) {
+        if (err) *err = "period and step delays are all zero";
+        return false;
+    }
+
+    m_cfg = cfg;
+    m_stop = false;
+    {
+        QMutexLocker lk(&m_statsMutex);
+        m_stats = Stats();
+        m_releasedAcc = PeriodAcc();
+        m_writtenAcc = PeriodAcc();
+    }
+    m_prevWrittenNs = -1;
+    {
+        QMutexLocker lk(&m_outboxMutex);
+        m_outbox.clear();
+        m_outboxBytes = 0;
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("TxScheduler");
+    m_thread->start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void TxScheduler::stop() {
+    if (!m_thread) return;
+    m_stop = true;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+TxScheduler::Stats TxScheduler::stats() const {
+    QMutexLocker lk(&m_statsMutex);
+    Stats s = m_stats;
+    const auto finish = [](PeriodStats *ps, const PeriodAcc &acc) {
+        if (ps->samples == 0) return;
+        ps->meanNs = acc.sumNs / double(ps->samples);
+        ps->jitterRmsNs = std::sqrt(acc.devSqSumNs / double(ps->samples));
+    };
+    finish(&s.released, m_releasedAcc);
+    finish(&s.written, m_writtenAcc);
+    return s;
+}
+
+QVector<TxScheduler::Frame> TxScheduler::takeFrames() {
+    QMutexLocker lk(&m_outboxMutex);
+    QVector<Frame> out;
+    out.swap(m_outbox);
+    m_outboxBytes = 0;
+    return out;
+}
+
+void TxScheduler::frameWritten(qint64 tsNs) {
+    if (m_prevWrittenNs >= 0) {
+        QMutexLocker lk(&m_statsMutex);
+        recordPeriod(&m_stats.written, &m_writtenAcc, tsNs - m_prevWrittenNs);
+    }
+    m_prevWrittenNs = tsNs;
+}
+
+qint64 TxScheduler::nominalPeriodNs() const {
+    if (m_cfg.periodNs > 0) return m_cfg.periodNs;
+    qint64 nominal = 0;
+    for (const Step &s : m_cfg.steps) nominal += qMax<qint64>(0, s.delayAfterNs);
+    return nominal;
+}
+
+void TxScheduler::recordPeriod(PeriodStats *ps, PeriodAcc *acc, qint64 actualNs) {
+    const qint64 dev = actualNs - nominalPeriodNs();
+    const qint64 absDev = dev < 0 ? -dev : dev;
+
+    int bucket = 0;
+    while (bucket < kHistBuckets - 1 && absDev >= kHistBoundsNs[bucket]) ++bucket;
+
+    if (ps->samples == 0) {
+        ps->minNs = ps->maxNs = actualNs;
+    } else {
+        ps->minNs = qMin(ps->minNs, actualNs);
+        ps->maxNs = qMax(ps->maxNs, actualNs);
+    }
+    ++ps->samples;
+    acc->sumNs += double(actualNs);
+    acc->devSqSumNs += double(dev) * double(dev);
+    ++ps->hist[bucket];
+}
+
+bool TxScheduler::post(const QByteArray &bytes, bool cycleStart) {
+    bool wake = false;
+    {
+        QMutexLocker lk(&m_outboxMutex);
+        if (m_outboxBytes + bytes.size() > kMaxOutboxBytes) return false;
+        wake = m_outbox.isEmpty();
+        m_outbox.push_back({bytes, cycleStart});
+        m_outboxBytes += bytes.size();
+    }
+    // one wake-up per batch: the GUI drains everything released so far
+    if (wake) emit framesReady();
+    return true;
+}
+
+void TxScheduler::run() {
+    const quint64 repeat = m_cfg.repeat;
+    qint64 cycleDeadline = TimestampClock::nowNs();
+    qint64 prevCycleStart = -1;
+
+    for (quint64 cycle = 0; !m_stop.load() && (repeat == 0 || cycle < repeat); ++cycle) {
+        qint64 stepDeadline = cycleDeadline;
+        bool cycleStart = true;      // the next payload is this cycle's first
+
+        for (int i = 0; i < m_cfg.steps.size(); ++i) {
+            const Step &step = m_cfg.steps[i];
+            if (!waitUntil(stepDeadline, m_stop)) break;
+
+            if (i == 0) {
+                const qint64 startNs = TimestampClock::nowNs();
+                if (prevCycleStart >= 0) {
+                    QMutexLocker lk(&m_statsMutex);
+                    recordPeriod(&m_stats.released, &m_releasedAcc, startNs - prevCycleStart);
+                }
+                prevCycleStart = startNs;
+            }
+
+            if (!step.payload.isEmpty()) {
+                const bool posted = post(step.payload, cycleStart);
+                cycleStart = false;
+                {
+                    QMutexLocker lk(&m_statsMutex);
+                    if (posted) {
+                        ++m_stats.sentPayloads;
+                        m_stats.sentBytes += quint64(step.payload.size());
+                    } else {
+                        ++m_stats.failed;
+                    }
+                }
+            }
+            stepDeadline += qMax<qint64>(0, step.delayAfterNs);
+        }
+        if (m_stop.load()) break;
+
+        {
+            QMutexLocker lk(&m_statsMutex);
+            ++m_stats.cycles;
+        }
+
+        if (m_cfg.periodNs > 0) {
+            cycleDeadline += m_cfg.periodNs;
+            // fell behind by a whole period: count it and resync to the grid instead of bursting
+            const qint64 now = TimestampClock::nowNs();
+            if (cycleDeadline < now) {
+                const qint64 missed = (now - cycleDeadline) / m_cfg.periodNs + 1;
+                cycleDeadline += missed * m_cfg.periodNs;
+                QMutexLocker lk(&m_statsMutex);
+                m_stats.overruns += quint64(missed);
+            }
+        } else {
+            cycleDeadline = stepDeadline;
+        }
+    }
+
+    if (!m_stop.load()) emit finished();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+
+#include <atomic>
+
+class QThread;
+
+// 精确定时发送：独立线程按绝对截止时间睡眠（Linux clock_nanosleep / macOS mach_wait_until），
+// 最后一小段自旋，支持亚毫秒周期与多步序列（数据、延时、数据……）。
+// 到点的数据放进有界发件箱并通知 GUI，由 GUI 交给 TxQueue 写入 QSerialPort（串口只有一个写者，跨平台）。
+// 周期统计分两侧：released 是本线程放出每周期首个数据的时刻（µs 级，只说明调度本身），
+// written 是 TxQueue 报告该帧已全部写进驱动的时刻——包含 GUI 事件循环与驱动缓冲的延迟，
+// GUI 忙时积压的帧会首尾相接发出，这时只有 written 反映线路上的实际周期。
+class TxScheduler final : public QObject {
+    Q_OBJECT
+public:
+    struct Step {
+        QByteArray payload;          // may be empty (pure delay)
+        qint64 delayAfterNs = 0;     // relative to this step's deadline
+    };
+
+    struct Config {
+        QVector<Step> steps;
+        qint64 periodNs = 0;         // cycle start to cycle start; 0 = back-to-back by step delays
+        quint64 repeat = 0;          // cycles, 0 = until stopped
+    };
+
+    // |actual - nominal| period deviation buckets (upper bounds, last one open)
+    static constexpr int kHistBuckets = 14;
+    static const qint64 kHistBoundsNs[kHistBuckets - 1];
+
+    struct PeriodStats {
+        quint64 samples = 0;
+        qint64 minNs = 0;
+        qint64 maxNs = 0;
+        double meanNs = 0.0;
+        double jitterRmsNs = 0.0;    // RMS of (actual - nominal)
+        quint64 hist[kHistBuckets] = {};
+    };
+
+    struct Stats {
+        quint64 cycles = 0;
+        quint64 sentPayloads = 0;    // handed to the GUI for the TX queue
+        quint64 sentBytes = 0;
+        quint64 failed = 0;          // dropped: the outbox was full (GUI not keeping up)
+        quint64 overruns = 0;        // a cycle started after its deadline had already passed
+        PeriodStats released;        // cycle starts as released by the scheduler thread
+        PeriodStats written;         // cycle-start frames as reported by TxQueue::written
+    };
+
+    struct Frame {
+        QByteArray bytes;
+        bool cycleStart = false;     // first payload of its cycle: report its write via frameWritten()
+    };
+
+    explicit TxScheduler(QObject *parent = nullptr);
+    ~TxScheduler() override;
+
+    bool start(const Config &cfg, QString *err = nullptr);
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    Stats stats() const;
+    // GUI thread: released payloads in order, to be written through the TX queue
+    QVector<Frame> takeFrames();
+    // GUI thread: a cycleStart frame was completely written to the driver at tsNs
+    void frameWritten(qint64 tsNs);
+
+signals:
+    void framesReady();              // the outbox went from empty to non-empty (queued to the GUI)
+    void finished();                 // repeat count reached
+    void error(const QString &msg);
+
+private:
+    void run();
+    struct PeriodAcc {
+        double sumNs = 0.0;
+        double devSqSumNs = 0.0;
+    };
+
+    bool post(const QByteArray &bytes, bool cycleStart);
+    qint64 nominalPeriodNs() const;
+    void recordPeriod(PeriodStats *ps, PeriodAcc *acc, qint64 actualNs);   // m_statsMutex held
+
+    Config m_cfg;
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_stop{false};
+
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+    PeriodAcc m_releasedAcc;
+    PeriodAcc m_writtenAcc;
+    qint64 m_prevWrittenNs = -1;     // GUI thread
+
+    QMutex m_outboxMutex;
+    QVector<Frame> m_outbox;
+    int m_outboxBytes = 0;
+};
@@ -0,0 +1,210 @@
+#include "tx_sequence_dialog.h"
+
+#include <QCheckBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QComboBox>
+#include <QPushButton>
+#include <QPlainTextEdit>
+#include <QLabel>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFont>
+
+#include <cctype>
+
+namespace {
+enum Column { ColPayload = 0, ColFormat, ColDelay, ColumnCount };
+
+QString formatNs(double ns) {
+    if (ns >= 1e6) return QString("%1 ms").arg(ns / 1e6, 0, 'f', 3);
+    if (ns >= 1e3) return QString("%1 µs").arg(ns / 1e3, 0, 'f', 1);
+    return QString("%1 ns").arg(ns, 0, 'f', 0);
+}
+
+bool parseHexBytes(const QString &text, QByteArray *out) {
+    QByteArray compact;
+    compact.reserve(text.size());
+    for (const QChar ch : text) {
+        if (ch.isSpace() || ch == QLatin1Char(',')) continue;
+        if (!isxdigit(ch.toLatin1())) return false;
+        compact.append(ch.toLatin1());
+    }
+    if (compact.size() % 2 != 0) return false;
+    *out = QByteArray::fromHex(compact);
+    return true;
+}
+}
+
+TxSequenceDialog::TxSequenceDialog(QWidget *parent)
+    : QDialog(parent) {
+
+    setWindowTitle("定时发送序列");
+    setModal(false);
+    resize(560, 520);
+
+    m_useSeqCheck = new QCheckBox("使用序列（不勾选时发送输入框内容，周期取主界面设置）", this);
+
+    m_periodMsSpin = new QDoubleSpinBox(this);
+    m_periodMsSpin->setRange(0.0, 600000.0);
+    m_periodMsSpin->setDecimals(3);
+    m_periodMsSpin->setValue(1.0);
+    m_periodMsSpin->setSuffix(" ms");
+    m_periodMsSpin->setToolTip("0 = 按各步延时首尾相接");
+
+    m_repeatSpin = new QSpinBox(this);
+    m_repeatSpin->setRange(0, 100000000);
+    m_repeatSpin->setSpecialValueText("无限");
+
+    m_echoCheck = new QCheckBox("终端回显发送内容（批量显示）", this);
+    m_echoCheck->setChecked(true);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({"数据", "格式", "之后延时 (ms)"});
+    m_table->horizontalHeader()->setSectionResizeMode(ColPayload, QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(true);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    appendRow(QString(), false, 0.0);
+
+    m_addBtn = new QPushButton("添加步骤", this);
+    m_removeBtn = new QPushButton("删除步骤", this);
+
+    m_statsView = new QPlainTextEdit(this);
+    m_statsView->setReadOnly(true);
+    QFont mono;
+    mono.setStyleHint(QFont::Monospace);
+#if defined(Q_OS_MAC)
+    mono.setFamily("Menlo");
+#else
+    mono.setFamily("Monospace");
+#endif
+    m_statsView->setFont(mono);
+
+    auto *form = new QFormLayout();
+    form->addRow(m_useSeqCheck);
+    form->addRow("周期", m_periodMsSpin);
+    form->addRow("循环次数", m_repeatSpin);
+    form->addRow(m_echoCheck);
+
+    auto *btnRow = new QHBoxLayout();
+    btnRow->addWidget(m_addBtn);
+    btnRow->addWidget(m_removeBtn);
+    btnRow->addStretch(1);
+
+    auto *root = new QVBoxLayout(this);
+    root->addLayout(form);
+    root->addWidget(m_table, 1);
+    root->addLayout(btnRow);
+    root->addWidget(new QLabel("实际周期 / 偏差分布", this));
+    root->addWidget(m_statsView, 1);
+
+    connect(m_addBtn, &QPushButton::clicked, this, &TxSequenceDialog::onAddStep);
+    connect(m_removeBtn, &QPushButton::clicked, this, &TxSequenceDialog::onRemoveStep);
+}
+
+void TxSequenceDialog::appendRow(const QString &payload, bool hex, double delayMs) {
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+    m_table->setItem(row, ColPayload, new QTableWidgetItem(payload));
+
+    auto *fmt = new QComboBox(m_table);
+    fmt->addItems({"ASCII", "HEX"});
+    fmt->setCurrentIndex(hex ? 1 : 0);
+    m_table->setCellWidget(row, ColFormat, fmt);
+
+    m_table->setItem(row, ColDelay, new QTableWidgetItem(QString::number(delayMs, 'g', 9)));
+}
+
+bool TxSequenceDialog::useSequence() const {
+    return m_useSeqCheck->isChecked();
+}
+
+bool TxSequenceDialog::echoEnabled() const {
+    return m_echoCheck->isChecked();
+}
+
+qint64 TxSequenceDialog::periodNs() const {
+    return qint64(m_periodMsSpin->value() * 1e6 + 0.5);
+}
+
+quint64 TxSequenceDialog::repeatCount() const {
+    return quint64(m_repeatSpin->value());
+}
+
+bool TxSequenceDialog::steps(QVector<TxScheduler::Step> *out, QString *err) const {
+    out->clear();
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        TxScheduler::Step s;
+        const QString text = m_table->item(row, ColPayload) ? m_table->item(row, ColPayload)->text() : QString();
+        const auto *fmt = qobject_cast<QComboBox*>(m_table->cellWidget(row, ColFormat));
+        const bool hex = fmt && fmt->currentIndex() == 1;
+        if (hex) {
+            if (!parseHexBytes(text, &s.payload)) {
+                if (err) *err = QString("第 %1 步 HEX 格式无效").arg(row + 1);
+                return false;
+            }
+        } else {
+            s.payload = text.toLatin1();
+        }
+
+        bool ok = false;
+        const QString delayText = m_table->item(row, ColDelay) ? m_table->item(row, ColDelay)->text().trimmed() : QString();
+        const double delayMs = delayText.isEmpty() ? 0.0 : delayText.toDouble(&ok);
+        if (!delayText.isEmpty() && (!ok || delayMs < 0.0)) {
+            if (err) *err = QString("第 %1 步延时无效").arg(row + 1);
+            return false;
+        }
+        s.delayAfterNs = qint64(delayMs * 1e6 + 0.5);
+        out->push_back(s);
+    }
+    return true;
+}
+
+void TxSequenceDialog::setStats(const TxScheduler::Stats &s) {
+    QStringList lines;
+    lines << QString("周期数 %1   交给发送队列 %2 次 / %3 字节   丢弃 %4   超时 %5")
+                 .arg(s.cycles).arg(s.sentPayloads).arg(s.sentBytes).arg(s.failed).arg(s.overruns);
+    const auto periodLine = [](const QString &side, const TxScheduler::PeriodStats &p) {
+        return QString("%1  min %2  mean %3  max %4  抖动(RMS) %5")
+            .arg(side, formatNs(double(p.minNs)), formatNs(p.meanNs),
+                 formatNs(double(p.maxNs)), formatNs(p.jitterRmsNs));
+    };
+    if (s.written.samples > 0) lines << periodLine("写出周期", s.written);
+    if (s.released.samples > 0) lines << periodLine("释放周期", s.released);
+    lines << "写出 = 帧全部写进串口驱动的时刻（含 GUI 事件循环与驱动缓冲延迟，接近线路实际）；"
+          << "释放 = 调度线程放出数据的时刻，只反映调度精度，不代表线路上的周期。";
+    lines << QString();
+
+    quint64 total = 0, peak = 0;
+    for (quint64 v : s.written.hist) { total += v; peak = qMax(peak, v); }
+    quint64 relTotal = 0;
+    for (quint64 v : s.released.hist) relTotal += v;
+    lines << "周期偏差直方图：写出侧次数 / 占比 / 分布，右列为释放侧占比";
+    for (int i = 0; i < TxScheduler::kHistBuckets; ++i) {
+        const QString range = (i < TxScheduler::kHistBuckets - 1)
+                                  ? QString("< %1").arg(formatNs(double(TxScheduler::kHistBoundsNs[i])))
+                                  : QString(">= %1").arg(formatNs(double(TxScheduler::kHistBoundsNs[i - 1])));
+        const int bar = peak ? int(40 * s.written.hist[i] / peak) : 0;
+        const double pct = total ? 100.0 * double(s.written.hist[i]) / double(total) : 0.0;
+        const double relPct = relTotal ? 100.0 * double(s.released.hist[i]) / double(relTotal) : 0.0;
+        lines << QString("|Δ| %1  %2 %3%  %4   释放 %5%")
+                     .arg(range, 12)
+                     .arg(s.written.hist[i], 10)
+                     .arg(pct, 6, 'f', 2)
+                     .arg(QString(bar, QLatin1Char('#')), -40)
+                     .arg(relPct, 6, 'f', 2);
+    }
+    m_statsView->setPlainText(lines.join('\n'));
+}
+
+void TxSequenceDialog::onAddStep() {
+    appendRow(QString(), false, 0.0);
+}
+
+void TxSequenceDialog::onRemoveStep() {
+    const int row = m_table->currentRow();
+    if (row >= 0 && m_table->rowCount() > 1) m_table->removeRow(row);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QDialog>
+
+#include "tx_scheduler.h"
+
+class QCheckBox;
+class QDoubleSpinBox;
+class QSpinBox;
+class QTableWidget;
+class QPushButton;
+class QPlainTextEdit;
+
+// 定时发送序列与统计（非模态）：多步序列 / 亚毫秒周期 / 回显开关，
+// 下方显示写出侧（TxQueue 报告写进驱动）与释放侧（调度线程）的实际周期与偏差直方图。
+class TxSequenceDialog final : public QDialog {
+    Q_OBJECT
+public:
+    explicit TxSequenceDialog(QWidget *parent = nullptr);
+
+    bool useSequence() const;
+    bool echoEnabled() const;
+    qint64 periodNs() const;
+    quint64 repeatCount() const;
+
+    // steps from the table; false + *err on a malformed HEX payload
+    bool steps(QVector<TxScheduler::Step> *out, QString *err) const;
+
+    void setStats(const TxScheduler::Stats &s);
+
+private slots:
+    void onAddStep();
+    void onRemoveStep();
+
+private:
+    void appendRow(const QString &payload, bool hex, double delayMs);
+
+    QCheckBox *m_useSeqCheck = nullptr;
+    QDoubleSpinBox *m_periodMsSpin = nullptr;
+    QSpinBox *m_repeatSpin = nullptr;
+    QCheckBox *m_echoCheck = nullptr;
+    QTableWidget *m_table = nullptr;
+    QPushButton *m_addBtn = nullptr;
+    QPushButton *m_removeBtn = nullptr;
+    QPlainTextEdit *m_statsView = nullptr;
+};